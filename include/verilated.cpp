@@ -27,6 +27,10 @@
 #include "verilated_imp.h"
 #include <cctype>
 
+#if !defined(_WIN32) || defined(__MINGW32__) || defined(__CYGWIN__)
+# include <unistd.h>
+#endif
+
 #define VL_VALUE_STRING_MAX_WIDTH 8192	///< Max static char array for VL_VALUE_STRING
 
 //===========================================================================
@@ -34,6 +38,8 @@
 
 // Slow path variables
 VerilatedVoidCb Verilated::s_flushCb = NULL;
+VerilatedVoidCb Verilated::s_errorCb = NULL;
+VerilatedForkCb Verilated::s_forkCb = NULL;
 
 // Keep below together in one cache line
 Verilated::Serialized Verilated::s_s;
@@ -63,6 +69,7 @@ void vl_finish (const char* filename, int linenum, const char* hier) {
 #ifndef VL_USER_STOP		// Define this to override this function
 void vl_stop (const char* filename, int linenum, const char* hier) {
     Verilated::gotFinish(true);
+    Verilated::errorCall();
     Verilated::flushCall();
     vl_fatal (filename,linenum,hier,"Verilog $stop");
 }
@@ -73,6 +80,7 @@ void vl_fatal (const char* filename, int linenum, const char* hier, const char*
     if (0 && hier) {}
     Verilated::gotFinish(true);
     VL_PRINTF("%%Error: %s:%d: %s\n", filename, linenum, msg);
+    Verilated::errorCall();
     Verilated::flushCall();
     abort();
 }
@@ -170,6 +178,146 @@ void _VL_DEBUG_PRINT_W(int lbits, WDataInP iwp) {
 //===========================================================================
 // Slow math
 
+// Wide multiply.  Below VL_MUL_KARATSUBA_WORDS the inline VL_MUL_W
+// schoolbook loop is used.  Above it a full product of n words is three
+// Karatsuba products of n/2 words, and the low n words of a product (what
+// VL_MUL_W returns) are the full product of the low halves plus the two
+// truncated cross products.  Both recurse down to the threshold.
+
+static void vl_mul_school(int lwords, int rwords, int owords,
+			  WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    // owp = low owords of lwp*rwp; owp must not overlap inputs
+    for (int i=0; i<owords; i++) owp[i] = 0;
+    for (int lword=0; lword<lwords && lword<owords; lword++) {
+	QData ld = lwp[lword];
+	if (!ld) continue;
+	int rmax = owords-lword;  if (rmax > rwords) rmax = rwords;
+	QData carry = 0;
+	for (int rword=0; rword<rmax; rword++) {
+	    carry += ld * (QData)(rwp[rword]) + (QData)(owp[lword+rword]);
+	    owp[lword+rword] = (IData)carry;
+	    carry >>= VL_ULL(32);
+	}
+	if (lword+rmax < owords) owp[lword+rmax] = (IData)carry;
+    }
+}
+
+static IData vl_mul_add(int words, WDataOutP owp, WDataInP lwp, int rwords, WDataInP rwp) {
+    // owp = lwp + rwp, rwp zero extended from rwords, returning carry out
+    QData carry = 0;
+    for (int i=0; i<words; i++) {
+	carry += (QData)(lwp[i]) + (QData)(i<rwords ? rwp[i] : 0);
+	owp[i] = (IData)carry;
+	carry >>= VL_ULL(32);
+    }
+    return (IData)carry;
+}
+
+static void vl_mul_acc(int owords, WDataOutP owp, int words, WDataInP lwp) {
+    // owp += lwp, carry propagating through owords
+    QData carry = 0;
+    int i=0;
+    for (; i<words; i++) {
+	carry += (QData)(owp[i]) + (QData)(lwp[i]);
+	owp[i] = (IData)carry;
+	carry >>= VL_ULL(32);
+    }
+    for (; carry && i<owords; i++) {
+	carry += (QData)(owp[i]);
+	owp[i] = (IData)carry;
+	carry >>= VL_ULL(32);
+    }
+}
+
+static void vl_mul_sub(int owords, WDataOutP owp, int words, WDataInP lwp) {
+    // owp -= lwp, borrow propagating through owords
+    QData borrow = 0;
+    int i=0;
+    for (; i<words; i++) {
+	QData diff = (QData)(owp[i]) - (QData)(lwp[i]) - borrow;
+	owp[i] = (IData)diff;
+	borrow = diff>>VL_ULL(63);
+    }
+    for (; borrow && i<owords; i++) {
+	borrow = (owp[i]==0);
+	owp[i]--;
+    }
+}
+
+static void vl_mul_full(int n, WDataOutP owp, WDataInP lwp, WDataInP rwp, WDataOutP scratchp) {
+    // owp[0..2n) = lwp[0..n) * rwp[0..n); scratchp has 4n+128 words
+    if (n < VL_MUL_KARATSUBA_WORDS) {
+	vl_mul_school(n, n, 2*n, owp, lwp, rwp);
+	return;
+    }
+    int h = n - n/2;  // Low half words
+    int m = n/2;      // High half words, m <= h
+    vl_mul_full(h, owp, lwp, rwp, scratchp);  // z0
+    vl_mul_full(m, owp+2*h, lwp+h, rwp+h, scratchp);  // z2
+    WDataOutP sap = scratchp;  scratchp += h+1;
+    WDataOutP sbp = scratchp;  scratchp += h+1;
+    WDataOutP z1p = scratchp;  scratchp += 2*h+2;
+    sap[h] = vl_mul_add(h, sap, lwp, m, lwp+h);
+    sbp[h] = vl_mul_add(h, sbp, rwp, m, rwp+h);
+    vl_mul_full(h+1, z1p, sap, sbp, scratchp);
+    // z1 = (l0+l1)*(r0+r1) - z0 - z2 = l0*r1 + l1*r0
+    vl_mul_sub(2*h+2, z1p, 2*h, owp);
+    vl_mul_sub(2*h+2, z1p, 2*m, owp+2*h);
+    int z1words = 2*h+2;  if (z1words > 2*n-h) z1words = 2*n-h;  // Upper words must be zero
+    vl_mul_acc(2*n-h, owp+h, z1words, z1p);
+}
+
+static void vl_mul_low(int n, WDataOutP owp, WDataInP lwp, WDataInP rwp, WDataOutP scratchp) {
+    // owp[0..n) = low n words of lwp[0..n) * rwp[0..n); scratchp has 6n+128 words
+    if (n < VL_MUL_KARATSUBA_WORDS) {
+	vl_mul_school(n, n, n, owp, lwp, rwp);
+	return;
+    }
+    int h = n - n/2;
+    int m = n/2;
+    WDataOutP z0p = scratchp;  scratchp += 2*h;
+    WDataOutP crossp = scratchp;  scratchp += m;
+    vl_mul_full(h, z0p, lwp, rwp, scratchp);
+    for (int i=0; i<n; i++) owp[i] = z0p[i];
+    vl_mul_low(m, crossp, lwp+h, rwp, scratchp);
+    vl_mul_acc(m, owp+h, m, crossp);
+    vl_mul_low(m, crossp, lwp, rwp+h, scratchp);
+    vl_mul_acc(m, owp+h, m, crossp);
+}
+
+WDataOutP _vl_mul_w(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    // Requires clean input; owp must not overlap inputs, as with VL_MUL_W
+    // Zero upper words contribute nothing
+    int lwords = words;  while (lwords && !lwp[lwords-1]) --lwords;
+    int rwords = words;  while (rwords && !rwp[rwords-1]) --rwords;
+    int minwords = (lwords < rwords) ? lwords : rwords;
+    if (minwords < VL_MUL_KARATSUBA_WORDS) {
+	vl_mul_school(lwords, rwords, words, owp, lwp, rwp);
+	return owp;
+    }
+    // Scratch is on the stack for common widths, only very wide multiplies allocate
+    WData stackScratch[8*VL_MUL_STACK_WORDS+256];
+    vector<WData> heapScratch;
+    WDataOutP scratchp = stackScratch;
+    if (VL_UNLIKELY(words > VL_MUL_STACK_WORDS)) {
+	heapScratch.resize(8*words+256);
+	scratchp = &heapScratch[0];
+    }
+    if (lwords + rwords <= words) {
+	// Whole product fits; multiply only the non-zero words
+	int n = (lwords > rwords) ? lwords : rwords;
+	WDataOutP lpadp = scratchp;
+	WDataOutP rpadp = lpadp + n;
+	WDataOutP fullp = rpadp + n;
+	for (int i=0; i<n; i++) { lpadp[i] = i<lwords ? lwp[i] : 0;  rpadp[i] = i<rwords ? rwp[i] : 0; }
+	vl_mul_full(n, fullp, lpadp, rpadp, fullp + 2*n);
+	for (int i=0; i<words; i++) owp[i] = i<2*n ? fullp[i] : 0;
+    } else {
+	vl_mul_low(words, owp, lwp, rwp, scratchp);
+    }
+    return owp;
+}
+
 WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, bool is_modulus) {
     // See Knuth Algorithm D.  Computes u/v = q.r
     // This isn't massively tuned, as wide division is rare
@@ -185,6 +333,13 @@ WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, boo
 	return owp;
     }
 
+    if (umsbp1 < vmsbp1) {  // Dividend less than divisor, so quotient is zero
+	if (is_modulus) {
+	    for (int i=0; i<words; i++) owp[i] = lwp[i];
+	}
+	return owp;
+    }
+
     int uw = VL_WORDS_I(umsbp1);  // aka "m" in the algorithm
     int vw = VL_WORDS_I(vmsbp1);  // aka "n" in the algorithm
 
@@ -278,6 +433,295 @@ WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, boo
     }
 }
 
+//===========================================================================
+// Wide operator kernels
+//
+// Scalar versions are the same loops as the inline operators in verilated.h.
+// The x86 versions use per-function target attributes, so they are compiled
+// regardless of the -m flags the model is built with, and only called after
+// checking the executing CPU supports them.
+
+#if !defined(VL_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+# define VL_SIMD_X86 1
+# include <immintrin.h>
+#endif
+
+static void vl_scalar_and(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    for (int i=0; i<words; i++) owp[i] = lwp[i] & rwp[i];
+}
+static void vl_scalar_or(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    for (int i=0; i<words; i++) owp[i] = lwp[i] | rwp[i];
+}
+static void vl_scalar_xor(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) {
+    for (int i=0; i<words; i++) owp[i] = lwp[i] ^ rwp[i];
+}
+static void vl_scalar_not(int words, WDataOutP owp, WDataInP lwp) {
+    for (int i=0; i<words; i++) owp[i] = ~lwp[i];
+}
+static IData vl_scalar_changeXor(int words, WDataInP lwp, WDataInP rwp) {
+    IData od = 0;
+    for (int i=0; i<words; i++) od |= lwp[i] ^ rwp[i];
+    return od;
+}
+static IData vl_scalar_redOr(int words, WDataInP lwp) {
+    IData od = 0;
+    for (int i=0; i<words; i++) od |= lwp[i];
+    return od;
+}
+static IData vl_scalar_countOnes(int words, WDataInP lwp) {
+    IData r = 0;
+    for (int i=0; i<words; i++) r += VL_COUNTONES_I(lwp[i]);
+    return r;
+}
+static void vl_scalar_funnel(int words, WDataOutP owp, WDataInP hiwp, WDataInP lowp, int lshift) {
+    for (int i=0; i<words; i++) owp[i] = (hiwp[i]<<lshift) | (lowp[i]>>(32-lshift));
+}
+static int vl_scalar_firstDiff(int words, WDataInP lwp, WDataInP rwp) {
+    int i=0;
+    while (i<words && lwp[i]==rwp[i]) i++;
+    return i;
+}
+
+static const VerilatedSimd::Kernels vl_simd_scalar = {
+    "scalar", &vl_scalar_and, &vl_scalar_or, &vl_scalar_xor, &vl_scalar_not,
+    &vl_scalar_changeXor, &vl_scalar_redOr, &vl_scalar_countOnes, &vl_scalar_funnel,
+    &vl_scalar_firstDiff
+};
+
+#ifdef VL_SIMD_X86
+
+// Each kernel processes whole vectors, then finishes with the scalar loop.
+// Loads and stores are unaligned, as signals are only word aligned.
+
+#define VL_SIMD_SSE2 __attribute__((target("sse2")))
+#define VL_SIMD_AVX2 __attribute__((target("avx2")))
+
+#define VL_SIMD_SSE2_BINARY(name, vop, sop) \
+    static VL_SIMD_SSE2 void vl_sse2_ ## name(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) { \
+	int i=0; \
+	for (; i+4<=words; i+=4) { \
+	    __m128i l = _mm_loadu_si128((const __m128i*)(lwp+i)); \
+	    __m128i r = _mm_loadu_si128((const __m128i*)(rwp+i)); \
+	    _mm_storeu_si128((__m128i*)(owp+i), vop(l,r)); \
+	} \
+	for (; i<words; i++) owp[i] = lwp[i] sop rwp[i]; \
+    }
+#define VL_SIMD_AVX2_BINARY(name, vop, sop) \
+    static VL_SIMD_AVX2 void vl_avx2_ ## name(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp) { \
+	int i=0; \
+	for (; i+8<=words; i+=8) { \
+	    __m256i l = _mm256_loadu_si256((const __m256i*)(lwp+i)); \
+	    __m256i r = _mm256_loadu_si256((const __m256i*)(rwp+i)); \
+	    _mm256_storeu_si256((__m256i*)(owp+i), vop(l,r)); \
+	} \
+	for (; i<words; i++) owp[i] = lwp[i] sop rwp[i]; \
+    }
+
+VL_SIMD_SSE2_BINARY(and, _mm_and_si128, &)
+VL_SIMD_SSE2_BINARY(or,  _mm_or_si128,  |)
+VL_SIMD_SSE2_BINARY(xor, _mm_xor_si128, ^)
+VL_SIMD_AVX2_BINARY(and, _mm256_and_si256, &)
+VL_SIMD_AVX2_BINARY(or,  _mm256_or_si256,  |)
+VL_SIMD_AVX2_BINARY(xor, _mm256_xor_si256, ^)
+
+static VL_SIMD_SSE2 inline IData vl_sse2_orLanes(__m128i v) {
+    v = _mm_or_si128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2)));
+    v = _mm_or_si128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2,3,0,1)));
+    return (IData)_mm_cvtsi128_si32(v);
+}
+static VL_SIMD_AVX2 inline IData vl_avx2_orLanes(__m256i v) {
+    __m128i h = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v,1));
+    h = _mm_or_si128(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(1,0,3,2)));
+    h = _mm_or_si128(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(2,3,0,1)));
+    return (IData)_mm_cvtsi128_si32(h);
+}
+
+static VL_SIMD_SSE2 void vl_sse2_not(int words, WDataOutP owp, WDataInP lwp) {
+    __m128i ones = _mm_set1_epi32(-1);
+    int i=0;
+    for (; i+4<=words; i+=4) {
+	__m128i l = _mm_loadu_si128((const __m128i*)(lwp+i));
+	_mm_storeu_si128((__m128i*)(owp+i), _mm_xor_si128(l,ones));
+    }
+    for (; i<words; i++) owp[i] = ~lwp[i];
+}
+static VL_SIMD_AVX2 void vl_avx2_not(int words, WDataOutP owp, WDataInP lwp) {
+    __m256i ones = _mm256_set1_epi32(-1);
+    int i=0;
+    for (; i+8<=words; i+=8) {
+	__m256i l = _mm256_loadu_si256((const __m256i*)(lwp+i));
+	_mm256_storeu_si256((__m256i*)(owp+i), _mm256_xor_si256(l,ones));
+    }
+    for (; i<words; i++) owp[i] = ~lwp[i];
+}
+
+static VL_SIMD_SSE2 IData vl_sse2_changeXor(int words, WDataInP lwp, WDataInP rwp) {
+    __m128i acc = _mm_setzero_si128();
+    int i=0;
+    for (; i+4<=words; i+=4) {
+	__m128i l = _mm_loadu_si128((const __m128i*)(lwp+i));
+	__m128i r = _mm_loadu_si128((const __m128i*)(rwp+i));
+	acc = _mm_or_si128(acc, _mm_xor_si128(l,r));
+    }
+    IData od = vl_sse2_orLanes(acc);
+    for (; i<words; i++) od |= lwp[i] ^ rwp[i];
+    return od;
+}
+static VL_SIMD_AVX2 IData vl_avx2_changeXor(int words, WDataInP lwp, WDataInP rwp) {
+    __m256i acc = _mm256_setzero_si256();
+    int i=0;
+    for (; i+8<=words; i+=8) {
+	__m256i l = _mm256_loadu_si256((const __m256i*)(lwp+i));
+	__m256i r = _mm256_loadu_si256((const __m256i*)(rwp+i));
+	acc = _mm256_or_si256(acc, _mm256_xor_si256(l,r));
+    }
+    IData od = vl_avx2_orLanes(acc);
+    for (; i<words; i++) od |= lwp[i] ^ rwp[i];
+    return od;
+}
+
+static VL_SIMD_SSE2 IData vl_sse2_redOr(int words, WDataInP lwp) {
+    __m128i acc = _mm_setzero_si128();
+    int i=0;
+    for (; i+4<=words; i+=4) acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(lwp+i)));
+    IData od = vl_sse2_orLanes(acc);
+    for (; i<words; i++) od |= lwp[i];
+    return od;
+}
+static VL_SIMD_AVX2 IData vl_avx2_redOr(int words, WDataInP lwp) {
+    __m256i acc = _mm256_setzero_si256();
+    int i=0;
+    for (; i+8<=words; i+=8) acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i*)(lwp+i)));
+    IData od = vl_avx2_orLanes(acc);
+    for (; i<words; i++) od |= lwp[i];
+    return od;
+}
+
+static VL_SIMD_SSE2 IData vl_sse2_countOnes(int words, WDataInP lwp) {
+    // Bit-slice count within each byte, then sum bytes with SAD
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+    __m128i acc = _mm_setzero_si128();
+    int i=0;
+    for (; i+4<=words; i+=4) {
+	__m128i v = _mm_loadu_si128((const __m128i*)(lwp+i));
+	v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v,1), m1));
+	v = _mm_add_epi8(_mm_and_si128(v,m2), _mm_and_si128(_mm_srli_epi16(v,2), m2));
+	v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v,4)), m4);
+	acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    IData r = (IData)_mm_cvtsi128_si32(acc)
+	+ (IData)_mm_cvtsi128_si32(_mm_shuffle_epi32(acc, _MM_SHUFFLE(1,0,3,2)));
+    for (; i<words; i++) r += VL_COUNTONES_I(lwp[i]);
+    return r;
+}
+static VL_SIMD_AVX2 IData vl_avx2_countOnes(int words, WDataInP lwp) {
+    // Nibble table lookup, then sum bytes with SAD
+    const __m256i table = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+					   0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i m4 = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    int i=0;
+    for (; i+8<=words; i+=8) {
+	__m256i v = _mm256_loadu_si256((const __m256i*)(lwp+i));
+	__m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, m4));
+	__m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v,4), m4));
+	acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo,hi), _mm256_setzero_si256()));
+    }
+    __m128i h = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc,1));
+    IData r = (IData)_mm_cvtsi128_si32(h)
+	+ (IData)_mm_cvtsi128_si32(_mm_shuffle_epi32(h, _MM_SHUFFLE(1,0,3,2)));
+    for (; i<words; i++) r += VL_COUNTONES_I(lwp[i]);
+    return r;
+}
+
+static VL_SIMD_SSE2 void vl_sse2_funnel(int words, WDataOutP owp, WDataInP hiwp, WDataInP lowp, int lshift) {
+    __m128i lcount = _mm_cvtsi32_si128(lshift);
+    __m128i rcount = _mm_cvtsi32_si128(32-lshift);
+    int i=0;
+    for (; i+4<=words; i+=4) {
+	__m128i h = _mm_loadu_si128((const __m128i*)(hiwp+i));
+	__m128i l = _mm_loadu_si128((const __m128i*)(lowp+i));
+	_mm_storeu_si128((__m128i*)(owp+i), _mm_or_si128(_mm_sll_epi32(h,lcount), _mm_srl_epi32(l,rcount)));
+    }
+    for (; i<words; i++) owp[i] = (hiwp[i]<<lshift) | (lowp[i]>>(32-lshift));
+}
+static VL_SIMD_AVX2 void vl_avx2_funnel(int words, WDataOutP owp, WDataInP hiwp, WDataInP lowp, int lshift) {
+    __m128i lcount = _mm_cvtsi32_si128(lshift);
+    __m128i rcount = _mm_cvtsi32_si128(32-lshift);
+    int i=0;
+    for (; i+8<=words; i+=8) {
+	__m256i h = _mm256_loadu_si256((const __m256i*)(hiwp+i));
+	__m256i l = _mm256_loadu_si256((const __m256i*)(lowp+i));
+	_mm256_storeu_si256((__m256i*)(owp+i), _mm256_or_si256(_mm256_sll_epi32(h,lcount),
+							       _mm256_srl_epi32(l,rcount)));
+    }
+    for (; i<words; i++) owp[i] = (hiwp[i]<<lshift) | (lowp[i]>>(32-lshift));
+}
+
+static VL_SIMD_SSE2 int vl_sse2_firstDiff(int words, WDataInP lwp, WDataInP rwp) {
+    int i=0;
+    for (; i+4<=words; i+=4) {
+	__m128i l = _mm_loadu_si128((const __m128i*)(lwp+i));
+	__m128i r = _mm_loadu_si128((const __m128i*)(rwp+i));
+	int eq = _mm_movemask_epi8(_mm_cmpeq_epi32(l,r));
+	if (eq != 0xffff) return i + __builtin_ctz(~eq)/4;
+    }
+    while (i<words && lwp[i]==rwp[i]) i++;
+    return i;
+}
+static VL_SIMD_AVX2 int vl_avx2_firstDiff(int words, WDataInP lwp, WDataInP rwp) {
+    int i=0;
+    for (; i+8<=words; i+=8) {
+	__m256i l = _mm256_loadu_si256((const __m256i*)(lwp+i));
+	__m256i r = _mm256_loadu_si256((const __m256i*)(rwp+i));
+	unsigned eq = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi32(l,r));
+	if (eq != 0xffffffffU) return i + __builtin_ctz(~eq)/4;
+    }
+    while (i<words && lwp[i]==rwp[i]) i++;
+    return i;
+}
+
+static const VerilatedSimd::Kernels vl_simd_sse2 = {
+    "sse2", &vl_sse2_and, &vl_sse2_or, &vl_sse2_xor, &vl_sse2_not,
+    &vl_sse2_changeXor, &vl_sse2_redOr, &vl_sse2_countOnes, &vl_sse2_funnel,
+    &vl_sse2_firstDiff
+};
+static const VerilatedSimd::Kernels vl_simd_avx2 = {
+    "avx2", &vl_avx2_and, &vl_avx2_or, &vl_avx2_xor, &vl_avx2_not,
+    &vl_avx2_changeXor, &vl_avx2_redOr, &vl_avx2_countOnes, &vl_avx2_funnel,
+    &vl_avx2_firstDiff
+};
+
+#endif  // VL_SIMD_X86
+
+// Scalar until selected, in case a model is evaluated during static construction
+VerilatedSimd::Kernels VerilatedSimd::s_active = vl_simd_scalar;
+
+const VerilatedSimd::Kernels* VerilatedSimd::find(const char* namep) {
+    if (0==strcmp(namep,"scalar")) return &vl_simd_scalar;
+#ifdef VL_SIMD_X86
+    __builtin_cpu_init();
+    if (0==strcmp(namep,"sse2") && __builtin_cpu_supports("sse2")) return &vl_simd_sse2;
+    if (0==strcmp(namep,"avx2") && __builtin_cpu_supports("avx2")) return &vl_simd_avx2;
+#endif
+    return NULL;
+}
+
+static struct VerilatedSimdSelect {
+    VerilatedSimdSelect() {
+	static const char* const names[] = { "avx2", "sse2", NULL };
+	for (const char* const* namepp = names; *namepp; ++namepp) {
+	    if (const VerilatedSimd::Kernels* kernelsp = VerilatedSimd::find(*namepp)) {
+		VerilatedSimd::s_active = *kernelsp;
+		break;
+	    }
+	}
+    }
+} s_vlSimdSelect;
+
 //===========================================================================
 // Formatting
 
@@ -748,7 +1192,7 @@ IData VL_FOPEN_WI(int fnwords, WDataInP filenamep, IData mode) {
     return VL_FOPEN_S(filenamez,modez);
 }
 IData VL_FOPEN_S(const char* filenamep, const char* modep) {
-    return VerilatedImp::fdNew(fopen(filenamep,modep));
+    return VerilatedImp::fdNew(fopen(filenamep,modep), filenamep, modep);
 }
 
 void VL_FCLOSE_I(IData fdi) {
@@ -1021,6 +1465,64 @@ const char* vl_mc_scan_plusargs(const char* prefixp) {
     return outstr;
 }
 
+void VerilatedImp::fdsFork(int stage) {
+#ifndef _WIN32
+    // Standard streams stay shared by all processes
+    if (stage == Verilated::FORK_PREP) {
+	fflush(NULL);  // Else both processes would later write the buffered data
+	s_s.m_fdOffsets.assign(s_s.m_fdps.size(), -1);
+	for (size_t idx=3; idx<s_s.m_fdps.size(); ++idx) {
+	    if (s_s.m_fdps[idx]) s_s.m_fdOffsets[idx] = ftello(s_s.m_fdps[idx]);
+	}
+	return;
+    }
+    for (size_t idx=3; idx<s_s.m_fdps.size() && idx<s_s.m_fdOffsets.size(); ++idx) {
+	FILE* fp = s_s.m_fdps[idx];
+	off_t offset = (off_t)s_s.m_fdOffsets[idx];
+	if (!fp || offset < 0) continue;
+	const string& filename = s_s.m_fdNames[idx].first;
+	const string& mode = s_s.m_fdNames[idx].second;
+	bool writes = mode.find_first_of("wa+") != string::npos;
+	if (stage == Verilated::FORK_REWIND) {
+	    // Discard what was written since the snapshot, and read from there again
+	    if (writes && ftruncate(fileno(fp), offset)) {}
+	    fseeko(fp, offset, SEEK_SET);
+	} else if (stage == Verilated::FORK_CHILD) {
+	    // Reopen so the child has its own offset, and writes its own file
+	    if (writes) {
+		string childname = filename;
+		size_t dot = childname.rfind('.');
+		size_t slash = childname.rfind('/');
+		if (dot == string::npos || (slash != string::npos && dot < slash)) dot = childname.length();
+		char pidstr[20];  sprintf(pidstr, "_%d", (int)getpid());
+		childname.insert(dot, pidstr);
+		// The child's file starts as the parent's was at the snapshot.  An
+		// "r+" file also needs what is still to be read past the offset.
+		FILE* fromp = fopen(filename.c_str(), "rb");
+		fp = freopen(childname.c_str(), (mode[0]=='r') ? "w+" : mode.c_str(), fp);
+		if (fp && fromp) {
+		    off_t left = (mode[0]=='r') ? (off_t)-1 : offset;
+		    char buf[8192];
+		    while (left != 0) {
+			size_t want = (left < 0 || left > (off_t)sizeof(buf)) ? sizeof(buf) : (size_t)left;
+			size_t got = fread(buf, 1, want, fromp);
+			if (!got || fwrite(buf, 1, got, fp) != got) break;
+			if (left > 0) left -= (off_t)got;
+		    }
+		    fflush(fp);
+		}
+		if (fromp) fclose(fromp);
+		if (fp) fseeko(fp, offset, SEEK_SET);
+	    } else {
+		fp = freopen(filename.c_str(), mode.c_str(), fp);
+		if (fp) fseeko(fp, offset, SEEK_SET);
+	    }
+	    if (!fp) fdDelete((IData)idx | (1UL<<31));
+	}
+    }
+#endif
+}
+
 //===========================================================================
 // Heavy functions
 
@@ -1073,6 +1575,27 @@ void Verilated::flushCb(VerilatedVoidCb cb) {
     }
 }
 
+void Verilated::errorCb(VerilatedVoidCb cb) {
+    if (s_errorCb == cb) {}  // Ok - don't duplicate
+    else if (!s_errorCb) { s_errorCb=cb; }
+    else {
+	vl_fatal("unknown",0,"", "Verilated::errorCb called twice with different callbacks");
+    }
+}
+
+void Verilated::forkCb(VerilatedForkCb cb) {
+    if (s_forkCb == cb) {}  // Ok - don't duplicate
+    else if (!s_forkCb) { s_forkCb=cb; }
+    else {
+	vl_fatal("unknown",0,"", "Verilated::forkCb called twice with different callbacks");
+    }
+}
+
+void Verilated::forkCall(ForkStage stage) {
+    VerilatedImp::fdsFork(stage);
+    if (s_forkCb) (*s_forkCb)(stage);
+}
+
 void Verilated::commandArgs(int argc, const char** argv) {
     s_args.argc = argc;
     s_args.argv = argv;
@@ -1182,7 +1705,7 @@ void VerilatedScope::exportInsert(int finalize, const char* namep, void* cb) {
 void VerilatedScope::varInsert(int finalize, const char* namep, void* datap,
 			       VerilatedVarType vltype, int vlflags, int dims, ...) {
     // Grab dimensions
-    // In the future we may just create a large table at emit time and statically construct from that.
+    // Verilator now emits a table for varsConfigure; this remains for hand-built scopes
     if (!finalize) return;
 
     if (!m_varsp) m_varsp = new VerilatedVarNameMap();
@@ -1210,6 +1733,24 @@ void VerilatedScope::varInsert(int finalize, const char* namep, void* datap,
     m_varsp->insert(make_pair(namep,var));
 }
 
+void VerilatedScope::varsConfigure(const VerilatedVarDesc* descsp, void* const* datasp, int count) {
+    // Slowpath - called once/scope at construction
+    // Descriptions are sorted by name, so this is a straight copy with no map to build.
+    // Large scopes come in several calls, each continuing the same table.
+    if (!m_varsp) m_varsp = new VerilatedVarNameMap();
+    if (m_varsp->empty()) m_varsp->reserve(count);
+    for (int i=0; i<count; ++i) {
+	const VerilatedVarDesc& desc = descsp[i];
+	if (VL_UNLIKELY(desc.m_dims > 2)) {
+	    vl_fatal(__FILE__,__LINE__,"",(string("Unsupported multi-dimensional public varsConfigure: ")+desc.m_namep).c_str());
+	}
+	VerilatedVar var (desc.m_namep, datasp[i], desc.m_vltype, (VerilatedVarFlags)desc.m_vlflags, desc.m_dims);
+	if (desc.m_dims >= 1) var.m_range.sets(desc.m_bounds[0], desc.m_bounds[1]);
+	if (desc.m_dims >= 2) var.m_array.sets(desc.m_bounds[2], desc.m_bounds[3]);
+	m_varsp->insert(make_pair(desc.m_namep, var));
+    }
+}
+
 // cppcheck-suppress unusedFunction  // Used by applications
 VerilatedVar* VerilatedScope::varFind(const char* namep) const {
     if (VL_LIKELY(m_varsp)) {
@@ -65,6 +65,7 @@ typedef const WData* WDataInP;	///< Array input to a function
 typedef       WData* WDataOutP;	///< Array output from a function
 
 typedef void (*VerilatedVoidCb)(void);
+typedef void (*VerilatedForkCb)(int stage);
 
 class SpTraceVcd;
 class SpTraceVcdCFile;
@@ -95,6 +96,16 @@ enum VerilatedVarFlags {
     VLVF_PUB_RW=(1<<9)	// Public writable
 };
 
+/// Public variable of a scope, as emitted by Verilator into a read-only
+/// table sorted by name; the data pointers are passed separately
+struct VerilatedVarDesc {
+    const char*		m_namep;	///< Name under the scope
+    VerilatedVarType	m_vltype;	///< Data type
+    int			m_vlflags;	///< VerilatedVarFlags
+    int			m_dims;		///< Number of ranges in m_bounds
+    int			m_bounds[4];	///< Range then array, as left,right pairs
+};
+
 //=========================================================================
 /// Base class for all Verilated module classes
 
@@ -194,6 +205,7 @@ public:  // But internals only - called from VerilatedModule's
     void exportInsert(int finalize, const char* namep, void* cb);
     void varInsert(int finalize, const char* namep, void* datap,
 		   VerilatedVarType vltype, int vlflags, int dims, ...);
+    void varsConfigure(const VerilatedVarDesc* descsp, void* const* datasp, int count);
     // ACCESSORS
     const char* name() const { return m_namep; }
     inline VerilatedSyms* symsp() const { return m_symsp; }
@@ -220,6 +232,8 @@ class Verilated {
     // MEMBERS
     // Slow path variables
     static VerilatedVoidCb  s_flushCb;		///< Flush callback function
+    static VerilatedVoidCb  s_errorCb;		///< Error callback function
+    static VerilatedForkCb  s_forkCb;		///< Fork callback function
 
     static struct Serialized {   // All these members serialized/deserialized
 	// Slow path
@@ -282,6 +296,18 @@ public:
     /// Flush callback for VCD waves
     static void flushCb(VerilatedVoidCb cb);
     static void flushCall() { if (s_flushCb) (*s_flushCb)(); }
+    /// Error callback for VCD ring buffers, made by $stop and vl_fatal before flushCall
+    static void errorCb(VerilatedVoidCb cb);
+    static void errorCall() { if (s_errorCb) (*s_errorCb)(); }
+    /// Stages of a VerilatedSnapshot fork, passed to forkCall
+    enum ForkStage { FORK_PREP,		///< Before fork; flush files and stop threads
+		     FORK_RESUME,	///< After fork, continuing with the same files
+		     FORK_CHILD,	///< In a forkChild child; must not share written files
+		     FORK_REWIND };	///< In a process resuming an earlier snapshot
+    /// Fork callback for VCD waves
+    static void forkCb(VerilatedForkCb cb);
+    /// Prepare files for, or recover them after, a fork
+    static void forkCall(ForkStage stage);
 
     /// Record command line arguments, for retrieval by $test$plusargs/$value$plusargs
     static void commandArgs(int argc, const char** argv);
@@ -348,6 +374,7 @@ extern WDataOutP VL_ZERO_RESET_W(int obits, WDataOutP outwp);	///< Zero reset a
 
 /// Math
 extern WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, bool is_modulus);
+extern WDataOutP _vl_mul_w(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp);
 
 /// File I/O
 extern IData VL_FGETS_IXI(int obits, void* destp, IData fpi);
@@ -385,6 +412,47 @@ extern IData VL_TESTPLUSARGS_I(const char* formatp);
 extern IData VL_VALUEPLUSARGS_IW(int rbits, const char* prefixp, char fmt, WDataOutP rwp);
 extern const char* vl_mc_scan_plusargs(const char* prefixp);  // PLIish
 
+//=========================================================================
+// Wide operator kernels -- See verilated.cpp
+
+/// Wide operators with at least this many words call the vectorized kernels
+#ifndef VL_SIMD_MIN_WORDS
+# define VL_SIMD_MIN_WORDS 8
+#endif
+#ifdef VL_NO_SIMD
+# define VL_SIMD_WIDE(words) 0
+#else
+# define VL_SIMD_WIDE(words) ((words) >= VL_SIMD_MIN_WORDS)	///< Use kernels for this width
+#endif
+
+/// Kernels for wide operators.  At startup the fastest set the CPU
+/// supports (scalar, SSE2 or AVX2) is copied into s_active, which the
+/// wide inline functions below call for operands of VL_SIMD_WIDE size.
+class VerilatedSimd {
+public:
+    typedef void  (*BinaryFunc)(int words, WDataOutP owp, WDataInP lwp, WDataInP rwp);
+    typedef void  (*UnaryFunc)(int words, WDataOutP owp, WDataInP lwp);
+    typedef IData (*ReduceFunc)(int words, WDataInP lwp);
+    typedef IData (*ReduceBinaryFunc)(int words, WDataInP lwp, WDataInP rwp);
+    typedef void  (*FunnelFunc)(int words, WDataOutP owp, WDataInP hiwp, WDataInP lowp, int lshift);
+    typedef int   (*FindFunc)(int words, WDataInP lwp, WDataInP rwp);
+    struct Kernels {
+	const char*	  m_namep;	///< Instruction set name
+	BinaryFunc	  m_and;	///< owp = lwp & rwp
+	BinaryFunc	  m_or;		///< owp = lwp | rwp
+	BinaryFunc	  m_xor;	///< owp = lwp ^ rwp
+	UnaryFunc	  m_not;	///< owp = ~lwp
+	ReduceBinaryFunc  m_changeXor;	///< OR of all lwp^rwp words
+	ReduceFunc	  m_redOr;	///< OR of all words
+	ReduceFunc	  m_countOnes;	///< Number of set bits
+	FunnelFunc	  m_funnel;	///< owp[i] = hiwp[i]<<lshift | lowp[i]>>(32-lshift), 0<lshift<32
+	FindFunc	  m_firstDiff;	///< Lowest i where lwp[i]!=rwp[i], or words if none
+    };
+    static Kernels s_active;	///< Kernels in use
+    /// Kernel set with given name ("scalar", "sse2", "avx2"), NULL if the CPU lacks support
+    static const Kernels* find(const char* namep);
+};
+
 //=========================================================================
 // Base macros
 
@@ -399,6 +467,9 @@ extern const char* vl_mc_scan_plusargs(const char* prefixp);  // PLIish
 #define VL_SET_WI(owp,data)	{ owp[0]=(IData)(data); owp[1]=0; }
 #define VL_SET_QW(lwp)		( ((QData)(lwp[0])) | ((QData)(lwp[1])<<((QData)(VL_WORDSIZE)) ))
 #define _VL_SET_QII(ld,rd)      ( ((QData)(ld)<<VL_ULL(32)) | (QData)(rd) )
+/// Internal: Words i and i+1 of a wide as a quad, for quad at a time wide math
+#define _VL_GET_QW(lwp,i)	( ((QData)((lwp)[(i)])) | ((QData)((lwp)[(i)+1])<<((QData)(VL_WORDSIZE)) ))
+#define _VL_PUT_QW(owp,i,data)	{ (owp)[(i)]=(IData)(data); (owp)[(i)+1]=(IData)((data)>>VL_WORDSIZE); }
 
 /// Return FILE* from IData
 extern FILE*  VL_CVT_I_FP(IData lhs);
@@ -699,6 +770,7 @@ static inline IData VL_REDAND_IW(int, int lbits, WDataInP lwp) {
 #define VL_REDOR_I(lhs) (lhs!=0)
 #define VL_REDOR_Q(lhs) (lhs!=0)
 static inline IData VL_REDOR_W(int words, WDataInP lwp) {
+    if (VL_SIMD_WIDE(words)) return VerilatedSimd::s_active.m_redOr(words,lwp)!=0;
     IData equal=0;
     for (int i=0; i < words; i++) equal |= lwp[i];
     return(equal!=0);
@@ -769,6 +841,7 @@ static inline IData VL_COUNTONES_Q(QData lhs) {
     return VL_COUNTONES_I((IData)lhs) + VL_COUNTONES_I((IData)(lhs>>32));
 }
 static inline IData VL_COUNTONES_W(int words, WDataInP lwp) {
+    if (VL_SIMD_WIDE(words)) return VerilatedSimd::s_active.m_countOnes(words,lwp);
     IData r = 0;
     for (int i=0; (i < words); i++) r+=VL_COUNTONES_I(lwp[i]);
     return r;
@@ -860,22 +933,26 @@ static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) {
 
 // EMIT_RULE: VL_AND:  oclean=lclean||rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_AND_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    if (VL_SIMD_WIDE(words)) { VerilatedSimd::s_active.m_and(words,owp,lwp,rwp); return(owp); }
     for (int i=0; (i < words); i++) owp[i] = (lwp[i] & rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_OR:   oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_OR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    if (VL_SIMD_WIDE(words)) { VerilatedSimd::s_active.m_or(words,owp,lwp,rwp); return(owp); }
     for (int i=0; (i < words); i++) owp[i] = (lwp[i] | rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_CHANGEXOR:  oclean=1; obits=32; lbits==rbits;
 static inline IData VL_CHANGEXOR_W(int words, WDataInP lwp,WDataInP rwp){
+    if (VL_SIMD_WIDE(words)) return VerilatedSimd::s_active.m_changeXor(words,lwp,rwp);
     IData od = 0;
     for (int i=0; (i < words); i++) od |= (lwp[i] ^ rwp[i]);
     return(od);
 }
 // EMIT_RULE: VL_XOR:  oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    if (VL_SIMD_WIDE(words)) { VerilatedSimd::s_active.m_xor(words,owp,lwp,rwp); return(owp); }
     for (int i=0; (i < words); i++) owp[i] = (lwp[i] ^ rwp[i]);
     return(owp);
 }
@@ -886,6 +963,7 @@ static inline WDataOutP VL_XNOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP
 }
 // EMIT_RULE: VL_NOT:  oclean=dirty; obits=lbits;
 static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
+    if (VL_SIMD_WIDE(words)) { VerilatedSimd::s_active.m_not(words,owp,lwp); return(owp); }
     for (int i=0; i < words; i++) owp[i] = ~(lwp[i]);
     return(owp);
 }
@@ -907,6 +985,7 @@ static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
 
 // Output clean, <lhs> AND <rhs> MUST BE CLEAN
 static inline IData VL_EQ_W(int words, WDataInP lwp, WDataInP rwp) {
+    if (VL_SIMD_WIDE(words)) return VerilatedSimd::s_active.m_changeXor(words,lwp,rwp)==0;
     int nequal=0;
     for (int i=0; (i < words); i++) nequal |= (lwp[i] ^ rwp[i]);
     return(nequal==0);
@@ -914,9 +993,18 @@ static inline IData VL_EQ_W(int words, WDataInP lwp, WDataInP rwp) {
 
 // Internal usage
 static inline int _VL_CMP_W(int words, WDataInP lwp, WDataInP rwp) {
-    for (int i=words-1; i>=0; --i) {
+    int i=words-1;
+    if (words & 1) {  // Odd top word
 	if (lwp[i] > rwp[i]) return 1;
 	if (lwp[i] < rwp[i]) return -1;
+	--i;
+    }
+    // Remaining words compared a quad at a time
+    for (i--; i>=0; i-=2) {
+	QData l = _VL_GET_QW(lwp,i);
+	QData r = _VL_GET_QW(rwp,i);
+	if (l > r) return 1;
+	if (l < r) return -1;
     }
     return(0); // ==
 }
@@ -1000,24 +1088,34 @@ static inline int _VL_CMPS_W(int lbits, WDataInP lwp, WDataInP rwp) {
 #define VL_MODDIV_QQQ(lbits,lhs,rhs)	(((rhs)==0)?0:(lhs)%(rhs))
 #define VL_MODDIV_WWW(lbits,owp,lwp,rwp) (_vl_moddiv_w(lbits,owp,lwp,rwp,1))
 
+// Wide add/subtract work a quad (two words) at a time, taking the carry or
+// borrow from the unsigned wraparound, so need half the iterations.
 static inline WDataOutP VL_ADD_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
     QData carry = 0;
-    for (int i=0; i<words; i++) {
-	carry = carry + (QData)(lwp[i]) + (QData)(rwp[i]);
-	owp[i] = (carry & VL_ULL(0xffffffff));
-	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
+    int i=0;
+    for (; i+1<words; i+=2) {
+	QData l = _VL_GET_QW(lwp,i);
+	QData sum = l + _VL_GET_QW(rwp,i);
+	QData out = sum + carry;
+	carry = (sum < l) | (out < sum);
+	_VL_PUT_QW(owp,i,out);
     }
+    if (i<words) owp[i] = lwp[i] + rwp[i] + (IData)carry;
     return(owp);
 }
 
 static inline WDataOutP VL_SUB_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    QData carry = 0;
-    for (int i=0; i<words; i++) {
-	carry = carry + (QData)(lwp[i]) + (QData)(IData)(~rwp[i]);
-	if (i==0) carry++;  // Negation of temp2
-	owp[i] = (carry & VL_ULL(0xffffffff));
-	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
+    QData borrow = 0;
+    int i=0;
+    for (; i+1<words; i+=2) {
+	QData l = _VL_GET_QW(lwp,i);
+	QData r = _VL_GET_QW(rwp,i);
+	QData diff = l - r;
+	QData out = diff - borrow;
+	borrow = (l < r) | (diff < borrow);
+	_VL_PUT_QW(owp,i,out);
     }
+    if (i<words) owp[i] = lwp[i] - rwp[i] - (IData)borrow;
     return(owp);
 }
 
@@ -1028,27 +1126,35 @@ static inline IData  VL_NEGATE_I(IData data) { return -data; }
 static inline QData  VL_NEGATE_Q(QData data) { return -data; }
 
 static inline WDataOutP VL_NEGATE_W(int words, WDataOutP owp,WDataInP lwp){
-    QData carry = 0;
-    for (int i=0; i<words; i++) {
-	carry = carry + (QData)(IData)(~lwp[i]);
-	if (i==0) carry++;  // Negation of temp2
-	owp[i] = (carry & VL_ULL(0xffffffff));
-	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
+    QData borrow = 0;
+    int i=0;
+    for (; i+1<words; i+=2) {
+	QData l = _VL_GET_QW(lwp,i);
+	QData out = VL_ULL(0) - l - borrow;
+	borrow |= (l != 0);
+	_VL_PUT_QW(owp,i,out);
     }
+    if (i<words) owp[i] = (IData)0 - lwp[i] - (IData)borrow;
     return(owp);
 }
 
 static inline WDataOutP VL_MUL_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    if (VL_UNLIKELY(words >= VL_MUL_KARATSUBA_WORDS)) return _vl_mul_w(words,owp,lwp,rwp);
     for (int i=0; i<words; i++) owp[i] = 0;
-    for (int lword=0; lword<words; lword++) {
-	for (int rword=0; rword<words; rword++) {
-	    QData mul = (QData)(lwp[lword]) * (QData)(rwp[rword]);
-	    for (int qword=lword+rword; qword<words; qword++) {
-		mul += (QData)(owp[qword]);
-		owp[qword] = (mul & VL_ULL(0xffffffff));
-		mul = (mul >> VL_ULL(32)) & VL_ULL(0xffffffff);
-	    }
+    // Zero upper words contribute nothing
+    int lwords = words;  while (lwords && !lwp[lwords-1]) --lwords;
+    int rwords = words;  while (rwords && !rwp[rwords-1]) --rwords;
+    for (int lword=0; lword<lwords; lword++) {
+	QData ld = lwp[lword];
+	if (!ld) continue;
+	int rmax = words-lword;  if (rmax > rwords) rmax = rwords;
+	QData carry = 0;  // ld*r + o + carry always fits in a quad
+	for (int rword=0; rword<rmax; rword++) {
+	    carry += ld * (QData)(rwp[rword]) + (QData)(owp[lword+rword]);
+	    owp[lword+rword] = (IData)carry;
+	    carry >>= VL_ULL(32);
 	}
+	if (lword+rmax < words) owp[lword+rmax] = (IData)carry;
     }
     // Last output word is dirty
     return(owp);
@@ -1258,6 +1364,16 @@ static inline void _VL_INSERT_WW(int, WDataOutP owp, WDataInP lwp, int hbit, int
 	int nbitsonright = 32-loffset;  // bits that end up in lword (know loffset!=0)
 	// Middle words
 	int hword = VL_BITWORD_I(hbit);
+	if (VL_SIMD_WIDE(hword-lword)) {
+	    // Each whole middle word is a funnel shift of two adjacent input words
+	    int midwords = hword-lword-1;
+	    owp[lword] = (owp[lword] & ~linsmask) | ((lwp[0]<<loffset) & linsmask);
+	    VerilatedSimd::s_active.m_funnel(midwords, owp+lword+1, lwp+1, lwp, loffset);
+	    IData d = lwp[midwords]>>nbitsonright;
+	    if (midwords+1 < words) d |= lwp[midwords+1]<<loffset;
+	    owp[hword] = (owp[hword] & ~hinsmask) | (d & hinsmask);
+	    return;
+	}
 	for (int i=0; i<words; i++) {
 	    {	// Lower word
 		int oword = lword+i;
@@ -1442,7 +1558,14 @@ static inline WDataOutP VL_SHIFTR_WWI(int obits,int,int,WDataOutP owp,WDataInP l
 	int nbitsonright = 32-loffset;  // bits that end up in lword (know loffset!=0)
 	// Middle words
 	int words = VL_WORDS_I(obits-rd);
-	for (int i=0; i<words; i++) {
+	int i=0;
+	if (VL_SIMD_WIDE(words)) {
+	    // Words with an upper input word are a funnel shift
+	    i = VL_WORDS_I(obits)-word_shift-1;
+	    if (i > words) i = words;
+	    VerilatedSimd::s_active.m_funnel(i, owp, lwp+word_shift+1, lwp+word_shift, nbitsonright);
+	}
+	for (; i<words; i++) {
 	    owp[i] = lwp[i+word_shift]>>loffset;
 	    int upperword = i+word_shift+1;
 	    if (upperword < VL_WORDS_I(obits)) {
@@ -27,6 +27,7 @@
 #include "verilatedos.h"
 #include "verilated_dpi.h"
 #include "verilated_imp.h"
+#include "verilated_syms.h"
 
 // On MSVC++ we need svdpi.h to declare exports, not imports
 #define DPI_PROTOTYPES
@@ -46,6 +47,10 @@
 #define _VL_SVDPI_CONTEXT_WARN() \
     VL_PRINTF("%%Warning: DPI C Function called by Verilog DPI import with missing 'context' keyword.\n");
 
+// Open array index outside its range
+#define _VL_SVDPI_RANGE_WARN() \
+    VL_PRINTF("%%Warning: DPI C Function %s called with open array indices out of range.\n", VL_FUNC);
+
 //======================================================================
 //======================================================================
 //======================================================================
@@ -86,47 +91,207 @@ void svPutPartselLogic(svLogicVecVal* d, const svLogicVecVal s, int i, int w) {
     _VL_SVDPI_UNIMP();
 }
 
+//======================================================================
+// VerilatedDpiOpenVar
+
+VerilatedDpiOpenVar::VerilatedDpiOpenVar(const VerilatedVar* varp) {
+    // range() is always the packed range; Verilator gives arrays of single
+    // bits a 0:0 range, so a one dimensional var is never unpacked
+    m_datap = varp->datap();
+    int bounds[4];
+    bounds[0] = varp->range().left();  bounds[1] = varp->range().right();
+    bounds[2] = varp->array().left();  bounds[3] = varp->array().right();
+    init(varp->vltype(), varp->dims(), bounds);
+}
+
+VerilatedDpiOpenVar::VerilatedDpiOpenVar(void* datap, VerilatedVarType vltype, int dims, ...) {
+    m_datap = datap;
+    int bounds[(MAX_UDIMS+1)*2];
+    if (VL_UNLIKELY(dims > MAX_UDIMS+1)) {
+	vl_fatal(__FILE__,__LINE__,"","Unsupported: DPI open array with over 3 unpacked dimensions");
+    }
+    va_list ap;
+    va_start(ap,dims);
+    for (int i=0; i<dims*2; ++i) bounds[i] = va_arg(ap,int);
+    va_end(ap);
+    init(vltype, dims, bounds);
+}
+
+void VerilatedDpiOpenVar::init(VerilatedVarType vltype, int dims, const int* boundsp) {
+    m_vltype = vltype;
+    m_udims = dims ? dims-1 : 0;
+    for (int d=0; d<=MAX_UDIMS; ++d) {
+	m_left[d] = (d<dims) ? boundsp[d*2] : 0;
+	m_right[d] = (d<dims) ? boundsp[d*2+1] : 0;
+    }
+    m_width = dims ? elements(0) : 1;
+    switch (vltype) {
+    case VLVT_UINT8:	m_entSize = sizeof(CData); break;
+    case VLVT_UINT16:	m_entSize = sizeof(SData); break;
+    case VLVT_UINT32:	m_entSize = sizeof(IData); break;
+    case VLVT_UINT64:	m_entSize = sizeof(QData); break;
+    case VLVT_WDATA:	m_entSize = VL_WORDS_I(m_width)*sizeof(IData); break;
+    default:
+	vl_fatal(__FILE__,__LINE__,"","Unsupported: DPI open array of this element type");
+	m_entSize = 0;
+	break;
+    }
+    // Strides, from the innermost (last, fastest changing) dimension out
+    int stride = m_entSize;
+    for (int d=m_udims; d>=1; --d) {
+	m_stride[d] = stride;
+	stride *= elements(d);
+    }
+    m_stride[0] = stride;
+}
+
+//======================================================================
+// Open array internals
+
+static inline const VerilatedDpiOpenVar* _vl_openhandle(const svOpenArrayHandle h) {
+    return static_cast<const VerilatedDpiOpenVar*>(h);
+}
+
+static void* _vl_sv_adims_ptr(const VerilatedDpiOpenVar* varp, int nargs, const int* indxsp) {
+    // Element pointer, or NULL if the indices don't fit the array
+    if (VL_UNLIKELY(!varp || nargs != varp->udims())) return NULL;
+    return varp->elemPtr(indxsp);
+}
+
+static void* _vl_sv_adims_ptrv(const VerilatedDpiOpenVar* varp, int indx1, va_list ap) {
+    // Element pointer, taking as many indices as the array has dimensions
+    if (VL_UNLIKELY(!varp)) return NULL;
+    int indxs[3];
+    indxs[0] = indx1;
+    for (int d=1; d<varp->udims(); ++d) indxs[d] = va_arg(ap,int);
+    return varp->elemPtr(indxs);
+}
+
+static void _vl_sv_get_bitvec(svBitVecVal* d, const VerilatedDpiOpenVar* varp, const void* datap) {
+    switch (varp->vltype()) {
+    case VLVT_UINT8:	d[0] = *((const CData*)datap); break;
+    case VLVT_UINT16:	d[0] = *((const SData*)datap); break;
+    case VLVT_UINT32:	d[0] = *((const IData*)datap); break;
+    case VLVT_UINT64:	VL_SET_WQ(d, *((const QData*)datap)); break;
+    default:		VL_SET_SVBV_W(varp->width(), d, (WDataInP)datap); break;
+    }
+}
+static void _vl_sv_put_bitvec(const VerilatedDpiOpenVar* varp, void* datap, const svBitVecVal* s) {
+    switch (varp->vltype()) {
+    case VLVT_UINT8:	*((CData*)datap) = s[0] & VL_MASK_I(varp->width()); break;
+    case VLVT_UINT16:	*((SData*)datap) = s[0] & VL_MASK_I(varp->width()); break;
+    case VLVT_UINT32:	*((IData*)datap) = s[0] & VL_MASK_I(varp->width()); break;
+    case VLVT_UINT64:	*((QData*)datap) = VL_SET_QW(s) & VL_MASK_Q(varp->width()); break;
+    default:		VL_SET_W_SVBV(varp->width(), (WDataOutP)datap, (svBitVecVal*)s); break;
+    }
+}
+static void _vl_sv_get_logicvec(svLogicVecVal* d, const VerilatedDpiOpenVar* varp, const void* datap) {
+    // Note we don't create X/Z in svLogicVecVal
+    if (varp->vltype() == VLVT_WDATA) {
+	VL_SET_SVLV_W(varp->width(), d, (WDataInP)datap);
+    } else {
+	svBitVecVal bits[2];
+	_vl_sv_get_bitvec(bits, varp, datap);
+	for (int i=0; i<VL_WORDS_I(varp->width()); ++i) { d[i].aval = bits[i]; d[i].bval = 0; }
+    }
+}
+static void _vl_sv_put_logicvec(const VerilatedDpiOpenVar* varp, void* datap, const svLogicVecVal* s) {
+    // Note we ignore X/Z in svLogicVecVal
+    if (varp->vltype() == VLVT_WDATA) {
+	VL_SET_W_SVLV(varp->width(), (WDataOutP)datap, (svLogicVecVal*)s);
+    } else {
+	svBitVecVal bits[2];
+	bits[0] = s[0].aval;
+	bits[1] = (varp->width() > VL_WORDSIZE) ? s[1].aval : 0;
+	_vl_sv_put_bitvec(varp, datap, bits);
+    }
+}
+static svBit _vl_sv_get_bit(const VerilatedDpiOpenVar* varp, const void* datap) {
+    // Least significant bit; callers use this on arrays of single bits
+    switch (varp->vltype()) {
+    case VLVT_UINT8:	return *((const CData*)datap) & 1;
+    case VLVT_UINT16:	return *((const SData*)datap) & 1;
+    case VLVT_UINT64:	return *((const QData*)datap) & 1;
+    default:		return *((const IData*)datap) & 1;  // IData or WData
+    }
+}
+static void _vl_sv_put_bit(const VerilatedDpiOpenVar* varp, void* datap, svBit value) {
+    // Whole element; callers use this on arrays of single bits
+    switch (varp->vltype()) {
+    case VLVT_UINT8:	*((CData*)datap) = value & 1; break;
+    case VLVT_UINT16:	*((SData*)datap) = value & 1; break;
+    case VLVT_UINT32:	*((IData*)datap) = value & 1; break;
+    case VLVT_UINT64:	*((QData*)datap) = value & 1; break;
+    default:
+	memset(datap, 0, varp->entSize());
+	*((IData*)datap) = value & 1;
+	break;
+    }
+}
+
+// Element pointer of an accessor's indices, or warn and return from the caller
+#define _VL_SV_ELEM_PTR(datap, h, nargs, indxsp, rtn) \
+    void* datap = _vl_sv_adims_ptr(_vl_openhandle(h), (nargs), (indxsp)); \
+    if (VL_UNLIKELY(!datap)) { _VL_SVDPI_RANGE_WARN(); return rtn; }
+#define _VL_SV_ELEM_PTRV(datap, h, indx1, rtn) \
+    va_list ap; \
+    va_start(ap,indx1); \
+    void* datap = _vl_sv_adims_ptrv(_vl_openhandle(h), (indx1), ap); \
+    va_end(ap); \
+    if (VL_UNLIKELY(!datap)) { _VL_SVDPI_RANGE_WARN(); return rtn; }
+
 //======================================================================
 // Open array querying functions
 
 int svLeft(const svOpenArrayHandle h, int d) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->left(d);
 }
 int svRight(const svOpenArrayHandle h, int d) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->right(d);
 }
 int svLow(const svOpenArrayHandle h, int d) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->low(d);
 }
 int svHigh(const svOpenArrayHandle h, int d) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->high(d);
 }
 int svIncrement(const svOpenArrayHandle h, int d) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->increment(d);
+}
+int svSize(const svOpenArrayHandle h, int d) {
+    return _vl_openhandle(h)->elements(d);
 }
 int svDimensions(const svOpenArrayHandle h) {
-    _VL_SVDPI_UNIMP(); return 0;
+    return _vl_openhandle(h)->udims();
 }
 
-void *svGetArrayPtr(const svOpenArrayHandle) {
-    _VL_SVDPI_UNIMP(); return NULL;
+/// Verilator's own layout; see VerilatedDpiOpenVar
+void *svGetArrayPtr(const svOpenArrayHandle h) {
+    return _vl_openhandle(h)->datap();
 }
 
-int svSizeOfArray(const svOpenArrayHandle) {
-    _VL_SVDPI_UNIMP(); return 0;
+int svSizeOfArray(const svOpenArrayHandle h) {
+    return _vl_openhandle(h)->totalSize();
 }
 
-void *svGetArrElemPtr(const svOpenArrayHandle, int indx1, ...) {
-    _VL_SVDPI_UNIMP(); return NULL;
+void *svGetArrElemPtr(const svOpenArrayHandle h, int indx1, ...) {
+    va_list ap;
+    va_start(ap,indx1);
+    void* datap = _vl_sv_adims_ptrv(_vl_openhandle(h), indx1, ap);
+    va_end(ap);
+    return datap;
 }
-void *svGetArrElemPtr1(const svOpenArrayHandle, int indx1) {
-    _VL_SVDPI_UNIMP(); return NULL;
+void *svGetArrElemPtr1(const svOpenArrayHandle h, int indx1) {
+    int indxs[1] = {indx1};
+    return _vl_sv_adims_ptr(_vl_openhandle(h), 1, indxs);
 }
-void *svGetArrElemPtr2(const svOpenArrayHandle, int indx1, int indx2) {
-    _VL_SVDPI_UNIMP(); return NULL;
+void *svGetArrElemPtr2(const svOpenArrayHandle h, int indx1, int indx2) {
+    int indxs[2] = {indx1, indx2};
+    return _vl_sv_adims_ptr(_vl_openhandle(h), 2, indxs);
 }
-void *svGetArrElemPtr3(const svOpenArrayHandle, int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP(); return NULL;
+void *svGetArrElemPtr3(const svOpenArrayHandle h, int indx1, int indx2, int indx3) {
+    int indxs[3] = {indx1, indx2, indx3};
+    return _vl_sv_adims_ptr(_vl_openhandle(h), 3, indxs);
 }
 
 //======================================================================
@@ -135,35 +300,49 @@ void *svGetArrElemPtr3(const svOpenArrayHandle, int indx1, int indx2, int indx3)
 
 void svPutBitArrElemVecVal(const svOpenArrayHandle d, const svBitVecVal* s,
 			   int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    _VL_SV_ELEM_PTRV(datap, d, indx1, );
+    _vl_sv_put_bitvec(_vl_openhandle(d), datap, s);
 }
 void svPutBitArrElem1VecVal(const svOpenArrayHandle d, const svBitVecVal* s,
 			    int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, d, 1, indxs, );
+    _vl_sv_put_bitvec(_vl_openhandle(d), datap, s);
 }
 void svPutBitArrElem2VecVal(const svOpenArrayHandle d, const svBitVecVal* s,
 			    int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, d, 2, indxs, );
+    _vl_sv_put_bitvec(_vl_openhandle(d), datap, s);
 }
 void svPutBitArrElem3VecVal(const svOpenArrayHandle d, const svBitVecVal* s,
 			    int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, d, 3, indxs, );
+    _vl_sv_put_bitvec(_vl_openhandle(d), datap, s);
 }
 void svPutLogicArrElemVecVal(const svOpenArrayHandle d, const svLogicVecVal* s,
 			     int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    _VL_SV_ELEM_PTRV(datap, d, indx1, );
+    _vl_sv_put_logicvec(_vl_openhandle(d), datap, s);
 }
 void svPutLogicArrElem1VecVal(const svOpenArrayHandle d, const svLogicVecVal* s,
 			      int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, d, 1, indxs, );
+    _vl_sv_put_logicvec(_vl_openhandle(d), datap, s);
 }
 void svPutLogicArrElem2VecVal(const svOpenArrayHandle d, const svLogicVecVal* s,
 			      int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, d, 2, indxs, );
+    _vl_sv_put_logicvec(_vl_openhandle(d), datap, s);
 }
 void svPutLogicArrElem3VecVal(const svOpenArrayHandle d, const svLogicVecVal* s,
 			      int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, d, 3, indxs, );
+    _vl_sv_put_logicvec(_vl_openhandle(d), datap, s);
 }
 
 //======================================================================
@@ -171,84 +350,128 @@ void svPutLogicArrElem3VecVal(const svOpenArrayHandle d, const svLogicVecVal* s,
 
 void svGetBitArrElemVecVal(svBitVecVal* d, const svOpenArrayHandle s,
 			   int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    _VL_SV_ELEM_PTRV(datap, s, indx1, );
+    _vl_sv_get_bitvec(d, _vl_openhandle(s), datap);
 }
 void svGetBitArrElem1VecVal(svBitVecVal* d, const svOpenArrayHandle s,
 			    int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, s, 1, indxs, );
+    _vl_sv_get_bitvec(d, _vl_openhandle(s), datap);
 }
 void svGetBitArrElem2VecVal(svBitVecVal* d, const svOpenArrayHandle s,
 			    int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, s, 2, indxs, );
+    _vl_sv_get_bitvec(d, _vl_openhandle(s), datap);
 }
 void svGetBitArrElem3VecVal(svBitVecVal* d, const svOpenArrayHandle s,
 			    int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, s, 3, indxs, );
+    _vl_sv_get_bitvec(d, _vl_openhandle(s), datap);
 }
 void svGetLogicArrElemVecVal(svLogicVecVal* d, const svOpenArrayHandle s,
 			     int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    _VL_SV_ELEM_PTRV(datap, s, indx1, );
+    _vl_sv_get_logicvec(d, _vl_openhandle(s), datap);
 }
 void svGetLogicArrElem1VecVal(svLogicVecVal* d, const svOpenArrayHandle s,
 			      int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, s, 1, indxs, );
+    _vl_sv_get_logicvec(d, _vl_openhandle(s), datap);
 }
 void svGetLogicArrElem2VecVal(svLogicVecVal* d, const svOpenArrayHandle s,
 			      int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, s, 2, indxs, );
+    _vl_sv_get_logicvec(d, _vl_openhandle(s), datap);
 }
 void svGetLogicArrElem3VecVal(svLogicVecVal* d, const svOpenArrayHandle s,
 			      int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, s, 3, indxs, );
+    _vl_sv_get_logicvec(d, _vl_openhandle(s), datap);
 }
 
 svBit svGetBitArrElem(const svOpenArrayHandle s, int indx1, ...) {
-    _VL_SVDPI_UNIMP(); return 0;
+    _VL_SV_ELEM_PTRV(datap, s, indx1, 0);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svBit svGetBitArrElem1(const svOpenArrayHandle s, int indx1) {
-    _VL_SVDPI_UNIMP(); return 0;
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, s, 1, indxs, 0);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svBit svGetBitArrElem2(const svOpenArrayHandle s, int indx1, int indx2) {
-    _VL_SVDPI_UNIMP(); return 0;
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, s, 2, indxs, 0);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svBit svGetBitArrElem3(const svOpenArrayHandle s, int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP(); return 0;
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, s, 3, indxs, 0);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svLogic svGetLogicArrElem(const svOpenArrayHandle s, int indx1, ...) {
-    _VL_SVDPI_UNIMP(); return sv_x;
+    // Verilator doesn't model X/Z, so logic elements are their bit value
+    _VL_SV_ELEM_PTRV(datap, s, indx1, sv_x);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svLogic svGetLogicArrElem1(const svOpenArrayHandle s, int indx1) {
-    _VL_SVDPI_UNIMP(); return sv_x;
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, s, 1, indxs, sv_x);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svLogic svGetLogicArrElem2(const svOpenArrayHandle s, int indx1, int indx2) {
-    _VL_SVDPI_UNIMP(); return sv_x;
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, s, 2, indxs, sv_x);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 svLogic svGetLogicArrElem3(const svOpenArrayHandle s, int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP(); return sv_x;
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, s, 3, indxs, sv_x);
+    return _vl_sv_get_bit(_vl_openhandle(s), datap);
 }
 void svPutLogicArrElem(const svOpenArrayHandle d, svLogic value, int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    // Verilator doesn't model X/Z, so only the low bit of value is kept
+    _VL_SV_ELEM_PTRV(datap, d, indx1, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutLogicArrElem1(const svOpenArrayHandle d, svLogic value, int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, d, 1, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutLogicArrElem2(const svOpenArrayHandle d, svLogic value, int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, d, 2, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutLogicArrElem3(const svOpenArrayHandle d, svLogic value, int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, d, 3, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutBitArrElem(const svOpenArrayHandle d, svBit value, int indx1, ...) {
-    _VL_SVDPI_UNIMP();
+    _VL_SV_ELEM_PTRV(datap, d, indx1, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutBitArrElem1(const svOpenArrayHandle d, svBit value, int indx1) {
-    _VL_SVDPI_UNIMP();
+    int indxs[1] = {indx1};
+    _VL_SV_ELEM_PTR(datap, d, 1, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutBitArrElem2(const svOpenArrayHandle d, svBit value, int indx1, int indx2) {
-    _VL_SVDPI_UNIMP();
+    int indxs[2] = {indx1, indx2};
+    _VL_SV_ELEM_PTR(datap, d, 2, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 void svPutBitArrElem3(const svOpenArrayHandle d, svBit value, int indx1, int indx2, int indx3) {
-    _VL_SVDPI_UNIMP();
+    int indxs[3] = {indx1, indx2, indx3};
+    _VL_SV_ELEM_PTR(datap, d, 3, indxs, );
+    _vl_sv_put_bit(_vl_openhandle(d), datap, value);
 }
 
 //======================================================================
@@ -59,6 +59,63 @@ static inline void VL_SET_SVLV_W(int obits, svLogicVecVal* owp, WDataInP lwp) {
     owp[words-1].aval = lwp[words-1] & VL_MASK_I(obits);
 }
 
+//===================================================================
+/// Open array, describing an unpacked array where the model stores it.
+///
+/// The svOpenArrayHandle accessors use this to read and write elements in
+/// place, so a C model can scan a large memory without copying it.  Each
+/// element is stored as Verilator stores it: CData, SData, IData, QData,
+/// or a WData array for over 64 bits.  Pass a pointer to it as the handle:
+///
+///	VerilatedDpiOpenVar mem (Verilated::dpiScope()->varFind("mem"));
+///	c_model_scan((svOpenArrayHandle)&mem);
+
+class VerilatedDpiOpenVar {
+    enum { MAX_UDIMS = 3 };	// Unpacked dimensions the svdpi.h accessors can index
+    void*		m_datap;	///< Model storage, not copied
+    VerilatedVarType	m_vltype;	///< Element type
+    int			m_width;	///< Packed bits per element
+    int			m_entSize;	///< Bytes per element
+    int			m_udims;	///< Unpacked dimensions
+    int			m_left[MAX_UDIMS+1];	///< Left of each dimension, [0] is packed
+    int			m_right[MAX_UDIMS+1];	///< Right of each dimension, [0] is packed
+    int			m_stride[MAX_UDIMS+1];	///< Bytes between neighbors in a dimension, [0] is whole array
+    void init(VerilatedVarType vltype, int dims, const int* boundsp);
+public:
+    // CREATORS
+    /// Array of a public variable found with VerilatedScope::varFind
+    VerilatedDpiOpenVar(const VerilatedVar* varp);
+    /// Array of any storage; dims counts ranges given as left,right
+    /// pairs, with the packed range first and then each unpacked dimension
+    VerilatedDpiOpenVar(void* datap, VerilatedVarType vltype, int dims, ...);
+    ~VerilatedDpiOpenVar() {}
+    // ACCESSORS
+    void* datap() const { return m_datap; }
+    VerilatedVarType vltype() const { return m_vltype; }
+    int width() const { return m_width; }
+    int entSize() const { return m_entSize; }
+    int udims() const { return m_udims; }
+    int left(int d) const { return (d>=0 && d<=m_udims) ? m_left[d] : 0; }
+    int right(int d) const { return (d>=0 && d<=m_udims) ? m_right[d] : 0; }
+    int low(int d) const { return left(d) < right(d) ? left(d) : right(d); }
+    int high(int d) const { return left(d) > right(d) ? left(d) : right(d); }
+    int increment(int d) const { return left(d) >= right(d) ? 1 : -1; }
+    int elements(int d) const { return (d>=0 && d<=m_udims) ? (high(d)-low(d)+1) : 0; }
+    /// Bytes of the whole array
+    int totalSize() const { return m_udims ? m_stride[0] : m_entSize; }
+    // METHODS
+    /// Element at the given unpacked indices, or NULL if any is out of range
+    void* elemPtr(const int* indxsp) const {
+	vluint8_t* datap = (vluint8_t*)m_datap;
+	for (int d=1; d<=m_udims; ++d) {
+	    int offset = indxsp[d-1] - low(d);
+	    if (VL_UNLIKELY(offset < 0 || offset >= elements(d))) return NULL;
+	    datap += offset * m_stride[d];
+	}
+	return datap;
+    }
+};
+
 //======================================================================
 
 #endif // _VERILATED_DPI_H_
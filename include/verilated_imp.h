@@ -67,6 +67,8 @@ class VerilatedImp {
 
     // File I/O
     vector<FILE*>	m_fdps;		///< File descriptors
+    vector<pair<string,string> >	m_fdNames;	///< Filename and mode of each m_fdps
+    vector<vlsint64_t>	m_fdOffsets;	///< Offset of each m_fdps when last forked
     deque<IData>	m_fdFree;	///< List of free descriptors (SLOW - FOPEN/CLOSE only)
 
 public: // But only for verilated*.cpp
@@ -76,6 +78,7 @@ public: // But only for verilated*.cpp
 	m_fdps[0] = stdin;
 	m_fdps[1] = stdout;
 	m_fdps[2] = stderr;
+	m_fdNames.resize(3);
     }
     ~VerilatedImp() {}
     static void internalsDump() {
@@ -225,17 +228,19 @@ public: // But only for verilated*.cpp
 
 public: // But only for verilated*.cpp
     // METHODS - file IO
-    static IData fdNew(FILE* fp) {
+    static IData fdNew(FILE* fp, const char* filenamep, const char* modep) {
 	if (VL_UNLIKELY(!fp)) return 0;
 	// Bit 31 indicates it's a descriptor not a MCD
 	if (s_s.m_fdFree.empty()) {
 	    // Need to create more space in m_fdps and m_fdFree
 	    size_t start = s_s.m_fdps.size();
 	    s_s.m_fdps.resize(start*2);
+	    s_s.m_fdNames.resize(start*2);
 	    for (size_t i=start; i<start*2; i++) s_s.m_fdFree.push_back((IData)i);
 	}
 	IData idx = s_s.m_fdFree.back(); s_s.m_fdFree.pop_back();
 	s_s.m_fdps[idx] = fp;
+	s_s.m_fdNames[idx] = make_pair(string(filenamep), string(modep));
 	return (idx | (1UL<<31));  // bit 31 indicates not MCD
     }
     static void fdDelete(IData fdi) {
@@ -243,8 +248,10 @@ public: // But only for verilated*.cpp
 	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= s_s.m_fdps.size())) return;
 	if (VL_UNLIKELY(!s_s.m_fdps[idx])) return;  // Already free
 	s_s.m_fdps[idx] = NULL;
+	s_s.m_fdNames[idx] = make_pair(string(), string());
 	s_s.m_fdFree.push_back(idx);
     }
+    static void fdsFork(int stage);
     static inline FILE* fdToFp(IData fdi) {
 	IData idx = VL_MASK_I(31) & fdi;
 	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= s_s.m_fdps.size())) return NULL;
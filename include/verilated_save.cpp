@@ -27,12 +27,18 @@
 
 #include <fcntl.h>
 #include <cerrno>
+#include <ctime>
 
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
 # include <io.h>
 #else
 # include <unistd.h>
 #endif
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/wait.h>
+#endif
 
 #ifndef O_LARGEFILE // For example on WIN32
 # define O_LARGEFILE 0
@@ -42,8 +48,10 @@
 #endif
 
 // CONSTANTS
-static const char* VLTSAVE_HEADER_STR = "verilatorsave01\n";	///< Value of first bytes of each file
+static const char* VLTSAVE_HEADER_STR = "verilatorsave02\n";	///< Value of first bytes of each file
 static const char* VLTSAVE_TRAILER_STR = "vltsaved";	///< Value of last bytes of each file
+static const char* VLTSAVE_DELTA_STR = "vltdelta";	///< Value of first bytes of each delta chain file
+static const vluint64_t VLTSAVE_DELTA_END = ~VL_ULL(0);	///< Block number ending a delta chain file
 
 //=============================================================================
 //=============================================================================
@@ -81,11 +89,20 @@ void VerilatedSerialize::header() {
 
 void VerilatedDeserialize::header() {
     VerilatedDeserialize& os = *this;  // So can cut and paste standard >> code below
-    if (VL_UNLIKELY(os.readDiffers(VLTSAVE_HEADER_STR, strlen(VLTSAVE_HEADER_STR)))) {
+    size_t len = strlen(VLTSAVE_HEADER_STR);
+    bufferCheck();
+    if (VL_UNLIKELY(memcmp(m_cp, VLTSAVE_HEADER_STR, len))) {
+	// The name ends with a two digit format version
 	string msg = (string)"Can't deserialize; file has wrong header signature";
+	if (0==memcmp(m_cp, VLTSAVE_HEADER_STR, len-3)) {
+	    msg = (string)"Can't deserialize; file has save format version "
+		+string((const char*)m_cp+len-3, 2)
+		+", but this model reads version "+string(VLTSAVE_HEADER_STR+len-3, 2);
+	}
 	vl_fatal(filename().c_str(), 0, "", msg.c_str());
 	close();
     }
+    m_cp += len;
     os.read(Verilated::serializedPtr(), Verilated::serializedSize());
 }
 
@@ -128,6 +145,8 @@ void VerilatedSave::open (const char* filenamep) {
     m_isOpen = true;
     m_filename = filenamep;
     m_cp = m_bufp;
+    m_basep = m_bufp;
+    m_baseOffset = 0;
     header();
 }
 
@@ -151,6 +170,25 @@ void VerilatedRestore::open (const char* filenamep) {
     m_filename = filenamep;
     m_cp = m_bufp;
     m_endp = m_bufp;
+    m_basep = m_bufp;
+    m_baseOffset = 0;
+#ifndef _WIN32
+    // Map the file, so reading is straight from the page cache
+    struct stat st;
+    if (fstat(m_fd, &st) == 0 && st.st_size > 0 && (vluint64_t)st.st_size == (size_t)st.st_size) {
+	void* mapp = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if (mapp != MAP_FAILED) {
+# ifdef MADV_SEQUENTIAL
+	    madvise(mapp, st.st_size, MADV_SEQUENTIAL);
+# endif
+	    m_mapp = (vluint8_t*)mapp;
+	    m_mapSize = st.st_size;
+	    m_cp = m_mapp;
+	    m_endp = m_mapp + m_mapSize;
+	    m_basep = m_mapp;
+	}
+    }
+#endif
     header();
 }
 
@@ -167,6 +205,7 @@ void VerilatedRestore::close () {
     trailer();
     flush();
     m_isOpen = false;
+    unmap();
     ::close(m_fd);  // May get error, just ignore it
 }
 
@@ -175,9 +214,24 @@ void VerilatedRestore::close () {
 
 void VerilatedSave::flush() {
     if (VL_UNLIKELY(!isOpen())) return;
-    vluint8_t* wp = m_bufp;
+    vluint8_t* cp = m_cp;
+    bufferReset();
+    m_cp = m_bufp; // Reset buffer
+    writeFd(m_bufp, cp - m_bufp);
+}
+
+void VerilatedSave::writeBulk (const void* datap, size_t size) {
+    // Large regions go straight to the file, rather than through the buffer
+    flush();
+    if (VL_UNLIKELY(!isOpen())) return;
+    m_baseOffset += size;
+    writeFd((const vluint8_t*)datap, size);
+}
+
+bool VerilatedSave::writeFd (const vluint8_t* datap, size_t len) {
+    const vluint8_t* wp = datap;
     while (1) {
-	ssize_t remaining = (m_cp - wp);
+	ssize_t remaining = (datap + len - wp);
 	if (remaining==0) break;
 	errno = 0;
 	ssize_t got = ::write (m_fd, wp, remaining);
@@ -189,20 +243,26 @@ void VerilatedSave::flush() {
 		string msg = string(__FUNCTION__)+": "+strerror(errno);
 		vl_fatal("",0,"",msg.c_str());
 		close();
-		break;
+		return false;
 	    }
 	}
     }
-    m_cp = m_bufp; // Reset buffer
+    return true;
 }
 
 void VerilatedRestore::fill() {
     if (VL_UNLIKELY(!isOpen())) return;
     // Move remaining characters down to start of buffer.  (No memcpy, overlaps allowed)
+    bufferReset();
     vluint8_t* rp = m_bufp;
-    for (vluint8_t* sp=m_cp; rp < m_endp;) *rp++ = *sp++;  // Overlaps
-    m_endp = m_bufp + (m_endp - m_cp);
+    for (vluint8_t* sp=m_cp; sp < m_endp;) *rp++ = *sp++;  // Overlaps
+    m_endp = rp;
     m_cp = m_bufp; // Reset buffer
+    if (m_mapp) {
+	// Reached the end of the mapping; the tail is now in the buffer
+	unmap();
+	lseek(m_fd, 0, SEEK_END);
+    }
     // Read into buffer starting at m_endp 
     while (1) {
 	ssize_t remaining = (m_bufp+bufferSize() - m_endp);
@@ -227,6 +287,432 @@ void VerilatedRestore::fill() {
     }
 }
 
+void VerilatedRestore::readBulk (void* datap, size_t size) {
+    // Copy what's buffered or mapped, then read the rest straight from the file
+    vluint8_t* dp = (vluint8_t*)datap;
+    size_t have = m_endp - m_cp;
+    if (have > size) have = size;
+    memcpy(dp, m_cp, have);
+    m_cp += have;  dp += have;  size -= have;
+    if (!size) return;
+    if (m_mapp) {  // File is truncated; let fill() handle the end
+	fill();
+	read(dp, size);
+	return;
+    }
+    bufferReset();
+    m_cp = m_bufp;
+    m_endp = m_bufp;
+    m_baseOffset += size;
+    if (!readFd(dp, size)) {
+	memset(dp, 0, size);  // Reader will find a bad trailer
+    }
+}
+
+bool VerilatedRestore::readFd (vluint8_t* datap, size_t len) {
+    while (len) {
+	errno = 0;
+	ssize_t got = ::read (m_fd, datap, len);
+	if (got>0) {
+	    datap += got;  len -= got;
+	} else if (got==0) {  // EOF
+	    return false;
+	} else if (errno != EAGAIN && errno != EINTR) {
+	    string msg = string(__FUNCTION__)+": "+strerror(errno);
+	    vl_fatal("",0,"",msg.c_str());
+	    close();
+	    return false;
+	}
+    }
+    return true;
+}
+
+void VerilatedRestore::unmap() {
+#ifndef _WIN32
+    if (m_mapp) munmap(m_mapp, m_mapSize);
+#endif
+    m_mapp = NULL;
+    m_mapSize = 0;
+}
+
+//=============================================================================
+// Delta chains
+//
+// VerilatedSaveDelta splits the serialized image into fixed size blocks
+// and keeps a hash of each.  Each file holds only the blocks whose hash
+// differs from the previous file's image, so the first file is the whole
+// image.  A file is a 32 byte header: VLTSAVE_DELTA_STR, u64 chain, u64
+// sequence number and u64 block size; then records of u64 block number,
+// u64 length and the block data; then u64 VLTSAVE_DELTA_END, u64 blocks in
+// the image, and VLTSAVE_TRAILER_STR.  VerilatedRestoreDelta finds the
+// newest copy of each block, then reads the image in block order, so
+// restoring reads the same stream as VerilatedRestore would.
+
+static vluint64_t vltsaveHash (const vluint8_t* datap, size_t len) {
+    const vluint64_t prime = VL_ULL(0x100000001b3);
+    vluint64_t hash = VL_ULL(0xcbf29ce484222325) ^ len;
+    size_t i = 0;
+    for (; i+8 <= len; i+=8) {
+	vluint64_t word;  memcpy(&word, datap+i, 8);
+	hash = (hash ^ word) * prime;
+	hash ^= hash >> 29;
+    }
+    for (; i<len; ++i) hash = (hash ^ datap[i]) * prime;
+    return hash;
+}
+
+VerilatedSaveDelta::VerilatedSaveDelta() {
+    m_fd = -1;
+    m_fileBufp = new vluint8_t [bufferSize()];
+    m_filep = m_fileBufp;
+    m_chain = 0;
+    m_seq = 0;
+    m_block = 0;
+    m_dirtyBlocks = 0;
+}
+
+VerilatedSaveDelta::~VerilatedSaveDelta() {
+    close();
+    if (m_fileBufp) { delete[] m_fileBufp; m_fileBufp=NULL; }
+}
+
+void VerilatedSaveDelta::open (const char* filenamep) {
+    if (isOpen()) return;
+    VL_DEBUG_IF(VL_PRINTF("-vltSave: opening delta save file %s\n",filenamep););
+
+    // cppcheck-suppress duplicateExpression
+    m_fd = ::open (filenamep, O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_NONBLOCK
+		   , 0666);
+    if (m_fd<0) {
+	// User code can check isOpen()
+	m_isOpen = false;
+	return;
+    }
+    m_isOpen = true;
+    m_filename = filenamep;
+    if (m_hashes.empty()) {  // Start a chain
+	m_chain = vltsaveHash((const vluint8_t*)filenamep, strlen(filenamep))
+	    ^ ((vluint64_t)time(NULL) << 20) ^ (vluint64_t)clock();
+	m_seq = 0;
+    } else {
+	++m_seq;
+    }
+    m_block = 0;
+    m_dirtyBlocks = 0;
+    m_filep = m_fileBufp;
+    m_basep = m_bufp;
+    m_baseOffset = 0;
+    writeFile(VLTSAVE_DELTA_STR, strlen(VLTSAVE_DELTA_STR));
+    vluint64_t blockBytes = blockSize();
+    writeFile(&m_chain, sizeof(m_chain));
+    writeFile(&m_seq, sizeof(m_seq));
+    writeFile(&blockBytes, sizeof(blockBytes));
+    m_cp = m_bufp;
+    header();
+}
+
+void VerilatedSaveDelta::close () {
+    if (!isOpen()) return;
+    trailer();
+    flush();
+    size_t len = m_cp - m_bufp;  // Partial last block
+    if (len) writeBlock(m_bufp, len);
+    m_cp = m_bufp;
+    m_hashes.resize(m_block);
+    vluint64_t endMark = VLTSAVE_DELTA_END;
+    writeFile(&endMark, sizeof(endMark));
+    writeFile(&m_block, sizeof(m_block));
+    writeFile(VLTSAVE_TRAILER_STR, strlen(VLTSAVE_TRAILER_STR));
+    flushFile();
+    if (!isOpen()) return;  // Write error
+    m_isOpen = false;
+    ::close(m_fd);  // May get error, just ignore it
+}
+
+void VerilatedSaveDelta::flush() {
+    // Write whole blocks, keeping any partial block for the next call
+    if (VL_UNLIKELY(!isOpen())) return;
+    vluint8_t* rp = m_bufp;
+    for (; rp + blockSize() <= m_cp; rp += blockSize()) {
+	writeBlock(rp, blockSize());
+    }
+    m_baseOffset += rp - m_bufp;
+    vluint8_t* wp = m_bufp;
+    while (rp < m_cp) *wp++ = *rp++;
+    m_cp = wp;
+}
+
+void VerilatedSaveDelta::writeBlock (const vluint8_t* datap, size_t len) {
+    vluint64_t hash = vltsaveHash(datap, len);
+    if (m_block >= m_hashes.size()) m_hashes.resize(m_block+1, ~hash);
+    if (m_hashes[m_block] != hash) {
+	m_hashes[m_block] = hash;
+	vluint64_t len64 = len;
+	writeFile(&m_block, sizeof(m_block));
+	writeFile(&len64, sizeof(len64));
+	writeFile(datap, len);
+	++m_dirtyBlocks;
+    }
+    ++m_block;
+}
+
+void VerilatedSaveDelta::writeFile (const void* datap, size_t len) {
+    const vluint8_t* dp = (const vluint8_t*)datap;
+    while (len) {
+	size_t blk = min(len, (size_t)(m_fileBufp + bufferSize() - m_filep));
+	memcpy(m_filep, dp, blk);
+	m_filep += blk;  dp += blk;  len -= blk;
+	if (m_filep == m_fileBufp + bufferSize()) flushFile();
+    }
+}
+
+void VerilatedSaveDelta::flushFile() {
+    if (VL_UNLIKELY(!isOpen())) { m_filep = m_fileBufp; return; }
+    vluint8_t* wp = m_fileBufp;
+    while (1) {
+	ssize_t remaining = (m_filep - wp);
+	if (remaining==0) break;
+	errno = 0;
+	ssize_t got = ::write (m_fd, wp, remaining);
+	if (got>0) {
+	    wp += got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// write failed, presume error (perhaps out of disk space)
+		string msg = string(__FUNCTION__)+": "+strerror(errno);
+		vl_fatal("",0,"",msg.c_str());
+		m_isOpen = false;
+		::close(m_fd);
+		m_hashes.clear();  // Chain is broken, next file must be a base
+		break;
+	    }
+	}
+    }
+    m_filep = m_fileBufp; // Reset buffer
+}
+
+bool VerilatedRestoreDelta::readFile (int fd, void* datap, size_t len) {
+    vluint8_t* dp = (vluint8_t*)datap;
+    while (len) {
+	errno = 0;
+	ssize_t got = ::read (fd, dp, len);
+	if (got>0) {
+	    dp += got;  len -= got;
+	} else if (got==0 || (errno != EAGAIN && errno != EINTR)) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+void VerilatedRestoreDelta::openFail (const string& filename, const string& why) {
+    string msg = "Can't deserialize; "+why;
+    vl_fatal(filename.c_str(), 0, "", msg.c_str());
+    m_isOpen = true;  // So close() releases the files
+    close();
+}
+
+void VerilatedRestoreDelta::open (const vector<string>& filenames) {
+    if (isOpen()) return;
+    m_blocks.clear();
+    m_block = 0;
+    vluint64_t chain = 0;
+    for (size_t file=0; file<filenames.size(); ++file) {
+	const string& filename = filenames[file];
+	VL_DEBUG_IF(VL_PRINTF("-vltRestore: opening delta restore file %s\n",filename.c_str()););
+	// cppcheck-suppress duplicateExpression
+	int fd = ::open (filename.c_str(), O_RDONLY|O_LARGEFILE);
+	if (fd<0) {
+	    // User code can check isOpen()
+	    m_isOpen = true;
+	    close();
+	    return;
+	}
+	m_fds.push_back(fd);
+	char magic[8];
+	vluint64_t hdr[3];  // Chain, sequence, block size
+	if (!readFile(fd, magic, sizeof(magic)) || !readFile(fd, hdr, sizeof(hdr))
+	    || memcmp(magic, VLTSAVE_DELTA_STR, sizeof(magic))) {
+	    openFail(filename, "file has wrong delta header signature");
+	    return;
+	}
+	if (file==0) chain = hdr[0];
+	if (hdr[0] != chain || hdr[1] != file) {
+	    openFail(filename, "file isn't the next delta after "+filenames[file ? file-1 : 0]);
+	    return;
+	}
+	if (hdr[2] != VerilatedSaveDelta::blockSize()) {
+	    openFail(filename, "file has different block size");
+	    return;
+	}
+	// Record where the newest copy of each block is
+	vluint64_t offset = sizeof(magic) + sizeof(hdr);
+	while (1) {
+	    vluint64_t rec[2];  // Block number and length, or end mark and blocks
+	    if (!readFile(fd, rec, sizeof(rec))) {
+		openFail(filename, "delta file is truncated");
+		return;
+	    }
+	    offset += sizeof(rec);
+	    if (rec[0] == VLTSAVE_DELTA_END) {
+		m_blocks.resize(rec[1]);
+		break;
+	    }
+	    if (rec[0] >= m_blocks.size()) m_blocks.resize(rec[0]+1);
+	    BlockLoc& loc = m_blocks[rec[0]];
+	    loc.m_file = (int)file;
+	    loc.m_offset = offset;
+	    loc.m_len = rec[1];
+	    offset += rec[1];
+	    if (rec[1] > VerilatedSaveDelta::blockSize()
+		|| lseek(fd, offset, SEEK_SET) != (off_t)offset) {
+		openFail(filename, "delta file is corrupt");
+		return;
+	    }
+	}
+	char trailer[8];
+	if (!readFile(fd, trailer, sizeof(trailer))
+	    || memcmp(trailer, VLTSAVE_TRAILER_STR, sizeof(trailer))) {
+	    openFail(filename, "file has wrong end-of-file signature");
+	    return;
+	}
+    }
+    for (vector<BlockLoc>::const_iterator it=m_blocks.begin(); it!=m_blocks.end(); ++it) {
+	if (!it->m_len) {
+	    openFail(filenames.empty() ? "" : filenames[0], "delta chain doesn't start with a base image");
+	    return;
+	}
+    }
+    m_isOpen = true;
+    m_filename = filenames.empty() ? "" : filenames.back();
+    m_cp = m_bufp;
+    m_endp = m_bufp;
+    m_basep = m_bufp;
+    m_baseOffset = 0;
+    header();
+}
+
+void VerilatedRestoreDelta::close () {
+    if (!isOpen()) return;
+    if (m_block) trailer();  // Else failed opening
+    m_isOpen = false;
+    for (vector<int>::iterator it=m_fds.begin(); it!=m_fds.end(); ++it) {
+	::close(*it);  // May get error, just ignore it
+    }
+    m_fds.clear();
+}
+
+void VerilatedRestoreDelta::fill() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    // Move remaining characters down to start of buffer.  (No memcpy, overlaps allowed)
+    bufferReset();
+    vluint8_t* rp = m_bufp;
+    for (vluint8_t* sp=m_cp; sp < m_endp;) *rp++ = *sp++;  // Overlaps
+    m_endp = rp;
+    m_cp = m_bufp; // Reset buffer
+    // Read blocks into buffer starting at m_endp
+    for (; m_block < m_blocks.size(); ++m_block) {
+	const BlockLoc& loc = m_blocks[m_block];
+	if (m_endp + loc.m_len > m_bufp + bufferSize()) return;
+	int fd = m_fds[loc.m_file];
+	if (lseek(fd, loc.m_offset, SEEK_SET) != (off_t)loc.m_offset
+	    || !readFile(fd, m_endp, loc.m_len)) {
+	    string msg = string(__FUNCTION__)+": "+strerror(errno);
+	    vl_fatal("",0,"",msg.c_str());
+	    close();
+	    return;
+	}
+	m_endp += loc.m_len;
+    }
+    // Fill buffer from here to end with NULLs so reader's don't need to check eof each character.
+    while (m_endp < m_bufp+bufferSize()) *m_endp++ = '\0';
+}
+
+//=============================================================================
+// Snapshots
+//
+// snapshot() forks; the child continues while the parent holds the
+// snapshot, waiting.  rewind() writes to a pipe before exiting, so the
+// parent knows to fork again from its unchanged state rather than exit.
+
+int VerilatedSnapshot::s_rewindFd = -1;
+
+#ifndef _WIN32
+int VerilatedSnapshot::snapshot() {
+    Verilated::forkCall(Verilated::FORK_PREP);
+    for (int rewinds=0; 1; ++rewinds) {
+	int fds[2];
+	if (pipe(fds)) {
+	    string msg = string(__FUNCTION__)+": "+strerror(errno);
+	    vl_fatal("",0,"",msg.c_str());
+	    return rewinds;
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+	    string msg = string(__FUNCTION__)+": "+strerror(errno);
+	    vl_fatal("",0,"",msg.c_str());
+	    return rewinds;
+	}
+	if (pid == 0) {  // Child, continues the simulation
+	    ::close(fds[0]);
+	    s_rewindFd = fds[1];
+	    Verilated::forkCall(rewinds ? Verilated::FORK_REWIND : Verilated::FORK_RESUME);
+	    return rewinds;
+	}
+	::close(fds[1]);
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+	char request = 0;
+	bool rewound = (::read(fds[0], &request, 1) == 1 && request == 'R');
+	::close(fds[0]);
+	if (!rewound) {
+	    // The simulation is over; exit without flushing files the child wrote
+	    _exit(WIFEXITED(status) ? WEXITSTATUS(status) : 128+WTERMSIG(status));
+	}
+    }
+}
+
+void VerilatedSnapshot::rewind() {
+    if (VL_UNLIKELY(s_rewindFd < 0)) {
+	vl_fatal("",0,"","VerilatedSnapshot::rewind called without a snapshot");
+	return;
+    }
+    fflush(stdout);  // Keep what this attempt printed
+    fflush(stderr);
+    char request = 'R';
+    if (::write(s_rewindFd, &request, 1) != 1) {}
+    _exit(0);  // Files and traces are rewound by the next child
+}
+
+int VerilatedSnapshot::forkChild() {
+    Verilated::forkCall(Verilated::FORK_PREP);
+    pid_t pid = fork();
+    if (pid == 0) {
+	if (s_rewindFd >= 0) { ::close(s_rewindFd); s_rewindFd = -1; }  // Rewinding is the parent's
+	Verilated::forkCall(Verilated::FORK_CHILD);
+	return 0;
+    }
+    Verilated::forkCall(Verilated::FORK_RESUME);
+    return (int)pid;
+}
+
+int VerilatedSnapshot::waitChild(int pid) {
+    int status = 0;
+    while (waitpid((pid_t)pid, &status, 0) < 0) {
+	if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+#else
+int VerilatedSnapshot::snapshot() {
+    vl_fatal("",0,"","VerilatedSnapshot requires fork(), which this host doesn't have");
+    return 0;
+}
+void VerilatedSnapshot::rewind() { snapshot(); }
+int VerilatedSnapshot::forkChild() { return snapshot() - 1; }
+int VerilatedSnapshot::waitChild(int) { return -1; }
+#endif
+
 //=============================================================================
 // Serialization of types
 
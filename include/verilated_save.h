@@ -26,7 +26,9 @@
 
 #include "verilatedos.h"
 
+#include <cstring>
 #include <string>
+#include <vector>
 using namespace std;
 
 //=============================================================================
@@ -38,23 +40,36 @@ protected:
     // For speed, keep m_cp as the first member of this structure
     vluint8_t*		m_cp;		///< Current pointer into m_bufp buffer
     vluint8_t*		m_bufp;		///< Output buffer
+    vluint8_t*		m_basep;	///< Pointer to the byte at m_baseOffset
+    vluint64_t		m_baseOffset;	///< Offset in the stream of m_basep
     bool 		m_isOpen;	///< True indicates open file/stream
     string		m_filename;
 
     inline static size_t bufferSize() { return 256*1024; }  // See below for slack calculation
     inline static size_t bufferInsertSize() { return 16*1024; }
+    inline static size_t alignSize() { return 4096; }  // Page size, for mmap
+    inline static size_t alignMinSize() { return 64*1024; }  // Smallest aligned region
 
     // CREATORS
     VerilatedSerialBase() {
 	m_isOpen = false;
 	m_bufp = new vluint8_t [bufferSize()];
 	m_cp = m_bufp;
+	m_basep = m_bufp;
+	m_baseOffset = 0;
+    }
+    // METHODS
+    vluint64_t streamOffset() const { return m_baseOffset + (m_cp - m_basep); }
+    size_t alignPad() const { return (alignSize() - streamOffset() % alignSize()) % alignSize(); }
+    void bufferReset() {  // Data before m_cp was written/read; m_cp will move to m_bufp
+	m_baseOffset = streamOffset();
+	m_basep = m_bufp;
     }
 public:
     // CREATORS
     virtual ~VerilatedSerialBase() {
 	close();
-	if (m_bufp) { delete m_bufp; m_bufp=NULL; }
+	if (m_bufp) { delete[] m_bufp; m_bufp=NULL; }
     }
     // METHODS
     bool isOpen() const { return m_isOpen; }
@@ -72,6 +87,7 @@ protected:
     virtual void flush() {}
     void header();
     void trailer();
+    virtual void writeBulk(const void* datap, size_t size) { write(datap, size); }
 public:
     // CREATORS
     VerilatedSerialize() {}
@@ -96,6 +112,16 @@ public:
 	}
 	return *this;  // For function chaining
     }
+    /// Write a large region, such as a memory, page aligned in the stream
+    /// so a restore may copy it straight from the file
+    inline VerilatedSerialize& writeAligned (const void* __restrict datap, size_t size) {
+	if (size < alignMinSize()) return write(datap, size);
+	bufferCheck();
+	size_t pad = alignPad();
+	memset(m_cp, 0, pad);  m_cp += pad;
+	writeBulk(datap, size);
+	return *this;  // For function chaining
+    }
 };
 
 //=============================================================================
@@ -105,6 +131,7 @@ class VerilatedDeserialize : public VerilatedSerialBase {
 protected:
     vluint8_t*		m_endp;		///< Last valid byte in m_bufp buffer
     virtual void fill() = 0;
+    virtual void readBulk(void* datap, size_t size) { read(datap, size); }
     void header();
     void trailer();
 public:
@@ -123,6 +150,14 @@ public:
 	}
 	return *this;  // For function chaining
     }
+    /// Read a region written by VerilatedSerialize::writeAligned
+    inline VerilatedDeserialize& readAligned (void* __restrict datap, size_t size) {
+	if (size < alignMinSize()) return read(datap, size);
+	bufferCheck();
+	m_cp += alignPad();
+	readBulk(datap, size);
+	return *this;  // For function chaining
+    }
     // Read a datum and compare with expected value
     bool readDiffers (const void* __restrict datap, size_t size);
     VerilatedDeserialize& readAssert (const void* __restrict datap, size_t size);
@@ -144,6 +179,9 @@ class VerilatedSave : public VerilatedSerialize {
 private:
     int			m_fd;		///< File descriptor we're writing to
 
+    bool writeFd(const vluint8_t* datap, size_t len);
+protected:
+    virtual void writeBulk(const void* datap, size_t size);
 public:
     // CREATORS
     VerilatedSave() { m_fd=-1; }
@@ -161,10 +199,16 @@ public:
 class VerilatedRestore : public VerilatedDeserialize {
 private:
     int			m_fd;		///< File descriptor we're writing to
+    vluint8_t*		m_mapp;		///< File mapped into memory, or NULL if reading
+    size_t		m_mapSize;	///< Bytes in m_mapp
 
+    bool readFd(vluint8_t* datap, size_t len);
+    void unmap();
+protected:
+    virtual void readBulk(void* datap, size_t size);
 public:
     // CREATORS
-    VerilatedRestore() { m_fd=-1; }
+    VerilatedRestore() { m_fd=-1; m_mapp=NULL; m_mapSize=0; }
     virtual ~VerilatedRestore() { close(); }
 
     // METHODS
@@ -175,6 +219,104 @@ public:
     virtual void fill();
 };
 
+//=============================================================================
+// VerilatedSaveDelta - serialize to a chain of files, each after the first
+// holding only the blocks that changed since the previous file
+
+class VerilatedSaveDelta : public VerilatedSerialize {
+private:
+    int			m_fd;		///< File descriptor we're writing to
+    vluint8_t*		m_fileBufp;	///< Records waiting to be written to m_fd
+    vluint8_t*		m_filep;	///< Write pointer into m_fileBufp
+    vector<vluint64_t>	m_hashes;	///< Hash of each block of the previous image
+    vluint64_t		m_chain;	///< Identifies the base image, to check deltas
+    vluint64_t		m_seq;		///< Files written since the base image
+    vluint64_t		m_block;	///< Next block number of this image
+    vluint64_t		m_dirtyBlocks;	///< Blocks written to this file
+
+    void writeBlock(const vluint8_t* datap, size_t len);
+    void writeFile(const void* datap, size_t len);
+    void flushFile();
+public:
+    // CREATORS
+    VerilatedSaveDelta();
+    virtual ~VerilatedSaveDelta();
+    // METHODS
+    /// Open the file; call isOpen() to see if errors.  The first file is a
+    /// base image, later files are deltas from the file before.
+    void open(const char* filenamep);
+    void open(const string& filename) { open(filename.c_str()); }
+    virtual void close();
+    virtual void flush();
+    /// Make the next file opened a base image, starting a new chain
+    void rebase() { m_hashes.clear(); }
+    /// After close, number of blocks written to the file
+    vluint64_t dirtyBlocks() const { return m_dirtyBlocks; }
+    /// After close, number of blocks in the image
+    vluint64_t totalBlocks() const { return m_hashes.size(); }
+    static size_t blockSize() { return 4096; }
+};
+
+//=============================================================================
+// VerilatedSnapshot - save and resume the whole process with fork()
+///
+/// Rather than serializing, the operating system copies the process's pages
+/// as they are written.  Verilated::forkCall flushes and recovers $fopen
+/// files, traces and thread pools around each fork.  POSIX hosts only.
+
+class VerilatedSnapshot {
+private:
+    static int		s_rewindFd;	///< Pipe to the process holding the last snapshot
+public:
+    /// Snapshot the process.  The caller then waits, holding the snapshot,
+    /// and snapshot() returns in a child process that continues the
+    /// simulation; when it exits, the caller exits with its status.  Each
+    /// time the child calls rewind(), snapshot() returns again, in a new
+    /// child, with the count of rewinds.
+    static int snapshot();
+    /// Discard the simulation since the last snapshot(), resuming from it
+    static void rewind();
+    /// Fork a child process that continues from the current state, e.g.
+    /// to run many tests after one reset.  Returns 0 in the child, and the
+    /// child's process ID, or -1 if it failed, in the caller.  The child's
+    /// traces and written $fopen files are reopened as separate files,
+    /// named with the child's process ID before the extension, holding
+    /// what the files held at the fork.
+    static int forkChild();
+    /// Wait for a forkChild child to exit, returning its exit status, or
+    /// -1 if it didn't exit normally
+    static int waitChild(int pid);
+};
+
+//=============================================================================
+// VerilatedRestoreDelta - deserialize from a base image and its deltas
+
+class VerilatedRestoreDelta : public VerilatedDeserialize {
+private:
+    struct BlockLoc {
+	int		m_file;		///< Index into m_fds
+	vluint64_t	m_offset;	///< File offset of the block's data
+	vluint64_t	m_len;		///< Bytes in the block
+    };
+    vector<int>		m_fds;		///< File descriptors, base image first
+    vector<BlockLoc>	m_blocks;	///< Newest copy of each block of the image
+    vluint64_t		m_block;	///< Next block to read into the buffer
+
+    bool readFile(int fd, void* datap, size_t len);
+    void openFail(const string& filename, const string& why);
+public:
+    // CREATORS
+    VerilatedRestoreDelta() { m_block=0; }
+    virtual ~VerilatedRestoreDelta() { close(); }
+    // METHODS
+    /// Open the base image, then each delta in the order written; call
+    /// isOpen() to see if errors
+    void open(const vector<string>& filenames);
+    virtual void close();
+    virtual void flush() {}
+    virtual void fill();
+};
+
 //=============================================================================
 
 inline VerilatedSerialize&   operator<<(VerilatedSerialize& os,   vluint64_t& rhs) {
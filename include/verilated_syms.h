@@ -31,6 +31,8 @@
 #include "verilated_heavy.h"
 
 #include <map>
+#include <vector>
+#include <algorithm>
 
 //======================================================================
 // Types
@@ -93,10 +95,34 @@ public:
 //======================================================================
 /// Types
 
-class VerilatedVarNameMap : public map<const char*, VerilatedVar, VerilatedCStrCmp> {
+class VerilatedVarNameMap : public vector<pair<const char*, VerilatedVar> > {
+    // Kept sorted by name.  Verilator emits each scope's variables already
+    // in order, so building this is a copy, and a lookup is a binary search.
+    // Insertion may move entries, so all inserts must precede any lookups.
+    struct NameCmp {
+	bool operator() (const value_type& a, const char* b) const {
+	    return std::strcmp(a.first, b) < 0;
+	}
+    };
 public:
     VerilatedVarNameMap() {}
     ~VerilatedVarNameMap() {}
+    iterator find(const char* namep) {
+	iterator it = lower_bound(begin(), end(), namep, NameCmp());
+	if (it != end() && 0==std::strcmp(it->first, namep)) return it;
+	return end();
+    }
+    void insert(const value_type& val) {
+	// Like map::insert, keeps the first of duplicate names
+	if (empty() || std::strcmp(back().first, val.first) < 0) {
+	    push_back(val);  // Fast path, already sorted
+	} else {
+	    iterator it = lower_bound(begin(), end(), val.first, NameCmp());
+	    if (it == end() || 0!=std::strcmp(it->first, val.first)) {
+		vector<value_type>::insert(it, val);
+	    }
+	}
+    }
 };
 
 #endif // Guard
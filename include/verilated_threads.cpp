@@ -0,0 +1,182 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2013 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Thread pool for multithreaded evaluation (--threads)
+///
+/// AUTHOR:  Wilson Snyder
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_threads.h"
+
+#include <algorithm>
+
+//=============================================================================
+// VerilatedThreadPool
+
+vector<VerilatedThreadPool*> VerilatedThreadPool::s_pools;
+pthread_mutex_t VerilatedThreadPool::s_poolsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+VerilatedThreadPool::VerilatedThreadPool(int threads) {
+    m_readyTasks = 0;
+    m_nextTask = 0;
+    m_busyTasks = 0;
+    m_exiting = false;
+    m_forked = false;
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_startCond, NULL);
+    pthread_cond_init(&m_doneCond, NULL);
+    startWorkers(threads);
+    pthread_mutex_lock(&s_poolsMutex);
+    static bool registered = false;
+    if (!registered) {
+	registered = true;
+	pthread_atfork(&forkPrepare, &forkParent, &forkChild);
+    }
+    s_pools.push_back(this);
+    pthread_mutex_unlock(&s_poolsMutex);
+}
+
+VerilatedThreadPool::~VerilatedThreadPool() {
+    pthread_mutex_lock(&s_poolsMutex);
+    s_pools.erase(find(s_pools.begin(), s_pools.end(), this));
+    pthread_mutex_unlock(&s_poolsMutex);
+    pthread_mutex_lock(&m_mutex);
+    m_exiting = true;
+    pthread_cond_broadcast(&m_startCond);
+    pthread_mutex_unlock(&m_mutex);
+    if (!m_forked) {  // Else the workers only exist in the parent
+	for (vector<pthread_t>::iterator it=m_threads.begin(); it!=m_threads.end(); ++it) {
+	    pthread_join(*it, NULL);
+	}
+    }
+    pthread_cond_destroy(&m_doneCond);
+    pthread_cond_destroy(&m_startCond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void VerilatedThreadPool::startWorkers(int threads) {
+    for (int i=1; i<threads; ++i) {
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, &workerMain, this)) {
+	    vl_fatal(__FILE__,__LINE__,"","Can't create --threads worker thread");
+	}
+	m_threads.push_back(thread);
+    }
+}
+
+// A forked child has only the forking thread, so with VerilatedSnapshot
+// or any other fork each pool's workers are restarted in the child.
+// Holding every pool's mutex across the fork means no worker is part way
+// through changing a pool's state.  Creating threads isn't safe within
+// an atfork handler, so the child handler only marks the pools, and
+// each restarts its workers when next executed.
+
+void VerilatedThreadPool::forkPrepare() {
+    pthread_mutex_lock(&s_poolsMutex);
+    for (vector<VerilatedThreadPool*>::iterator it=s_pools.begin(); it!=s_pools.end(); ++it) {
+	pthread_mutex_lock(&(*it)->m_mutex);
+    }
+}
+
+void VerilatedThreadPool::forkParent() {
+    for (vector<VerilatedThreadPool*>::iterator it=s_pools.begin(); it!=s_pools.end(); ++it) {
+	pthread_mutex_unlock(&(*it)->m_mutex);
+    }
+    pthread_mutex_unlock(&s_poolsMutex);
+}
+
+void VerilatedThreadPool::forkChild() {
+    // The forking thread locked the mutexes in forkPrepare, so may unlock them
+    for (vector<VerilatedThreadPool*>::iterator it=s_pools.begin(); it!=s_pools.end(); ++it) {
+	(*it)->m_forked = true;
+	pthread_mutex_unlock(&(*it)->m_mutex);
+    }
+    pthread_mutex_unlock(&s_poolsMutex);
+}
+
+void VerilatedThreadPool::restartWorkers() {
+    // First use in a forked child.  The conditions may still count the
+    // parent's waiting workers, so are made afresh.
+    m_forked = false;
+    int threads = this->threads();
+    pthread_cond_init(&m_startCond, NULL);
+    pthread_cond_init(&m_doneCond, NULL);
+    m_threads.clear();
+    startWorkers(threads);
+}
+
+void* VerilatedThreadPool::workerMain(void* poolp) {
+    static_cast<VerilatedThreadPool*>(poolp)->worker();
+    return NULL;
+}
+
+void VerilatedThreadPool::worker() {
+    pthread_mutex_lock(&m_mutex);
+    while (1) {
+	if (m_nextTask < m_readyTasks) {
+	    Task task = m_tasks[m_nextTask++];
+	    ++m_busyTasks;
+	    pthread_mutex_unlock(&m_mutex);
+	    task.m_funcp(task.m_datap);
+	    pthread_mutex_lock(&m_mutex);
+	    if (--m_busyTasks == 0 && m_nextTask >= m_readyTasks) {
+		pthread_cond_signal(&m_doneCond);
+	    }
+	} else if (m_exiting) {
+	    break;
+	} else {
+	    pthread_cond_wait(&m_startCond, &m_mutex);
+	}
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void VerilatedThreadPool::execute() {
+    if (VL_UNLIKELY(m_forked)) restartWorkers();
+    if (m_tasks.size() <= 1 || m_threads.empty()) {
+	// Not worth waking the workers
+	for (vector<Task>::iterator it=m_tasks.begin(); it!=m_tasks.end(); ++it) {
+	    it->m_funcp(it->m_datap);
+	}
+	m_tasks.clear();
+	return;
+    }
+    pthread_mutex_lock(&m_mutex);
+    m_readyTasks = m_tasks.size();
+    m_nextTask = 0;
+    pthread_cond_broadcast(&m_startCond);
+    // This thread works too, rather than idling until the workers finish
+    while (m_nextTask < m_readyTasks) {
+	Task task = m_tasks[m_nextTask++];
+	++m_busyTasks;
+	pthread_mutex_unlock(&m_mutex);
+	task.m_funcp(task.m_datap);
+	pthread_mutex_lock(&m_mutex);
+	--m_busyTasks;
+    }
+    while (m_busyTasks) {
+	pthread_cond_wait(&m_doneCond, &m_mutex);
+    }
+    // Workers only look at m_tasks below m_readyTasks, so may now be reused
+    m_readyTasks = 0;
+    m_nextTask = 0;
+    pthread_mutex_unlock(&m_mutex);
+    m_tasks.clear();
+}
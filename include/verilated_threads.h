@@ -0,0 +1,92 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2013 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Thread pool for multithreaded evaluation (--threads)
+///
+/// Verilator with --threads partitions the model into macro-tasks which
+/// share no variables, so may run concurrently without locking.  The
+/// generated eval code queues each group of macro-tasks with addTask(),
+/// then execute() runs them on the pool and returns when all complete.
+///
+/// AUTHOR:  Wilson Snyder
+///
+//=============================================================================
+
+#ifndef _VERILATED_THREADS_H_
+#define _VERILATED_THREADS_H_ 1
+
+#include "verilatedos.h"
+
+#include <pthread.h>
+#include <vector>
+using namespace std;
+
+//=============================================================================
+// VerilatedThreadPool - Workers to run macro-tasks
+
+class VerilatedThreadPool {
+public:
+    typedef void (*MTaskFunc)(void* datap);	///< Macro-task entry point
+private:
+    struct Task {
+	MTaskFunc	m_funcp;	///< Function to call
+	void*		m_datap;	///< Argument, the symbol table
+    };
+    // MEMBERS
+    vector<pthread_t>	m_threads;	///< Workers; the executing thread is also used
+    vector<Task>	m_tasks;	///< Tasks queued by addTask
+    // Below protected by m_mutex
+    pthread_mutex_t	m_mutex;
+    pthread_cond_t	m_startCond;	///< Signaled when tasks are ready, or exiting
+    pthread_cond_t	m_doneCond;	///< Signaled when the last busy task completes
+    size_t		m_readyTasks;	///< Tasks in m_tasks workers may take
+    size_t		m_nextTask;	///< Next task in m_tasks to take
+    size_t		m_busyTasks;	///< Tasks taken but not completed
+    bool		m_exiting;	///< Destructing, workers should return
+    bool		m_forked;	///< In a forked child, workers must be restarted
+
+    static vector<VerilatedThreadPool*>	s_pools;	///< All pools, protected by s_poolsMutex
+    static pthread_mutex_t	s_poolsMutex;
+
+    // METHODS
+    static void* workerMain(void* poolp);
+    void worker();
+    void startWorkers(int threads);
+    void restartWorkers();
+    static void forkPrepare();
+    static void forkParent();
+    static void forkChild();
+    // CREATORS
+    VerilatedThreadPool(const VerilatedThreadPool&);	///< N/A, no copy constructor
+    VerilatedThreadPool& operator=(const VerilatedThreadPool&);	///< N/A
+public:
+    /// Construct pool evaluating with the given total number of threads
+    explicit VerilatedThreadPool(int threads);
+    ~VerilatedThreadPool();
+    // ACCESSORS
+    int threads() const { return (int)m_threads.size()+1; }
+    // METHODS
+    /// Queue a macro-task for the next execute()
+    void addTask(MTaskFunc funcp, void* datap) {
+	Task task;  task.m_funcp = funcp;  task.m_datap = datap;
+	m_tasks.push_back(task);
+    }
+    /// Run all queued macro-tasks, returning when all have completed
+    void execute();
+};
+
+#endif // guard
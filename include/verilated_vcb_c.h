@@ -0,0 +1,59 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2013 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in compressed binary VCB Format
+///
+/// VerilatedVcbC is used exactly as VerilatedVcdC, including being
+/// passed to a --trace model's trace() method, but writes a compressed
+/// binary file which is typically several times smaller and faster to
+/// write than VCD.  The file format is described in verilated_vcd_c.cpp.
+///
+/// VerilatedVcbC::toVcd converts a file to VCD.  A standalone converter
+/// may be built with:
+///
+///   cd $VERILATOR_ROOT/include
+///   g++ -DVERILATED_VCB2VCD -I. verilated_vcd_c.cpp verilated.cpp -o verilator_vcb2vcd
+///
+/// AUTHOR:  Wilson Snyder
+///
+//=============================================================================
+
+#ifndef _VERILATED_VCB_C_H_
+#define _VERILATED_VCB_C_H_ 1
+
+#include "verilatedos.h"
+#include "verilated_vcd_c.h"
+
+//=============================================================================
+// VerilatedVcbC
+/// Create a binary VCB dump file in C standalone (no SystemC) simulations.
+
+class VerilatedVcbC : public VerilatedVcdC {
+public:
+    // CONSTRUCTORS
+    VerilatedVcbC() { spTrace()->binary(true); }
+    ~VerilatedVcbC() {}
+    // METHODS
+    /// Convert a closed VCB file to VCD, returning false on error.  With
+    /// startTime, conversion begins at the last key point at or before
+    /// that time, found using the file's index.
+    static bool toVcd (const char* vcbFilename, const char* vcdFilename, vluint64_t startTime=0) {
+	return VerilatedVcd::vcbToVcd(vcbFilename, vcdFilename, startTime);
+    }
+};
+
+#endif // guard
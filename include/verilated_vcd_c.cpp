@@ -25,6 +25,9 @@
 #include "verilatedos.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
+#ifdef VL_THREADED
+# include "verilated_threads.h"
+#endif
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -86,24 +89,67 @@ void VerilatedVcd::open (const char* filename) {
 
     // Set member variables
     m_filename = filename;
-    s_vcdVecp.push_back(this);
+    if (find(s_vcdVecp.begin(), s_vcdVecp.end(), this) == s_vcdVecp.end()) {
+	s_vcdVecp.push_back(this);
+    }
+    m_binHeader = "";  // New header made by dumpHeader
+    if (m_binary && !m_binBufp) m_binBufp = new char [bufferAllocSize()];
+    if (VL_UNLIKELY(m_binary && m_ringBytes)) {
+	vl_fatal(__FILE__,__LINE__,"","VerilatedVcd::ringBuffer is not supported with binary format");
+    }
+    m_ringHeader = "";
+    m_ringSegs.clear();
+    m_ringUsed = 0;
+    m_ringFullBytes = 0;
+    m_ringDumped = false;
+    m_ringTriggers = 0;
 
     // SPDIFF_OFF
     // Set callback so an early exit will flush us
     Verilated::flushCb(&flush_all);
+    Verilated::forkCb(&fork_all);
+    if (m_ringBytes) Verilated::errorCb(&trigger_all);
 
     // SPDIFF_ON
-    openNext (m_rolloverMB!=0);
+    openNext (m_rolloverMB!=0 && !m_ringBytes);
     if (!isOpen()) return;
+    asyncStart();
 
+    m_filtered = !m_scopeIncludes.empty() || !m_scopeExcludes.empty();
     dumpHeader();
 
+    // Count traced codes, so anyTraced can check a range of codes at once
+    m_codeTraced.resize(m_nextCode+10, 0);
+    m_codeTracedSum.resize(m_nextCode+11);
+    m_codeTracedSum[0] = 0;
+    for (vluint32_t code=0; code<m_nextCode+10; ++code) {
+	m_codeTracedSum[code+1] = m_codeTracedSum[code] + (m_codeTraced[code] ? 1 : 0);
+    }
+    m_codeTracedSump = &m_codeTracedSum[0];
+
     // Allocate space now we know the number of codes
     if (!m_sigs_oldvalp) {
 	m_sigs_oldvalp = new vluint32_t [m_nextCode+10];
     }
+    if (!m_sigs_newvalp) {
+	m_sigs_newvalp = new vluint32_t [m_nextCode+10];
+	memset(m_sigs_newvalp, 0, sizeof(vluint32_t)*(m_nextCode+10));
+	// Map each code to its signal
+	m_codeSigs.assign(m_nextCode+10, ~0U);
+	for (vluint32_t i=0; i<m_sigs.size(); ++i) {
+	    const VerilatedVcdSig& sig = m_sigs[i];
+	    vluint32_t words = (sig.m_kind & VerilatedVcdSig::KIND_DOUBLE) ? 2 : (sig.m_bits+31)/32;
+	    for (vluint32_t word=0; word<words && sig.m_code+word<m_codeSigs.size(); ++word) {
+		m_codeSigs[sig.m_code+word] = i;
+	    }
+	}
+    }
+
+#ifdef VL_THREADED
+    if (m_threads > 1 && !m_poolp) m_poolp = new VerilatedThreadPool(m_threads);
+#endif
 
-    if (m_rolloverMB) {
+    if (m_rolloverMB && !m_ringBytes) {
 	openNext(true);
 	if (!isOpen()) return;
     }
@@ -114,31 +160,11 @@ void VerilatedVcd::openNext (bool incFilename) {
     // incFilename is true.
     closePrev(); // Close existing
     if (incFilename) {
-	// Find _0000.{ext} in filename
-	string name = m_filename;
-	size_t pos=name.rfind(".");
-	if (pos>8 && 0==strncmp("_cat",name.c_str()+pos-8,4)
-	    && isdigit(name.c_str()[pos-4])
-	    && isdigit(name.c_str()[pos-3])
-	    && isdigit(name.c_str()[pos-2])
-	    && isdigit(name.c_str()[pos-1])) {
-	    // Increment code.
-	    if ((++(name[pos-1])) > '9') {
-		name[pos-1] = '0';
-		if ((++(name[pos-2])) > '9') {
-		    name[pos-2] = '0';
-		    if ((++(name[pos-3])) > '9') {
-			name[pos-3] = '0';
-			if ((++(name[pos-4])) > '9') {
-			    name[pos-4] = '0';
-			}}}}
-	} else {
-	    // Append _cat0000
-	    name.insert(pos,"_cat0000");
-	}
-	m_filename = name;
+	m_filename = catFilename(m_filename);
     }
-    if (m_filename[0]=='|') {
+    if (m_ringBytes) {
+	m_fd = -1;  // Values go to memory until trigger()
+    } else if (m_filename[0]=='|') {
 	assert(0);	// Not supported yet.
     } else {
 	// cppcheck-suppress duplicateExpression
@@ -153,6 +179,38 @@ void VerilatedVcd::openNext (bool incFilename) {
     m_isOpen = true;
     m_fullDump = true;	// First dump must be full
     m_wroteBytes = 0;
+    if (m_binary) {
+	m_binIndex.clear();
+	m_binBlockKey = false;
+	m_binRawSinceKey = 0;
+	printRaw(m_binHeader.data(), m_binHeader.size());  // Each file is standalone
+    }
+}
+
+string VerilatedVcd::catFilename (const string& filename) {
+    // Find _0000.{ext} in filename
+    string name = filename;
+    size_t pos=name.rfind(".");
+    if (pos>8 && 0==strncmp("_cat",name.c_str()+pos-8,4)
+	&& isdigit(name.c_str()[pos-4])
+	&& isdigit(name.c_str()[pos-3])
+	&& isdigit(name.c_str()[pos-2])
+	&& isdigit(name.c_str()[pos-1])) {
+	// Increment code.
+	if ((++(name[pos-1])) > '9') {
+	    name[pos-1] = '0';
+	    if ((++(name[pos-2])) > '9') {
+		name[pos-2] = '0';
+		if ((++(name[pos-3])) > '9') {
+		    name[pos-3] = '0';
+		    if ((++(name[pos-4])) > '9') {
+			name[pos-4] = '0';
+		    }}}}
+    } else {
+	// Append _cat0000
+	name.insert(pos,"_cat0000");
+    }
+    return name;
 }
 
 void VerilatedVcd::makeNameMap() {
@@ -160,6 +218,9 @@ void VerilatedVcd::makeNameMap() {
     deleteNameMap();
     m_nextCode = 1;
     m_namemapp = new NameMap;
+    m_sigs.clear();  // Reopening declares them again
+    m_scopeTraced.clear();
+    m_codeTraced.clear();
     for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
 	VerilatedVcdCallInfo *cip = m_callbacks[ent];
 	cip->m_code = nextCode();
@@ -190,14 +251,74 @@ void VerilatedVcd::makeNameMap() {
     }
 }
 
+static bool vcdWildmatch (const char* s, const char* p) {
+    for ( ; *p; s++, p++) {
+	if (*p!='*') {
+	    // Pattern longer than the string; ? must not match the terminator
+	    if (*s == '\0') return false;
+	    if (((*s)!=(*p)) && *p != '?')
+		return false;
+	}
+	else {
+	    // Trailing star matches everything.
+	    if (!*++p) return true;
+	    for ( ; ; s++) {
+		if (vcdWildmatch(s, p)) return true;
+		if (*s == '\0') return false;
+	    }
+	}
+    }
+    return (*s == '\0');
+}
+
+static bool vcdScopeMatch (const string& scope, const vector<string>& patterns) {
+    // True if the scope, or a scope above it, matches a pattern
+    for (vector<string>::const_iterator it=patterns.begin(); it!=patterns.end(); ++it) {
+	for (size_t pos=scope.find('.'); ; pos=scope.find('.',pos+1)) {
+	    if (vcdWildmatch(scope.substr(0,pos).c_str(), it->c_str())) return true;
+	    if (pos==string::npos) break;
+	}
+    }
+    return false;
+}
+
+bool VerilatedVcd::scopeTraced (const string& scope) {
+    // Scope is dotted, as given to scopeInclude
+    if (!m_filtered) return true;
+    map<string,bool>::iterator it = m_scopeTraced.find(scope);
+    if (it != m_scopeTraced.end()) return it->second;
+    bool traced = ((m_scopeIncludes.empty() || vcdScopeMatch(scope, m_scopeIncludes))
+		   && !vcdScopeMatch(scope, m_scopeExcludes));
+    m_scopeTraced.insert(make_pair(scope, traced));
+    return traced;
+}
+
 void VerilatedVcd::deleteNameMap() {
     if (m_namemapp) { delete m_namemapp; m_namemapp=NULL; }
 }
 
 VerilatedVcd::~VerilatedVcd() {
     close();
+    asyncStop();
+#ifdef VL_THREADED
+    pthread_cond_destroy(&m_asyncCond);
+    pthread_mutex_destroy(&m_asyncMutex);
+#endif
     if (m_wrBufp) { delete[] m_wrBufp; m_wrBufp=NULL; }
+    if (m_binBufp) { delete[] m_binBufp; m_binBufp=NULL; }
     if (m_sigs_oldvalp) { delete[] m_sigs_oldvalp; m_sigs_oldvalp=NULL; }
+    if (m_sigs_newvalp) { delete[] m_sigs_newvalp; m_sigs_newvalp=NULL; }
+#ifdef VL_THREADED
+    for (vector<VerilatedVcd*>::iterator it=m_shardps.begin(); it!=m_shardps.end(); ++it) {
+	// Shares our values, so mustn't free them
+	(*it)->m_isOpen = false;
+	(*it)->m_sigs_oldvalp = NULL;
+	(*it)->m_sigs_newvalp = NULL;
+	delete *it;
+    }
+    m_shardps.clear();
+    if (m_poolp) { delete m_poolp; m_poolp=NULL; }
+#endif
     deleteNameMap();
     // Remove from list of traces
     vector<VerilatedVcd*>::iterator pos = find(s_vcdVecp.begin(), s_vcdVecp.end(), this);
@@ -208,8 +329,11 @@ void VerilatedVcd::closePrev () {
     if (!isOpen()) return;
 
     bufferFlush();
+    if (m_binary) binaryClose();
+    asyncDrain();  // Writer must finish with m_fd
+    if (!isOpen()) return;  // Writer had error
     m_isOpen = false;
-    ::close(m_fd);
+    if (m_fd >= 0) ::close(m_fd);
 }
 
 void VerilatedVcd::closeErr () {
@@ -219,7 +343,7 @@ void VerilatedVcd::closeErr () {
 
     // No buffer flush, just fclose
     m_isOpen = false;
-    ::close(m_fd);  // May get error, just ignore it
+    if (m_fd >= 0) ::close(m_fd);  // May get error, just ignore it
 }
 
 void VerilatedVcd::close() {
@@ -230,6 +354,12 @@ void VerilatedVcd::close() {
 	printStr(" $end\n");
     }
     closePrev();
+    asyncStop();
+}
+
+void VerilatedVcd::flush() {
+    bufferFlush();
+    asyncDrain();
 }
 
 void VerilatedVcd::printStr (const char* str) {
@@ -258,6 +388,7 @@ void VerilatedVcd::printTime (vluint64_t timeui) {
 	}
     }
     m_timeLastDump = timeui;
+    if (m_binary) { binVarint(timeui); return; }
     printQuad(timeui);
 }
 
@@ -266,28 +397,592 @@ void VerilatedVcd::bufferFlush () {
     // When it gets nearly full we dump it using this routine which calls write()
     // This is much faster than using buffered I/O
     if (VL_UNLIKELY(!isOpen())) return;
-    char* wp = m_wrBufp;
+#ifdef VL_THREADED
+    if (m_shardParentp) {
+	m_shardOut.append(m_wrBufp, m_writep - m_wrBufp);
+	m_shardCuts.push_back(m_shardOut.size());
+	m_writep = m_wrBufp;
+	return;
+    }
+#endif
+    if (m_ringBytes) { ringFlush(); return; }
+    if (m_binary && !m_binRawMode) {
+	if (m_binHeaderMode) {
+	    m_binHeaderText.append(m_wrBufp, m_writep - m_wrBufp);
+	    m_writep = m_wrBufp;
+	    return;
+	}
+	binaryBlock();  // Replaces buffer with compressed block
+    }
+#ifdef VL_THREADED
+    if (m_asyncRunning) { asyncHandoff(); return; }
+#endif
+    size_t len = m_writep - m_wrBufp;
+    int err = bufferWrite(m_fd, m_wrBufp, len);
+    if (VL_UNLIKELY(err)) {
+	bufferError(err);
+    } else {
+	m_wroteBytes += len;
+    }
+
+    // Reset buffer
+    m_writep = m_wrBufp;
+}
+
+int VerilatedVcd::bufferWrite (int fd, const char* bufp, size_t len) {
+    // Write the buffer, returning 0 or the errno of the failure
+    const char* wp = bufp;
     while (1) {
-	ssize_t remaining = (m_writep - wp);
+	ssize_t remaining = (bufp + len - wp);
 	if (remaining==0) break;
 	errno = 0;
-	ssize_t got = write (m_fd, wp, remaining);
+	ssize_t got = write (fd, wp, remaining);
 	if (got>0) {
 	    wp += got;
-	    m_wroteBytes += got;
 	} else if (got < 0) {
 	    if (errno != EAGAIN && errno != EINTR) {
 		// write failed, presume error (perhaps out of disk space)
-		string msg = (string)"VerilatedVcd::bufferFlush: "+strerror(errno);
-		vl_fatal("",0,"",msg.c_str());
-		closeErr();
-		break;
+		return errno;
 	    }
 	}
     }
+    return 0;
+}
 
-    // Reset buffer
+void VerilatedVcd::bufferError (int err) {
+    string msg = (string)"VerilatedVcd::bufferFlush: "+strerror(err);
+    vl_fatal("",0,"",msg.c_str());
+    closeErr();
+}
+
+//=============================================================================
+// Background writing
+//
+// With asyncBuffers, a filled buffer is queued to a writer thread and the
+// simulation continues filling the next free buffer.  The simulation only
+// blocks when every buffer is queued.  m_wroteBytes counts bytes when
+// queued, so rollover happens at the same points as synchronous writing.
+
+void VerilatedVcd::asyncStart() {
+#ifdef VL_THREADED
+    if (m_asyncRunning || m_asyncBuffers < 2 || m_ringBytes) return;
+    m_asyncFull.clear();
+    m_asyncFree.clear();
+    m_asyncBusy = false;
+    m_asyncExit = false;
+    m_asyncErrno = 0;
+    // m_wrBufp is the first buffer
+    for (size_t i=1; i<m_asyncBuffers; ++i) {
+	m_asyncFree.push_back(new char [bufferAllocSize()]);
+    }
+    if (pthread_create(&m_asyncThread, NULL, &asyncMain, this)) {
+	vl_fatal(__FILE__,__LINE__,"","Can't create VCD writer thread");
+    }
+    m_asyncRunning = true;
+#endif
+}
+
+void VerilatedVcd::asyncDrain() {
+    // Wait for the writer to write everything queued
+#ifdef VL_THREADED
+    if (!m_asyncRunning) return;
+    pthread_mutex_lock(&m_asyncMutex);
+    while (!m_asyncFull.empty() || m_asyncBusy) {
+	pthread_cond_wait(&m_asyncCond, &m_asyncMutex);
+    }
+    int err = m_asyncErrno;
+    if (err > 0) m_asyncErrno = -1;
+    pthread_mutex_unlock(&m_asyncMutex);
+    if (VL_UNLIKELY(err > 0)) bufferError(err);
+#endif
+}
+
+void VerilatedVcd::asyncStop() {
+#ifdef VL_THREADED
+    if (!m_asyncRunning) return;
+    pthread_mutex_lock(&m_asyncMutex);
+    m_asyncExit = true;
+    pthread_cond_broadcast(&m_asyncCond);
+    pthread_mutex_unlock(&m_asyncMutex);
+    pthread_join(m_asyncThread, NULL);  // Writer empties queue before returning
+    m_asyncRunning = false;
+    // All buffers other than m_wrBufp are now free
+    for (vector<char*>::iterator it=m_asyncFree.begin(); it!=m_asyncFree.end(); ++it) {
+	delete[] *it;
+    }
+    m_asyncFree.clear();
+#endif
+}
+
+#ifdef VL_THREADED
+void* VerilatedVcd::asyncMain(void* vcdp) {
+    static_cast<VerilatedVcd*>(vcdp)->asyncWriter();
+    return NULL;
+}
+
+void VerilatedVcd::asyncWriter() {
+    pthread_mutex_lock(&m_asyncMutex);
+    while (1) {
+	if (!m_asyncFull.empty()) {
+	    pair<char*,size_t> buf = m_asyncFull.front();
+	    m_asyncFull.pop_front();
+	    m_asyncBusy = true;
+	    bool skip = (m_asyncErrno != 0);  // Discard all data after an error
+	    int fd = m_fd;  // Only changed by the simulation after asyncDrain
+	    pthread_mutex_unlock(&m_asyncMutex);
+	    int err = skip ? 0 : bufferWrite(fd, buf.first, buf.second);
+	    pthread_mutex_lock(&m_asyncMutex);
+	    if (err && !m_asyncErrno) m_asyncErrno = err;
+	    m_asyncFree.push_back(buf.first);
+	    m_asyncBusy = false;
+	    pthread_cond_broadcast(&m_asyncCond);
+	} else if (m_asyncExit) {
+	    break;
+	} else {
+	    pthread_cond_wait(&m_asyncCond, &m_asyncMutex);
+	}
+    }
+    pthread_mutex_unlock(&m_asyncMutex);
+}
+
+void VerilatedVcd::asyncHandoff() {
+    // Queue the filled buffer, and continue in a free one
+    size_t len = m_writep - m_wrBufp;
+    if (!len) return;
+    pthread_mutex_lock(&m_asyncMutex);
+    m_asyncFull.push_back(make_pair(m_wrBufp, len));
+    m_wroteBytes += len;
+    pthread_cond_broadcast(&m_asyncCond);
+    while (m_asyncFree.empty()) {  // Writer is behind
+	pthread_cond_wait(&m_asyncCond, &m_asyncMutex);
+    }
+    m_wrBufp = m_asyncFree.back();
+    m_asyncFree.pop_back();
+    int err = m_asyncErrno;
+    if (err > 0) m_asyncErrno = -1;
+    pthread_mutex_unlock(&m_asyncMutex);
     m_writep = m_wrBufp;
+    if (VL_UNLIKELY(err > 0)) bufferError(err);
+}
+#endif
+
+//=============================================================================
+// Ring buffer
+//
+// With ringBuffer, flushed buffers are appended to segments in memory
+// rather than written.  Each segment starts with a full dump, so the
+// oldest segment kept is the window's initial snapshot.  A new segment
+// starts once the current one holds a quarter of the ring, and the
+// oldest segments are then dropped to keep within the ring size.  So a
+// segment is never only its full dump, it holds at least twice the size
+// of the full dump, even if the ring then grows past ringBytes.
+
+void VerilatedVcd::ringFlush() {
+    size_t len = m_writep - m_wrBufp;
+    if (m_ringSegs.empty()) {
+	m_ringHeader.append(m_wrBufp, len);  // Still in dumpHeader
+    } else {
+	m_ringSegs.back().append(m_wrBufp, len);
+	m_ringUsed += len;
+    }
+    m_writep = m_wrBufp;
+}
+
+size_t VerilatedVcd::ringSegBytes() const {
+    size_t segBytes = m_ringBytes/4;
+    if (segBytes < 2*m_ringFullBytes) segBytes = 2*m_ringFullBytes;
+    return segBytes;
+}
+
+void VerilatedVcd::ringSegment() {
+    // Called before a full dump
+    bufferFlush();
+    size_t segBytes = ringSegBytes();
+    while (!m_ringSegs.empty() && m_ringUsed + segBytes > m_ringBytes) {
+	m_ringUsed -= m_ringSegs.front().size();
+	m_ringSegs.pop_front();
+    }
+    m_ringSegs.push_back(string());
+    m_ringSegs.back().reserve(segBytes + bufferSize());
+}
+
+void VerilatedVcd::ringFullDone() {
+    // Called after a full dump, to size following segments from it
+    bufferFlush();
+    size_t fullBytes = m_ringSegs.back().size();
+    if (VL_UNLIKELY(fullBytes > m_ringBytes/4 && m_ringFullBytes <= m_ringBytes/4)) {  // Warn once
+	VL_PRINTF("%%Warning: %s: VerilatedVcd::ringBuffer of %lu bytes is under four times"
+		  " the full dump of %lu bytes, so will hold more than requested\n",
+		  m_filename.c_str(), (unsigned long)m_ringBytes, (unsigned long)fullBytes);
+    }
+    if (fullBytes > m_ringFullBytes) m_ringFullBytes = fullBytes;
+}
+
+void VerilatedVcd::trigger() {
+    if (!isOpen() || !m_ringBytes) return;
+    // $stop calls flushCall twice, and a vl_fatal reported below calls
+    // back here, so ignore triggers without new values
+    if (!m_ringDumped) return;
+    bufferFlush();
+    string filename = m_ringTriggers++ ? catFilename(m_filename) : m_filename;
+    if (m_ringTriggers > 1) m_filename = filename;
+    // cppcheck-suppress duplicateExpression
+    int fd = ::open (filename.c_str(), O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_NONBLOCK
+		     , 0666);
+    int err = (fd<0) ? errno : 0;
+    if (!err) err = bufferWrite(fd, m_ringHeader.data(), m_ringHeader.size());
+    for (deque<string>::const_iterator it=m_ringSegs.begin(); !err && it!=m_ringSegs.end(); ++it) {
+	err = bufferWrite(fd, it->data(), it->size());
+    }
+    if (fd>=0) ::close(fd);
+    m_ringDumped = false;
+    if (VL_UNLIKELY(err)) {
+	string msg = (string)"VerilatedVcd::trigger: "+filename+": "+strerror(err);
+	vl_fatal("",0,"",msg.c_str());
+    }
+}
+
+//=============================================================================
+// Binary format
+//
+// With binary(true) the full* routines write binary value records rather
+// than VCD text, and each buffer is compressed into a block.  All numbers
+// are little endian.  The file is:
+//
+//   "VLVCB01\n"                         Magic
+//   Block 'H'                           Signal table, then VCD declarations text
+//   Block 'K' or 'V' ...                Value records
+//   Block 'I'                           Index: u32 count, {u64 time, u64 offset}...
+//   u64 offset of 'I' block, "VLVCBEND" Tail, absent if not closed
+//
+// Each block is a 20 byte header: u8 type, u8 method (0=stored, 1=LZ),
+// u16 zero, u32 raw length, u32 stored length, u64 time; then the stored
+// data.  A signal table entry is u32 code, u32 bits, u8 kind.  Value
+// records are a varint N: N=0 is followed by a varint time; otherwise
+// code=N/2, and if N is even the value follows, (bits+7)/8 bytes, or twice
+// that for tristates.  Odd N indicates the value is all X.  'K' blocks
+// begin with a full dump, so decoding may start at any 'K' block.
+
+static const char* const vcbMagic = "VLVCB01\n";
+static const char* const vcbTailMagic = "VLVCBEND";
+static const size_t vcbBlockHeaderSize = 20;
+static const int vcbHashBits = 14;
+
+static inline void vcbStore (char* outp, vluint64_t val, int bytes) {
+    for (int i=0; i<bytes; ++i) outp[i] = (char)(val >> (i*8));
+}
+static inline vluint64_t vcbLoad (const char* inp, int bytes) {
+    vluint64_t val = 0;
+    for (int i=0; i<bytes; ++i) val |= ((vluint64_t)(vluint8_t)inp[i]) << (i*8);
+    return val;
+}
+static inline void vcbAppend (string& out, vluint64_t val, int bytes) {
+    char buf[8];  vcbStore(buf, val, bytes);  out.append(buf, bytes);
+}
+static inline size_t vcbPutVarint (vluint8_t* outp, size_t op, vluint64_t n) {
+    while (n >= 0x80) { outp[op++] = (vluint8_t)(n | 0x80); n >>= 7; }
+    outp[op++] = (vluint8_t)n;
+    return op;
+}
+static inline bool vcbGetVarint (const vluint8_t* inp, size_t len, size_t& ip, vluint64_t& n) {
+    n = 0;
+    for (int shift=0; shift<64; shift+=7) {
+	if (ip >= len) return false;
+	vluint8_t c = inp[ip++];
+	n |= ((vluint64_t)(c & 0x7f)) << shift;
+	if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static size_t vcbCompress (const char* srcp, size_t len, char* dstp, size_t dstMax, vluint32_t* hashp) {
+    // Simple LZ77: {varint literals, literal bytes, varint match-4, varint offset}...
+    // Returns compressed length, or 0 if not smaller than dstMax
+    const vluint8_t* sp = (const vluint8_t*)srcp;
+    vluint8_t* dp = (vluint8_t*)dstp;
+    memset(hashp, 0, sizeof(vluint32_t)<<vcbHashBits);  // Entries are position+1
+    size_t ip = 0;
+    size_t anchor = 0;
+    size_t op = 0;
+    while (ip+4 <= len) {
+	vluint32_t seq;  memcpy(&seq, sp+ip, 4);
+	vluint32_t hash = (seq * 2654435761U) >> (32-vcbHashBits);
+	size_t cand = hashp[hash];
+	hashp[hash] = (vluint32_t)(ip+1);
+	vluint32_t candSeq = 0;
+	if (cand) memcpy(&candSeq, sp+cand-1, 4);
+	if (!cand || candSeq != seq) { ++ip; continue; }
+	--cand;
+	size_t matchLen = 4;
+	while (ip+matchLen < len && sp[cand+matchLen] == sp[ip+matchLen]) ++matchLen;
+	size_t lits = ip - anchor;
+	if (op + lits + 30 > dstMax) return 0;
+	op = vcbPutVarint(dp, op, lits);
+	memcpy(dp+op, sp+anchor, lits);  op += lits;
+	op = vcbPutVarint(dp, op, matchLen-4);
+	op = vcbPutVarint(dp, op, ip-cand);
+	ip += matchLen;
+	anchor = ip;
+    }
+    if (anchor < len || !op) {
+	size_t lits = len - anchor;
+	if (op + lits + 10 > dstMax) return 0;
+	op = vcbPutVarint(dp, op, lits);
+	memcpy(dp+op, sp+anchor, lits);  op += lits;
+    }
+    return op;
+}
+
+static bool vcbDecompress (const char* srcp, size_t len, char* dstp, size_t dstLen) {
+    const vluint8_t* sp = (const vluint8_t*)srcp;
+    size_t ip = 0;
+    size_t op = 0;
+    while (op < dstLen) {
+	vluint64_t lits;
+	if (!vcbGetVarint(sp, len, ip, lits)) return false;
+	if (lits > len-ip || lits > dstLen-op) return false;
+	memcpy(dstp+op, sp+ip, lits);  ip += lits;  op += lits;
+	if (op == dstLen) break;
+	vluint64_t matchLen, offset;
+	if (!vcbGetVarint(sp, len, ip, matchLen)) return false;
+	if (!vcbGetVarint(sp, len, ip, offset)) return false;
+	matchLen += 4;
+	if (!offset || offset > op || matchLen > dstLen-op) return false;
+	for (size_t i=0; i<matchLen; ++i, ++op) dstp[op] = dstp[op-offset];  // May overlap
+    }
+    return true;
+}
+
+size_t VerilatedVcd::binaryBlockFormat (char* outp, char type, vluint64_t timeui,
+					const char* rawp, size_t rawLen) {
+    // Write block header and compressed data to outp, which must have
+    // vcbBlockHeaderSize+rawLen bytes.  Returns length of block.
+    if (m_binHash.empty()) m_binHash.resize(1<<vcbHashBits);
+    char* datap = outp + vcbBlockHeaderSize;
+    size_t storedLen = vcbCompress(rawp, rawLen, datap, rawLen, &m_binHash[0]);
+    int method = 1;
+    if (!storedLen) {  // Incompressible
+	memcpy(datap, rawp, rawLen);
+	storedLen = rawLen;
+	method = 0;
+    }
+    outp[0] = type;
+    outp[1] = (char)method;
+    vcbStore(outp+2, 0, 2);
+    vcbStore(outp+4, rawLen, 4);
+    vcbStore(outp+8, storedLen, 4);
+    vcbStore(outp+12, timeui, 8);
+    return vcbBlockHeaderSize + storedLen;
+}
+
+void VerilatedVcd::binaryHeader() {
+    // dumpHeader has finished, make the header block from its text
+    bufferFlush();
+    m_binHeaderMode = false;
+    map<vluint32_t,const VerilatedVcdSig*> sigs;  // Declarations may repeat codes
+    for (vector<VerilatedVcdSig>::const_iterator it=m_sigs.begin(); it!=m_sigs.end(); ++it) {
+	if (sigs.find(it->m_code) == sigs.end()) sigs[it->m_code] = &(*it);
+    }
+    string raw;
+    vcbAppend(raw, sigs.size(), 4);
+    for (map<vluint32_t,const VerilatedVcdSig*>::iterator it=sigs.begin(); it!=sigs.end(); ++it) {
+	vcbAppend(raw, it->second->m_code, 4);
+	vcbAppend(raw, it->second->m_bits, 4);
+	vcbAppend(raw, it->second->m_kind, 1);
+    }
+    raw += m_binHeaderText;
+    m_binHeaderText = "";
+    vector<char> block (vcbBlockHeaderSize + raw.size());
+    size_t len = binaryBlockFormat(&block[0], 'H', 0, raw.data(), raw.size());
+    m_binHeader = string(vcbMagic) + string(&block[0], len);
+    printRaw(m_binHeader.data(), m_binHeader.size());
+}
+
+void VerilatedVcd::binaryBlock() {
+    // Compress value records in the buffer into a block, then swap so the
+    // block is in the buffer to be written
+    size_t rawLen = m_writep - m_wrBufp;
+    if (!rawLen) return;
+    vluint64_t blockTime = m_binBlockTime;
+    if (m_wrBufp[0] == 0) {  // Starts with time record
+	size_t ip = 1;
+	vcbGetVarint((const vluint8_t*)m_wrBufp, rawLen, ip, blockTime);
+    }
+    if (m_binBlockKey) m_binIndex.push_back(make_pair(blockTime, m_wroteBytes));
+    size_t len = binaryBlockFormat(m_binBufp, m_binBlockKey ? 'K' : 'V', blockTime, m_wrBufp, rawLen);
+    m_binRawSinceKey += rawLen;
+    m_binBlockKey = false;
+    m_binBlockTime = m_timeLastDump;
+    swap(m_wrBufp, m_binBufp);
+    m_writep = m_wrBufp + len;
+}
+
+void VerilatedVcd::binaryClose() {
+    // Write index and tail; values must already be flushed
+    string raw;
+    vcbAppend(raw, m_binIndex.size(), 4);
+    for (vector<pair<vluint64_t,vluint64_t> >::iterator it=m_binIndex.begin(); it!=m_binIndex.end(); ++it) {
+	vcbAppend(raw, it->first, 8);
+	vcbAppend(raw, it->second, 8);
+    }
+    vluint64_t indexOffset = m_wroteBytes;
+    vector<char> block (vcbBlockHeaderSize + raw.size());
+    size_t len = binaryBlockFormat(&block[0], 'I', m_timeLastDump, raw.data(), raw.size());
+    string out (&block[0], len);
+    vcbAppend(out, indexOffset, 8);
+    out += vcbTailMagic;
+    printRaw(out.data(), out.size());
+}
+
+void VerilatedVcd::printRaw (const char* datap, size_t len) {
+    // Write bytes to the file, not as part of a value block
+    bufferFlush();
+    m_binRawMode = true;
+    while (len) {
+	size_t chunk = min(len, bufferSize() - (size_t)(m_writep - m_wrBufp));
+	memcpy(m_writep, datap, chunk);
+	m_writep += chunk;  datap += chunk;  len -= chunk;
+	bufferFlush();
+    }
+    m_binRawMode = false;
+}
+
+//=============================================================================
+// Binary conversion
+
+static bool vcbReadBlock (FILE* fp, char& type, vluint64_t& timeui, vector<char>& raw) {
+    char hdr[vcbBlockHeaderSize];
+    if (fread(hdr, 1, vcbBlockHeaderSize, fp) != vcbBlockHeaderSize) return false;
+    type = hdr[0];
+    int method = hdr[1];
+    size_t rawLen = vcbLoad(hdr+4, 4);
+    size_t storedLen = vcbLoad(hdr+8, 4);
+    timeui = vcbLoad(hdr+12, 8);
+    vector<char> stored (storedLen+1);
+    if (fread(&stored[0], 1, storedLen, fp) != storedLen) return false;
+    raw.resize(rawLen+1);
+    if (method == 0) {
+	if (rawLen != storedLen) return false;
+	memcpy(&raw[0], &stored[0], rawLen);
+    } else if (method == 1) {
+	if (!vcbDecompress(&stored[0], storedLen, &raw[0], rawLen)) return false;
+    } else {
+	return false;
+    }
+    raw.resize(rawLen);
+    return true;
+}
+
+bool VerilatedVcd::vcbToVcd (const char* vcbFilename, const char* vcdFilename, vluint64_t startTime) {
+    // Return false on any error
+    FILE* inp = fopen(vcbFilename, "rb");
+    if (!inp) return false;
+    char magic[8];
+    char type;
+    vluint64_t timeui;
+    vector<char> raw;
+    if (fread(magic, 1, 8, inp) != 8 || memcmp(magic, vcbMagic, 8)
+	|| !vcbReadBlock(inp, type, timeui, raw) || type != 'H' || raw.size() < 4) {
+	fclose(inp);
+	return false;
+    }
+    // Signal table, indexed by code
+    vector<VerilatedVcdSig> sigs;
+    vector<int> sigOfCode;
+    size_t nsigs = vcbLoad(&raw[0], 4);
+    size_t pos = 4;
+    for (size_t i=0; i<nsigs && pos+9 <= raw.size(); ++i, pos+=9) {
+	vluint32_t code = vcbLoad(&raw[pos], 4);
+	if (code >= sigOfCode.size()) sigOfCode.resize(code+1, -1);
+	sigOfCode[code] = sigs.size();
+	sigs.push_back(VerilatedVcdSig(code, vcbLoad(&raw[pos+4], 4), vcbLoad(&raw[pos+8], 1)));
+    }
+    FILE* outp = fopen(vcdFilename, "w");
+    if (!outp) { fclose(inp); return false; }
+    fwrite(&raw[pos], 1, raw.size()-pos, outp);
+
+    // Find starting block using the index
+    if (startTime) {
+	char tail[16];
+	long offset = -1;
+	if (0==fseek(inp, -16, SEEK_END) && fread(tail, 1, 16, inp)==16
+	    && 0==memcmp(tail+8, vcbTailMagic, 8)
+	    && 0==fseek(inp, (long)vcbLoad(tail, 8), SEEK_SET)
+	    && vcbReadBlock(inp, type, timeui, raw) && type=='I' && raw.size()>=4) {
+	    size_t entries = vcbLoad(&raw[0], 4);
+	    for (size_t i=0; i<entries && 4+i*16+16 <= raw.size(); ++i) {
+		if (vcbLoad(&raw[4+i*16], 8) > startTime) break;
+		offset = (long)vcbLoad(&raw[4+i*16+8], 8);
+	    }
+	}
+	if (offset < 0 || fseek(inp, offset, SEEK_SET)) {  // No index, start at beginning
+	    fseek(inp, 8, SEEK_SET);
+	    vcbReadBlock(inp, type, timeui, raw);
+	}
+    }
+
+    // Values
+    bool ok = true;
+    string line;
+    while (ok && vcbReadBlock(inp, type, timeui, raw)) {
+	if (type == 'I') break;
+	if (type != 'K' && type != 'V') { ok = false; break; }
+	const vluint8_t* rp = (const vluint8_t*)(raw.empty() ? NULL : &raw[0]);
+	size_t ip = 0;
+	while (ip < raw.size()) {
+	    vluint64_t n;
+	    if (!vcbGetVarint(rp, raw.size(), ip, n)) { ok = false; break; }
+	    if (n == 0) {
+		vluint64_t t;
+		if (!vcbGetVarint(rp, raw.size(), ip, t)) { ok = false; break; }
+		fprintf(outp, "#%" VL_PRI64 "u\n", t);
+		continue;
+	    }
+	    vluint32_t code = (vluint32_t)(n >> 1);
+	    if (code >= sigOfCode.size() || sigOfCode[code] < 0) { ok = false; break; }
+	    const VerilatedVcdSig& sig = sigs[sigOfCode[code]];
+	    int bits = sig.m_bits;
+	    size_t bytes = (bits+7)/8;
+	    line = "";
+	    if (n & 1) {  // X
+		if (sig.m_kind & VerilatedVcdSig::KIND_SCALAR) line = "x";
+		else line = "b" + string(bits,'x') + " ";
+	    } else if (sig.m_kind & (VerilatedVcdSig::KIND_DOUBLE | VerilatedVcdSig::KIND_FLOAT)) {
+		char buf[100];
+		if (sig.m_kind & VerilatedVcdSig::KIND_DOUBLE) {
+		    if (ip+8 > raw.size()) { ok = false; break; }
+		    union { double d; vluint64_t q; } u;  u.q = vcbLoad((const char*)rp+ip, 8);
+		    sprintf(buf, "r%.16g ", u.d);
+		    ip += 8;
+		} else {
+		    if (ip+4 > raw.size()) { ok = false; break; }
+		    union { float f; vluint32_t i; } u;  u.i = (vluint32_t)vcbLoad((const char*)rp+ip, 4);
+		    sprintf(buf, "r%.16g ", (double)u.f);
+		    ip += 4;
+		}
+		line = buf;
+	    } else {
+		bool tri = (sig.m_kind & VerilatedVcdSig::KIND_TRI);
+		if (ip + bytes*(tri?2:1) > raw.size()) { ok = false; break; }
+		const vluint8_t* valp = rp+ip;
+		const vluint8_t* trip = rp+ip+bytes;
+		ip += bytes*(tri?2:1);
+		if (!(sig.m_kind & VerilatedVcdSig::KIND_SCALAR)) line = "b";
+		for (int bit=bits-1; bit>=0; --bit) {
+		    int val = (valp[bit/8] >> (bit&7)) & 1;
+		    if (tri) val |= ((trip[bit/8] >> (bit&7)) & 1) << 1;
+		    line += "01zz"[val];
+		}
+		if (!(sig.m_kind & VerilatedVcdSig::KIND_SCALAR)) line += " ";
+	    }
+	    line += stringCode(code);
+	    line += "\n";
+	    fwrite(line.data(), 1, line.size(), outp);
+	}
+    }
+    fclose(outp);
+    fclose(inp);
+    return ok;
 }
 
 //=============================================================================
@@ -347,6 +1042,10 @@ void VerilatedVcd::printIndent (int level_change) {
 }
 
 void VerilatedVcd::dumpHeader () {
+    if (m_binary) {
+	m_binHeaderMode = true;
+	m_binHeaderText = "";
+    }
     printStr("$version Generated by VerilatedVcd $end\n");
     time_t time_str = time(NULL);
     printStr("$date "); printStr(ctime(&time_str)); printStr(" $end\n");
@@ -422,6 +1121,8 @@ void VerilatedVcd::dumpHeader () {
 
     // Reclaim storage
     deleteNameMap();
+
+    if (m_binary) binaryHeader();
 }
 
 void VerilatedVcd::module (string name) {
@@ -443,7 +1144,11 @@ void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep
     }
 
     // Save declaration info
-    VerilatedVcdSig sig = VerilatedVcdSig(code, bits);
+    int kind = 0;
+    if (!bussed) kind |= VerilatedVcdSig::KIND_SCALAR;
+    if (tri) kind |= VerilatedVcdSig::KIND_TRI;
+    if (0==strcmp(wirep,"real")) kind |= (bits>32) ? VerilatedVcdSig::KIND_DOUBLE : VerilatedVcdSig::KIND_FLOAT;
+    VerilatedVcdSig sig = VerilatedVcdSig(code, bits, kind);
     m_sigs.push_back(sig);
 
     // Split name into basename
@@ -466,6 +1171,11 @@ void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep
 	    basename += *cp;
 	}
     }
+    string scope = hiername;
+    replace(scope.begin(), scope.end(), ' ', '.');
+    if (!scopeTraced(scope)) return;  // Values not printed, see codeOff
+    if (m_codeTraced.size() < code+codesNeeded) m_codeTraced.resize(code+codesNeeded, 0);
+    for (int i=0; i<codesNeeded; ++i) m_codeTraced[code+i] = 1;
     hiername += "\t"+basename;
 
     // Print reference
@@ -520,6 +1230,12 @@ void VerilatedVcd::declDouble   (vluint32_t code, const char* name, int arraynum
 
 void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
     (*((double*)&m_sigs_oldvalp[code])) = newval;
+    if (VL_UNLIKELY(codeOff(code))) return;
+    if (m_binary) {
+	union { double d; vluint64_t q; } u;  u.d = newval;
+	binCode(code,false); binBytes(u.q,64); bufferCheck();
+	return;
+    }
     // Buffer can't overflow; we have at least bufferInsertSize() bytes (>>>16 bytes)
     sprintf(m_writep, "r%.16g", newval);
     m_writep += strlen(m_writep);
@@ -528,6 +1244,12 @@ void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
 }
 void VerilatedVcd::fullFloat (vluint32_t code, const float newval) {
     (*((float*)&m_sigs_oldvalp[code])) = newval;
+    if (VL_UNLIKELY(codeOff(code))) return;
+    if (m_binary) {
+	union { float f; vluint32_t i; } u;  u.f = newval;
+	binCode(code,false); binBytes(u.i,32); bufferCheck();
+	return;
+    }
     // Buffer can't overflow; we have at least bufferInsertSize() bytes (>>>16 bytes)
     sprintf(m_writep, "r%.16g", (double)newval);
     m_writep += strlen(m_writep);
@@ -535,6 +1257,48 @@ void VerilatedVcd::fullFloat (vluint32_t code, const float newval) {
     bufferCheck();
 }
 
+void VerilatedVcd::chgStaged (vluint32_t code, vluint32_t endCode) {
+    // Most calls find no difference, so compare with the vector kernels,
+    // then format just the signals containing differing words
+    const VerilatedVcd* declp = this;  // Has the signal tables
+#ifdef VL_THREADED
+    if (m_shardParentp) declp = m_shardParentp;
+#endif
+    while (code < endCode) {
+	code += VerilatedSimd::s_active.m_firstDiff(endCode-code, m_sigs_newvalp+code, m_sigs_oldvalp+code);
+	if (code >= endCode) break;
+	vluint32_t sigIndex = declp->m_codeSigs[code];
+	if (VL_UNLIKELY(sigIndex >= declp->m_sigs.size())) {  // Not declared, shouldn't happen
+	    m_sigs_oldvalp[code] = m_sigs_newvalp[code];
+	    ++code;
+	    continue;
+	}
+	const VerilatedVcdSig& sig = declp->m_sigs[sigIndex];
+	vluint32_t sigCode = sig.m_code;
+	const vluint32_t* newp = m_sigs_newvalp + sigCode;
+	if (sig.m_kind & VerilatedVcdSig::KIND_DOUBLE) {
+	    chgDouble(sigCode, *((const double*)newp));
+	    (*((vluint64_t*)&m_sigs_oldvalp[sigCode])) = *((const vluint64_t*)newp);  // E.g. -0.0
+	    code = sigCode + 2;
+	} else if (sig.m_kind & VerilatedVcdSig::KIND_SCALAR) {
+	    chgBit(sigCode, newp[0]);
+	    m_sigs_oldvalp[sigCode] = newp[0];  // In case only unused bits changed
+	    code = sigCode + 1;
+	} else if (sig.m_bits <= 32) {
+	    chgBus(sigCode, newp[0], sig.m_bits);
+	    m_sigs_oldvalp[sigCode] = newp[0];
+	    code = sigCode + 1;
+	} else if (sig.m_bits <= 64) {
+	    chgQuad(sigCode, *((const vluint64_t*)newp), sig.m_bits);
+	    (*((vluint64_t*)&m_sigs_oldvalp[sigCode])) = *((const vluint64_t*)newp);
+	    code = sigCode + 2;
+	} else {
+	    fullArray(sigCode, newp, sig.m_bits);
+	    code = sigCode + (sig.m_bits+31)/32;
+	}
+    }
+}
+
 //=============================================================================
 // Callbacks
 
@@ -564,9 +1328,26 @@ void VerilatedVcd::dumpFull (vluint64_t timeui) {
 
 void VerilatedVcd::dump (vluint64_t timeui) {
     if (!isOpen()) return;
+    if (VL_UNLIKELY(m_binary && m_binRawSinceKey > binKeyInterval())) {
+	m_fullDump = true;	// Start a new key block for random access
+    }
+    if (VL_UNLIKELY(m_ringBytes)) {
+	m_ringDumped = true;
+	if (!m_ringSegs.empty()
+	    && m_ringSegs.back().size() + (m_writep - m_wrBufp) > ringSegBytes()) {
+	    m_fullDump = true;	// Start a new segment
+	}
+    }
     if (VL_UNLIKELY(m_fullDump)) {
 	m_fullDump = false;	// No need for more full dumps
+	if (m_binary) {
+	    bufferFlush();
+	    m_binBlockKey = true;
+	    m_binRawSinceKey = 0;
+	}
+	if (m_ringBytes) ringSegment();
 	dumpFull(timeui);
+	if (m_ringBytes) ringFullDone();
 	return;
     }
     if (VL_UNLIKELY(m_rolloverMB && m_wroteBytes > this->m_rolloverMB)) {
@@ -578,10 +1359,19 @@ void VerilatedVcd::dump (vluint64_t timeui) {
 	VerilatedVcdCallInfo *cip = m_callbacks[ent];
 	(cip->m_changecb) (this, cip->m_userthis, cip->m_code);
     }
+#ifdef VL_THREADED
+    if (!m_subCalls.empty()) subsRun();
+#endif
     dumpDone();
 }
 
 void VerilatedVcd::dumpPrep (vluint64_t timeui) {
+    if (m_binary) {
+	*m_writep++ = 0;  // Time record
+	printTime(timeui);
+	bufferCheck();
+	return;
+    }
     printStr("#");
     printTime(timeui);
     printStr("\n");
@@ -590,20 +1380,148 @@ void VerilatedVcd::dumpPrep (vluint64_t timeui) {
 void VerilatedVcd::dumpDone () {
 }
 
+//=============================================================================
+// Parallel change functions
+//
+// With threads(), chgSub calls made by the change callbacks are queued,
+// then split into contiguous groups run on a thread pool.  Each group is
+// run by a shard, a VerilatedVcd sharing our value arrays and signal
+// tables, which writes to memory.  Sub-functions dump disjoint codes, so
+// shards never touch the same values.  The shards' output is appended to
+// our buffer in call order, giving the same file as running in order.
+
+#ifdef VL_THREADED
+void VerilatedVcd::subsMain(void* shardp) {
+    static_cast<VerilatedVcd*>(shardp)->subsShard();
+}
+
+void VerilatedVcd::subsShard() {
+    for (size_t i=m_shardBegin; i<m_shardEnd; ++i) {
+	const SubCall& call = m_shardParentp->m_subCalls[i];
+	(call.m_cb) (this, call.m_userthis, call.m_code, call.m_sub);
+    }
+    bufferFlush();
+}
+
+void VerilatedVcd::subsRun() {
+    // More groups than threads, so uneven groups still balance
+    size_t groups = min(m_subCalls.size(), (size_t)m_poolp->threads()*2);
+    while (m_shardps.size() < groups) {
+	VerilatedVcd* shardp = new VerilatedVcd;
+	shardp->m_shardParentp = this;
+	shardp->m_isOpen = true;
+	shardp->m_fd = -1;
+	m_shardps.push_back(shardp);
+    }
+    for (size_t group=0; group<groups; ++group) {
+	VerilatedVcd* shardp = m_shardps[group];
+	shardp->m_binary = m_binary;
+	shardp->m_filtered = m_filtered;
+	shardp->m_codeTracedSump = m_codeTracedSump;
+	shardp->m_sigs_oldvalp = m_sigs_oldvalp;
+	shardp->m_sigs_newvalp = m_sigs_newvalp;
+	shardp->m_shardBegin = m_subCalls.size()*group/groups;
+	shardp->m_shardEnd = m_subCalls.size()*(group+1)/groups;
+	m_poolp->addTask(&subsMain, shardp);
+    }
+    m_poolp->execute();
+    for (size_t group=0; group<groups; ++group) {
+	VerilatedVcd* shardp = m_shardps[group];
+	// Each flush ends on a value boundary, as binary blocks must
+	size_t pos = 0;
+	for (vector<size_t>::const_iterator it=shardp->m_shardCuts.begin();
+	     it!=shardp->m_shardCuts.end(); ++it) {
+	    size_t len = *it - pos;
+	    if (len > (size_t)(m_wrBufp + bufferSize() - m_writep)) bufferFlush();
+	    memcpy(m_writep, shardp->m_shardOut.data() + pos, len);
+	    m_writep += len;
+	    pos = *it;
+	    bufferCheck();
+	}
+	shardp->m_shardOut.clear();
+	shardp->m_shardCuts.clear();
+    }
+    m_subCalls.clear();
+}
+#endif
+
 //======================================================================
 // Static members
 
 void VerilatedVcd::flush_all() {
     for (vluint32_t ent = 0; ent< s_vcdVecp.size(); ent++) {
-	VerilatedVcd* vcdp = s_vcdVecp[ent];
-	vcdp->flush();
+	s_vcdVecp[ent]->flush();
+    }
+}
+
+void VerilatedVcd::trigger_all() {
+    for (vluint32_t ent = 0; ent< s_vcdVecp.size(); ent++) {
+	s_vcdVecp[ent]->trigger();
+    }
+}
+
+void VerilatedVcd::fork_all(int stage) {
+    for (vluint32_t ent = 0; ent< s_vcdVecp.size(); ent++) {
+	s_vcdVecp[ent]->forked(stage);
+    }
+}
+
+void VerilatedVcd::forked(int stage) {
+    // Fork is only available on POSIX hosts, see VerilatedSnapshot
+    if (!isOpen()) return;
+    if (stage == Verilated::FORK_PREP) {
+	flush();
+	asyncStop();  // The writer thread won't exist in the child
+	m_forkOffset = (m_fd >= 0) ? (vlsint64_t)lseek(m_fd, 0, SEEK_CUR) : -1;
+	return;
     }
+#ifndef _WIN32
+    if (stage == Verilated::FORK_REWIND && m_forkOffset >= 0) {
+	// Discard what was written since the snapshot
+	if (ftruncate(m_fd, (off_t)m_forkOffset)) {}
+	lseek(m_fd, (off_t)m_forkOffset, SEEK_SET);
+    } else if (stage == Verilated::FORK_CHILD) {
+	// Write a separate file, named by adding the process ID
+	string filename = m_filename;
+	size_t dot = filename.rfind('.');
+	size_t slash = filename.rfind('/');
+	if (dot == string::npos || (slash != string::npos && dot < slash)) dot = filename.length();
+	char pidstr[20];  sprintf(pidstr, "_%d", (int)getpid());
+	filename.insert(dot, pidstr);
+	if (m_fd >= 0) {
+	    closeErr();  // The parent's file, nothing is buffered
+	    open(filename.c_str());
+	    return;  // open restarted the writer
+	}
+	m_filename = filename;  // With ringBuffer, trigger writes this
+    }
+#endif
+    asyncStart();
 }
 
 //======================================================================
 //======================================================================
 //======================================================================
 
+#ifdef VERILATED_VCB2VCD
+// Standalone converter, see verilated_vcb_c.h
+
+double sc_time_stamp() { return 0; }
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+	fprintf(stderr, "Usage: %s <in.vcb> <out.vcd> [<start_time>]\n", argv[0]);
+	return 1;
+    }
+    vluint64_t startTime = (argc > 3) ? strtoull(argv[3], NULL, 10) : 0;
+    if (!VerilatedVcd::vcbToVcd(argv[1], argv[2], startTime)) {
+	fprintf(stderr, "%%Error: %s: Can't convert to %s\n", argv[1], argv[2]);
+	return 1;
+    }
+    return 0;
+}
+#endif
+
 #ifdef VERILATED_VCD_TEST
 vluint32_t v1, v2, s1, s2[3];
 vluint32_t tri96[3];
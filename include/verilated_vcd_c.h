@@ -30,10 +30,18 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <deque>
+#ifdef VL_THREADED
+# include <pthread.h>
+#endif
 using namespace std;
 
 class VerilatedVcd;
 class VerilatedVcdCallInfo;
+#ifdef VL_THREADED
+class VerilatedThreadPool;
+#endif
 
 // SPDIFF_ON
 //=============================================================================
@@ -43,10 +51,12 @@ class VerilatedVcdCallInfo;
 class VerilatedVcdSig {
 protected:
     friend class VerilatedVcd;
+    enum { KIND_SCALAR=1, KIND_TRI=2, KIND_DOUBLE=4, KIND_FLOAT=8 };	///< Bits of m_kind
     vluint32_t		m_code;		///< VCD file code number
     int			m_bits;		///< Size of value in bits
-    VerilatedVcdSig (vluint32_t code, int bits)
-	: m_code(code), m_bits(bits) {}
+    int			m_kind;		///< Value format, for binary files
+    VerilatedVcdSig (vluint32_t code, int bits, int kind)
+	: m_code(code), m_bits(bits), m_kind(kind) {}
 public:
     ~VerilatedVcdSig() {}
 };
@@ -54,6 +64,7 @@ public:
 //=============================================================================
 
 typedef void (*VerilatedVcdCallback_t)(VerilatedVcd* vcdp, void* userthis, vluint32_t code);
+typedef void (*VerilatedVcdSubCallback_t)(VerilatedVcd* vcdp, void* userthis, vluint32_t code, int sub);
 
 //=============================================================================
 // VerilatedVcd
@@ -64,6 +75,7 @@ class VerilatedVcd {
 private:
     bool 		m_isOpen;	///< True indicates open file
     bool		m_evcd;		///< True for evcd format
+    bool		m_binary;	///< True for binary (VCB) format
     int			m_fd;		///< File descriptor we're writing to
     string		m_filename;	///< Filename we're writing to (if open)
     vluint64_t		m_rolloverMB;	///< MB of file size to rollover at
@@ -79,9 +91,72 @@ private:
     char*		m_wrBufp;	///< Output buffer
     char*		m_writep;	///< Write pointer into output buffer
     vluint64_t		m_wroteBytes;	///< Number of bytes written to this file
+    vlsint64_t		m_forkOffset;	///< File offset when last forked, or -1
+    size_t		m_asyncBuffers;	///< Buffers for background writing, <2 = synchronous
+#ifdef VL_THREADED
+    bool		m_asyncRunning;	///< Writer thread is started
+    pthread_t		m_asyncThread;	///< Writer thread
+    // Below protected by m_asyncMutex
+    pthread_mutex_t	m_asyncMutex;
+    pthread_cond_t	m_asyncCond;	///< Signaled when a buffer is queued or written, or exiting
+    deque<pair<char*,size_t> >	m_asyncFull;	///< Filled buffers awaiting the writer
+    vector<char*>	m_asyncFree;	///< Written buffers available for filling
+    bool		m_asyncBusy;	///< Writer is writing a buffer
+    bool		m_asyncExit;	///< Writer should return once m_asyncFull is empty
+    int			m_asyncErrno;	///< Writer's error, or -1 once reported
+#endif
+
+    // Binary format state, see "Binary format" in verilated_vcd_c.cpp
+    bool		m_binHeaderMode;	///< Capturing dumpHeader text into m_binHeaderText
+    bool		m_binRawMode;	///< Buffer holds file bytes, not values to make a block
+    bool		m_binBlockKey;	///< Buffer's values started with a full dump
+    vluint64_t		m_binBlockTime;	///< Time at start of buffer's values
+    vluint64_t		m_binRawSinceKey;	///< Uncompressed value bytes since last key block
+    char*		m_binBufp;	///< Block being compressed, swapped with m_wrBufp
+    string		m_binHeader;	///< Magic and header block, written at start of each file
+    string		m_binHeaderText;	///< VCD declarations captured from dumpHeader
+    vector<vluint32_t>	m_binHash;	///< Compression match table
+    vector<pair<vluint64_t,vluint64_t> >	m_binIndex;	///< Time and file offset of key blocks
+
+    // Ring buffer state, see "Ring buffer" in verilated_vcd_c.cpp
+    size_t		m_ringBytes;	///< Bytes of values to keep in memory, 0 = write file
+    string		m_ringHeader;	///< Declarations from dumpHeader
+    deque<string>	m_ringSegs;	///< Values, each segment starting with a full dump
+    size_t		m_ringUsed;	///< Bytes in m_ringSegs
+    size_t		m_ringFullBytes;	///< Bytes of the largest full dump
+    bool		m_ringDumped;	///< Values recorded since last trigger
+    int			m_ringTriggers;	///< Windows written, to name files
+
+    // Parallel change state, see "Parallel change functions" in verilated_vcd_c.cpp
+    int			m_threads;	///< Threads to run chgSub functions, <2 = in order
+#ifdef VL_THREADED
+    struct SubCall {
+	VerilatedVcdSubCallback_t	m_cb;
+	void*		m_userthis;
+	vluint32_t	m_code;
+	int		m_sub;
+    };
+    VerilatedThreadPool*	m_poolp;	///< Workers running chgSub functions, or NULL
+    vector<SubCall>	m_subCalls;	///< chgSub calls deferred in this dump
+    vector<VerilatedVcd*>	m_shardps;	///< Writers for groups of m_subCalls
+    VerilatedVcd*	m_shardParentp;	///< For a shard, trace whose values it shares
+    size_t		m_shardBegin;	///< For a shard, first m_subCalls entry to run
+    size_t		m_shardEnd;	///< For a shard, m_subCalls entry after the last to run
+    string		m_shardOut;	///< For a shard, flushed output
+    vector<size_t>	m_shardCuts;	///< For a shard, ends of each flush in m_shardOut
+#endif
 
     vluint32_t*			m_sigs_oldvalp;	///< Pointer to old signal values
+    vluint32_t*			m_sigs_newvalp;	///< Pointer to values from stage routines
     vector<VerilatedVcdSig>	m_sigs;		///< Pointer to signal information
+    vector<vluint32_t>		m_codeSigs;	///< Index into m_sigs for each code, for chgStaged
+    vector<string>		m_scopeIncludes;	///< Patterns of scopes to trace, empty = all
+    vector<string>		m_scopeExcludes;	///< Patterns of scopes not to trace
+    bool			m_filtered;	///< Some scopes are not traced
+    map<string,bool>		m_scopeTraced;	///< Cache of scopeTraced results
+    vector<char>		m_codeTraced;	///< Code is declared in a traced scope
+    vector<vluint32_t>		m_codeTracedSum;	///< Traced codes below each code
+    const vluint32_t*		m_codeTracedSump;	///< m_codeTracedSum, or the parent's for a shard
     vector<VerilatedVcdCallInfo*>	m_callbacks;	///< Routines to perform dumping
     typedef map<string,string>	NameMap;
     NameMap*			m_namemapp;	///< List of names for the header
@@ -89,7 +164,11 @@ private:
 
     inline static size_t bufferSize() { return 256*1024; }  // See below for slack calculation
     inline static size_t bufferInsertSize() { return 16*1024; }
+    inline static size_t bufferAllocSize() { return bufferSize()+64; }  // Slack for binary block header
+    inline static size_t binKeyInterval() { return 16*1024*1024; }  // Value bytes between key blocks
     void bufferFlush();
+    void bufferError(int err);
+    static int bufferWrite(int fd, const char* bufp, size_t len);
     void bufferCheck() {
 	// Flush the write buffer if there's not enough space left for new information
 	// We only call this once per vector, so we need enough slop for a very wide "b###" line
@@ -99,9 +178,34 @@ private:
     }
     void closePrev();
     void closeErr();
+#ifdef VL_THREADED
+    static void* asyncMain(void* vcdp);
+    void asyncWriter();
+    void asyncHandoff();
+#endif
+    void asyncStart();
+    void asyncDrain();
+    void asyncStop();
+    void binaryHeader();
+    void binaryBlock();
+    void binaryClose();
+    size_t binaryBlockFormat(char* outp, char type, vluint64_t timeui, const char* rawp, size_t rawLen);
+    void printRaw (const char* datap, size_t len);
     void openNext();
+    static string catFilename (const string& filename);
+    void forked (int stage);
+    void ringFlush();
+    void ringSegment();
+    void ringFullDone();
+    size_t ringSegBytes() const;
+#ifdef VL_THREADED
+    static void subsMain(void* shardp);
+    void subsShard();
+    void subsRun();
+#endif
     void makeNameMap();
     void deleteNameMap();
+    bool scopeTraced (const string& scope);
     void printIndent (int levelchange);
     void printStr (const char* str);
     void printQuad (vluint64_t n);
@@ -120,6 +224,17 @@ private:
 	if (code>=(94))       *m_writep++ = ((char)((code/94)%94+33));
 	*m_writep++ = ((char)((code)%94+33));
     }
+    inline void binVarint (vluint64_t n) {
+	while (n >= 0x80) { *m_writep++ = (char)(n | 0x80); n >>= 7; }
+	*m_writep++ = (char)n;
+    }
+    inline void binCode (vluint32_t code, bool isX) { binVarint((((vluint64_t)code)<<1) | (isX?1:0)); }
+    inline void binBytes (vluint64_t val, int bits) {	// Little endian
+	for (int bit=0; bit<bits; bit+=8) *m_writep++ = (char)(val >> bit);
+    }
+    inline bool codeOff (vluint32_t code) const {  // Value not to be printed
+	return VL_UNLIKELY(m_filtered) && m_codeTracedSump[code+1] == m_codeTracedSump[code];
+    }
     static string stringCode (vluint32_t code) {
 	string out;
 	if (code>=(94*94*94)) out += ((char)((code/94/94/94)%94+33));
@@ -135,15 +250,43 @@ protected:
 public:
     // CREATORS
     VerilatedVcd () : m_isOpen(false), m_rolloverMB(0), m_modDepth(0), m_nextCode(1) {
-	m_wrBufp = new char [bufferSize()];
+	m_wrBufp = new char [bufferAllocSize()];
 	m_writep = m_wrBufp;
 	m_namemapp = NULL;
 	m_timeRes = m_timeUnit = 1e-9;
 	m_timeLastDump = 0;
 	m_sigs_oldvalp = NULL;
+	m_sigs_newvalp = NULL;
 	m_evcd = false;
+	m_binary = false;
+	m_binHeaderMode = false;
+	m_binRawMode = false;
+	m_binBlockKey = false;
+	m_binBlockTime = 0;
+	m_binRawSinceKey = 0;
+	m_binBufp = NULL;
+	m_ringBytes = 0;
+	m_ringUsed = 0;
+	m_ringFullBytes = 0;
+	m_ringDumped = false;
+	m_ringTriggers = 0;
+	m_filtered = false;
+	m_codeTracedSump = NULL;
+	m_threads = 0;
+#ifdef VL_THREADED
+	m_poolp = NULL;
+	m_shardParentp = NULL;
+	m_shardBegin = m_shardEnd = 0;
+#endif
 	m_scopeEscape = '.';  // Backward compatibility
 	m_wroteBytes = 0;
+	m_forkOffset = -1;
+	m_asyncBuffers = 0;
+#ifdef VL_THREADED
+	m_asyncRunning = false;
+	pthread_mutex_init(&m_asyncMutex, NULL);
+	pthread_cond_init(&m_asyncCond, NULL);
+#endif
 	m_fd = 0;
 	m_fullDump = true;
     }
@@ -154,6 +297,19 @@ public:
     vluint32_t nextCode() const {return m_nextCode;}
     /// Set size in megabytes after which new file should be created
     void rolloverMB(vluint64_t rolloverMB) { m_rolloverMB=rolloverMB; };
+    /// Set number of buffers to write from a background thread; call before open
+    void asyncBuffers(size_t buffers) { m_asyncBuffers=buffers; }
+    /// Write binary (VCB) format rather than VCD; call before open
+    void binary(bool flag) { m_binary = flag; }
+    /// Record values in memory rather than the file, keeping about the
+    /// given number of bytes; call before open
+    void ringBuffer(size_t bytes) { m_ringBytes = bytes; }
+    /// Trace only scopes matching any such pattern, and their submodules; call before open
+    void scopeInclude(const string& pattern) { m_scopeIncludes.push_back(pattern); }
+    /// Don't trace scopes matching the pattern, or their submodules; call before open
+    void scopeExclude(const string& pattern) { m_scopeExcludes.push_back(pattern); }
+    /// Set number of threads to run chgSub functions; call before open
+    void threads(int threads) { m_threads = threads; }
     /// Is file open?
     bool isOpen() const { return m_isOpen; }
     /// Change character that splits scopes.  Note whitespace are ALWAYS escapes.
@@ -164,8 +320,13 @@ public:
     // METHODS
     void open (const char* filename);	///< Open the file; call isOpen() to see if errors
     void openNext (bool incFilename);	///< Open next data-only file
-    void flush() { bufferFlush(); }	///< Flush any remaining data
+    void flush();			///< Flush any remaining data
+    void trigger();			///< With ringBuffer, write the recorded values to the file
     static void flush_all();		///< Flush any remaining data from all files
+    static void trigger_all();		///< With ringBuffer, write the recorded values of all files
+    static void fork_all(int stage);	///< Prepare or recover all files for a Verilated::forkCall
+    /// Convert binary (VCB) file to VCD, starting at the last key block at or before startTime
+    static bool vcbToVcd (const char* vcbFilename, const char* vcdFilename, vluint64_t startTime=0);
     void close ();			///< Close the file
 
     void set_time_unit (const char* unit); ///< Set time units (s/ms, defaults to ns)
@@ -202,15 +363,25 @@ public:
     void declFloat    (vluint32_t code, const char* name, int arraynum);
     //	... other module_start for submodules (based on cell name)
 
+    /// Inside dumping routines, true if any code in [code,endCode) is traced;
+    /// if false, the dumping routines need not be called for those codes
+    inline bool anyTraced (vluint32_t code, vluint32_t endCode) const {
+	return m_codeTracedSump[endCode] != m_codeTracedSump[code];
+    }
+
     /// Inside dumping routines, dump one signal
     void fullBit (vluint32_t code, const vluint32_t newval) {
 	// Note the &1, so we don't require clean input -- makes more common no change case faster
 	m_sigs_oldvalp[code] = newval;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,1); bufferCheck(); return; }
 	*m_writep++=('0'+(char)(newval&1)); printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     void fullBus (vluint32_t code, const vluint32_t newval, int bits) {
 	m_sigs_oldvalp[code] = newval;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,bits); bufferCheck(); return; }
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++=((newval&(1L<<bit))?'1':'0');
@@ -220,6 +391,8 @@ public:
     }
     void fullQuad (vluint32_t code, const vluint64_t newval, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,bits); bufferCheck(); return; }
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++=((newval&(1ULL<<bit))?'1':'0');
@@ -231,6 +404,13 @@ public:
 	for (int word=0; word<(((bits-1)/32)+1); ++word) {
 	    m_sigs_oldvalp[code+word] = newval[word];
 	}
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) {
+	    binCode(code,false);
+	    for (int word=0; word<(((bits-1)/32)+1); ++word) binBytes(newval[word], min(32,bits-word*32));
+	    bufferCheck();
+	    return;
+	}
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++=((newval[(bit/32)]&(1L<<(bit&0x1f)))?'1':'0');
@@ -241,6 +421,8 @@ public:
     void fullTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
 	m_sigs_oldvalp[code]   = newval;
 	m_sigs_oldvalp[code+1] = newtri;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,1); binBytes(newtri,1); bufferCheck(); return; }
 	*m_writep++ = "01zz"[m_sigs_oldvalp[code]
 			     | (m_sigs_oldvalp[code+1]<<1)];
 	printCode(code); *m_writep++='\n';
@@ -249,6 +431,8 @@ public:
     void fullTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
 	m_sigs_oldvalp[code] = newval;
 	m_sigs_oldvalp[code+1] = newtri;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,bits); binBytes(newtri,bits); bufferCheck(); return; }
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++ = "01zz"[((newval >> bit)&1)
@@ -260,6 +444,8 @@ public:
     void fullTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
 	(*((vluint64_t*)&m_sigs_oldvalp[code+1])) = newtri;
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,false); binBytes(newval,bits); binBytes(newtri,bits); bufferCheck(); return; }
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++ = "01zz"[((newval >> bit)&1ULL)
@@ -273,6 +459,14 @@ public:
 	    m_sigs_oldvalp[code+word*2]   = newvalp[word];
 	    m_sigs_oldvalp[code+word*2+1] = newtrip[word];
 	}
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) {
+	    binCode(code,false);
+	    for (int word=0; word<(((bits-1)/32)+1); ++word) binBytes(newvalp[word], min(32,bits-word*32));
+	    for (int word=0; word<(((bits-1)/32)+1); ++word) binBytes(newtrip[word], min(32,bits-word*32));
+	    bufferCheck();
+	    return;
+	}
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    vluint32_t valbit = (newvalp[(bit/32)]>>(bit&0x1f)) & 1;
@@ -290,10 +484,14 @@ public:
     /// Thus this is for special standalone applications that after calling
     /// fullBitX, must when then value goes non-X call fullBit.
     inline void fullBitX (vluint32_t code) {
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,true); bufferCheck(); return; }
 	*m_writep++='x'; printCode(code); *m_writep++='\n';
 	bufferCheck();
     }
     inline void fullBusX (vluint32_t code, int bits) {
+	if (VL_UNLIKELY(codeOff(code))) return;
+	if (VL_UNLIKELY(m_binary)) { binCode(code,true); bufferCheck(); return; }
 	*m_writep++='b';
 	for (int bit=bits-1; bit>=0; --bit) {
 	    *m_writep++='x';
@@ -304,6 +502,43 @@ public:
     inline void fullQuadX (vluint32_t code, int bits) { fullBusX (code, bits); }
     inline void fullArrayX (vluint32_t code, int bits) { fullBusX (code, bits); }
 
+    /// Inside dumping routines, record one signal's value for chgStaged.
+    /// Every code in the range passed to chgStaged must be staged first.
+    inline void stageBit (vluint32_t code, const vluint32_t newval) {
+	m_sigs_newvalp[code] = newval;
+    }
+    inline void stageBus (vluint32_t code, const vluint32_t newval, int) {
+	m_sigs_newvalp[code] = newval;
+    }
+    inline void stageQuad (vluint32_t code, const vluint64_t newval, int) {
+	(*((vluint64_t*)&m_sigs_newvalp[code])) = newval;
+    }
+    inline void stageArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    m_sigs_newvalp[code+word] = newval[word];
+	}
+    }
+    inline void stageDouble (vluint32_t code, const double newval) {
+	(*((double*)&m_sigs_newvalp[code])) = newval;
+    }
+    /// Inside dumping routines, dump signals in codes [code,endCode) whose
+    /// staged value differs from the old value
+    void chgStaged (vluint32_t code, vluint32_t endCode);
+
+    /// Inside dumping routines, call a change sub-function.  Each sub-function
+    /// must dump codes no other does.  With threads, the call is deferred to
+    /// run on a worker once the dump's callbacks return.
+    inline void chgSub (VerilatedVcdSubCallback_t cb, void* userthis, vluint32_t code, int sub) {
+#ifdef VL_THREADED
+	if (m_poolp) {
+	    SubCall call;  call.m_cb = cb;  call.m_userthis = userthis;  call.m_code = code;  call.m_sub = sub;
+	    m_subCalls.push_back(call);
+	    return;
+	}
+#endif
+	cb(this, userthis, code, sub);
+    }
+
     /// Inside dumping routines, dump one signal if it has changed
     inline void chgBit (vluint32_t code, const vluint32_t newval) {
 	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
@@ -411,6 +646,35 @@ public:
     void openNext (bool incFilename=true) { m_sptrace.openNext(incFilename); }
     /// Set size in megabytes after which new file should be created
     void rolloverMB(size_t rolloverMB) { m_sptrace.rolloverMB(rolloverMB); };
+    /// Write the file from a background thread, with the given number
+    /// of 256KB buffers (at least 2) queued between the simulation and
+    /// the writer.  The simulation only waits when all buffers are full.
+    /// Requires VL_THREADED, else ignored.  Must be called before open.
+    void asyncBuffers(size_t buffers) { m_sptrace.asyncBuffers(buffers); }
+    /// Keep about the given number of bytes of the most recent VCD value
+    /// changes in memory, rather than writing the file.  The file is only
+    /// written by trigger(), or when Verilated::errorCall() is made by
+    /// $stop, a failed assertion or vl_fatal.  The file then holds the
+    /// header, a full dump at the start of the window, and the changes
+    /// since.  Later triggers write filename_cat0000.vcd and so on.  VCD
+    /// format only; asyncBuffers and rolloverMB are ignored.  Must be
+    /// called before open.
+    void ringBuffer(size_t bytes) { m_sptrace.ringBuffer(bytes); }
+    /// With ringBuffer, write the recorded window to the file
+    void trigger() { m_sptrace.trigger(); }
+    /// Trace only scopes matching the pattern, and their submodules.
+    /// Patterns are dotted hierarchical names with * and ? wildcards,
+    /// e.g. "top.v.core*".  When called multiple times, scopes matching
+    /// any pattern are traced.  Must be called before open.
+    void scopeInclude(const string& pattern) { m_sptrace.scopeInclude(pattern); }
+    /// Don't trace scopes matching the pattern, or their submodules, even
+    /// if included.  Must be called before open.
+    void scopeExclude(const string& pattern) { m_sptrace.scopeExclude(pattern); }
+    /// Evaluate the model's trace change functions on the given number of
+    /// threads, each writing its own buffer.  The buffers are appended in
+    /// order, so the file is unchanged.  Requires VL_THREADED, else
+    /// ignored.  Must be called before open.
+    void threads(int threads) { m_sptrace.threads(threads); }
     /// Close dump
     void close() { m_sptrace.close(); }
     /// Flush dump
@@ -54,6 +54,7 @@
 #include <set>
 #include <list>
 #include <map>
+#include <vector>
 
 #define VL_DEBUG_IF_PLI VL_DEBUG_IF
 #define VL_VPI_LINE_SIZE 8192
@@ -72,7 +73,7 @@ public:
 	// To simplify our free list, we use a size large enough for all derived types
 	// We reserve word zero for the next pointer, as that's safer in case a
 	// dangling reference to the original remains around.
-	static size_t chunk = 96;
+	static size_t chunk = 112;
 	if (VL_UNLIKELY(size>chunk)) vl_fatal(__FILE__,__LINE__,"", "increase chunk");
 	if (VL_LIKELY(s_freeHead)) {
 	    vluint8_t* newp = s_freeHead;
@@ -104,14 +105,22 @@ public:
 
 typedef PLI_INT32 (*VerilatedPliCb)(struct t_cb_data *);
 
+class VerilatedVpioCb;
+typedef multimap<QData,VerilatedVpioCb*> VerilatedVpioTimedCbs;  // Equal times stay in insertion order
+
 class VerilatedVpioCb : public VerilatedVpio {
     t_cb_data		m_cbData;
     s_vpi_value		m_value;
     QData		m_time;
+    vluint32_t		m_watch;	// cbValueChange: index of watched value, or NO_WATCH
+    vluint32_t		m_watchSlot;	// cbValueChange: position in that value's callbacks
+    bool		m_timedPending;	// cbAfterDelay: in the timed list, at m_timedIt
+    VerilatedVpioTimedCbs::iterator m_timedIt;	// cbAfterDelay: position in the timed list
 public:
+    static const vluint32_t NO_WATCH = ~0U;
     // cppcheck-suppress uninitVar  // m_value
     VerilatedVpioCb(const t_cb_data* cbDatap, QData time)
-	: m_cbData(*cbDatap), m_time(time) {
+	: m_cbData(*cbDatap), m_time(time), m_watch(NO_WATCH), m_watchSlot(0), m_timedPending(false) {
         m_value.format = cbDatap->value ? cbDatap->value->format : vpiSuppressVal;
 	m_cbData.value = &m_value;
     }
@@ -122,6 +131,13 @@ public:
     VerilatedPliCb cb_rtnp() const { return m_cbData.cb_rtn; }
     t_cb_data* cb_datap() { return &(m_cbData); }
     QData time() const { return m_time; }
+    vluint32_t watch() const { return m_watch; }
+    vluint32_t watchSlot() const { return m_watchSlot; }
+    void watch(size_t index, size_t slot) { m_watch=index; m_watchSlot=slot; }
+    bool timedPending() const { return m_timedPending; }
+    VerilatedVpioTimedCbs::iterator timedIt() const { return m_timedIt; }
+    void timedIt(VerilatedVpioTimedCbs::iterator it) { m_timedIt=it; m_timedPending=true; }
+    void timedDone() { m_timedPending=false; }
 };
 
 class VerilatedVpioConst : public VerilatedVpio {
@@ -173,7 +189,6 @@ public:
 class VerilatedVpioVar : public VerilatedVpio {
     const VerilatedVar*		m_varp;
     const VerilatedScope*	m_scopep;
-    vluint8_t*			m_prevDatap;	// Previous value of data, for cbValueChange
     union {
 	vluint8_t u8[4];
 	vluint32_t u32;
@@ -185,14 +200,11 @@ protected:
 public:
     VerilatedVpioVar(const VerilatedVar* varp, const VerilatedScope* scopep)
 	: m_varp(varp), m_scopep(scopep), m_index(0) {
-	m_prevDatap = NULL;
 	m_mask.u32 = VL_MASK_I(varp->range().elements());
 	m_entSize = varp->entSize();
 	m_varDatap = varp->datap();
     }
-    virtual ~VerilatedVpioVar() {
-	if (m_prevDatap) { delete [] m_prevDatap; m_prevDatap = NULL; }
-    }
+    virtual ~VerilatedVpioVar() {}
     static inline VerilatedVpioVar* castp(vpiHandle h) { return dynamic_cast<VerilatedVpioVar*>((VerilatedVpio*)h); }
     const VerilatedVar* varp() const { return m_varp; }
     const VerilatedScope* scopep() const { return m_scopep; }
@@ -210,14 +222,7 @@ public:
 	out = string(m_scopep->name())+"."+name();
 	return out.c_str();
     }
-    void* prevDatap() const { return m_prevDatap; }
     void* varDatap() const { return m_varDatap; }
-    void createPrevDatap() {
-	if (VL_UNLIKELY(!m_prevDatap)) {
-	    m_prevDatap = new vluint8_t [entSize()];
-	    memcpy(prevDatap(), varp()->datap(), entSize());
-	}
-    }
 };
 
 class VerilatedVpioMemoryWord : public VerilatedVpioVar {
@@ -269,15 +274,17 @@ class VerilatedVpioMemoryWordIter : public VerilatedVpio {
     const vpiHandle		m_handle;
     const VerilatedVar*		m_varp;
     vlsint32_t                  m_iteration;
-    vlsint32_t                  m_direction;
     bool                        m_done;
 public:
+    // Words are visited from the lowest index up, whichever way the array was declared
     VerilatedVpioMemoryWordIter(const vpiHandle handle, const VerilatedVar* varp)
-	: m_handle(handle), m_varp(varp), m_iteration(varp->array().right()), m_direction(VL_LIKELY(varp->array().left()>varp->array().right())?1:-1), m_done(false) {  }
+	: m_handle(handle), m_varp(varp), m_iteration(low()), m_done(false) {  }
     virtual ~VerilatedVpioMemoryWordIter() {}
     static inline VerilatedVpioMemoryWordIter* castp(vpiHandle h) { return dynamic_cast<VerilatedVpioMemoryWordIter*>((VerilatedVpio*)h); }
     virtual const vluint32_t type() { return vpiIterator; }
-    void iterationInc() { if (!(m_done = m_iteration == m_varp->array().left())) m_iteration+=m_direction; }
+    int low() const { return VL_LIKELY(m_varp->array().left()>m_varp->array().right()) ? m_varp->array().right() : m_varp->array().left(); }
+    int high() const { return VL_LIKELY(m_varp->array().left()>m_varp->array().right()) ? m_varp->array().left() : m_varp->array().right(); }
+    void iterationInc() { if (!(m_done = m_iteration == high())) ++m_iteration; }
     virtual vpiHandle dovpi_scan() {
 	vpiHandle result;
 	if (m_done) return 0;
@@ -289,69 +296,196 @@ public:
 
 //======================================================================
 
-struct VerilatedVpiTimedCbsCmp {
-    /// Ordering sets keyed by time, then callback descriptor
-    bool operator() (const pair<QData,VerilatedVpioCb*>& a,
-		     const pair<QData,VerilatedVpioCb*>& b) const {
-	if (a.first < b.first) return 1;
-	if (a.first > b.first) return 0;
-	return a.second < b.second;
-    }
-};
-
 class VerilatedVpiError;
 
 class VerilatedVpi {
     enum { CB_ENUM_MAX_VALUE = cbAtEndOfSimTime+1 };	// Maxium callback reason
     typedef list<VerilatedVpioCb*> VpioCbList;
-    typedef set<pair<QData,VerilatedVpioCb*>,VerilatedVpiTimedCbsCmp > VpioTimedCbs;
+    typedef vector<VerilatedVpioCb*> VpioCbVec;
+    typedef VerilatedVpioTimedCbs VpioTimedCbs;
+    typedef map<pair<void*,vluint32_t>,size_t> VpioWatchIndex;
 
     struct product_info {
 	PLI_BYTE8* product;
 	PLI_BYTE8* version;
     };
 
+    struct VpioWatch {
+	// A value with cbValueChange callbacks
+	vluint8_t*	m_datap;	// Current value
+	vluint32_t	m_size;		// Bytes in value
+	vluint32_t	m_prevIndex;	// Index of previous value in m_watchPrevs
+    };
+
     VpioCbList		m_cbObjLists[CB_ENUM_MAX_VALUE];	// Callbacks for each supported reason
-    VpioTimedCbs	m_timedCbs;	// Time based callbacks
+    VpioTimedCbs	m_timedCbs;	// Time based callbacks not yet called
     VerilatedVpiError*  m_errorInfop;	// Container for vpi error info
+    // cbValueChange callbacks are grouped by the value they watch, so each
+    // value is compared once, and only changed values look at callbacks
+    vector<VpioWatch>	m_watches;	// Each watched value, compared every callValueCbs
+    vector<VpioCbVec>	m_watchCbs;	// Callbacks of each m_watches entry, NULL if removed in callValueCbs
+    vector<vluint64_t>	m_watchPrevs;	// Previous values of all watches, word aligned
+    VpioWatchIndex	m_watchIndex;	// Value pointer and size to m_watches index
+    vector<size_t>	m_dirtyWatches;	// Watches changed this call, kept to avoid allocation
+    vector<size_t>	m_nulledWatches; // Watches with callbacks removed inside callValueCbs
+    size_t		m_deadWatches;	// Watches without callbacks, dropped by watchCompact
+    bool		m_inValueCbs;	// Inside callValueCbs, so can't move callbacks
 
     static VerilatedVpi s_s;		// Singleton
 
+    static inline bool watchChanged(const VpioWatch& w, const vluint64_t* prevsp) {
+	const vluint8_t* prevp = (const vluint8_t*)(prevsp + w.m_prevIndex);
+	switch (w.m_size) {
+	case 1: return *(const CData*)w.m_datap != *(const CData*)prevp;
+	case 2: return *(const SData*)w.m_datap != *(const SData*)prevp;
+	case 4: return *(const IData*)w.m_datap != *(const IData*)prevp;
+	case 8: return memcmp(w.m_datap, prevp, 8) != 0;
+	default: return memcmp(w.m_datap, prevp, w.m_size) != 0;
+	}
+    }
+    static void watchSave(const VpioWatch& w) {
+	memcpy(&s_s.m_watchPrevs[w.m_prevIndex], w.m_datap, w.m_size);
+    }
+    static void cbValueAdd(VerilatedVpioCb* vop) {
+	VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj);
+	if (!varop) return;  // Never called
+	pair<void*,vluint32_t> key (varop->varDatap(), varop->entSize());
+	VpioWatchIndex::iterator it = s_s.m_watchIndex.find(key);
+	size_t index;
+	if (it != s_s.m_watchIndex.end()) {
+	    // Dead watches are still compared and saved, so the previous value is current
+	    index = it->second;
+	    if (s_s.m_watchCbs[index].empty()) --s_s.m_deadWatches;
+	} else {
+	    index = s_s.m_watches.size();
+	    VpioWatch w;
+	    w.m_datap = (vluint8_t*)varop->varDatap();
+	    w.m_size = varop->entSize();
+	    w.m_prevIndex = s_s.m_watchPrevs.size();
+	    s_s.m_watchPrevs.resize(s_s.m_watchPrevs.size() + (w.m_size+7)/8);
+	    watchSave(w);
+	    s_s.m_watches.push_back(w);
+	    s_s.m_watchCbs.push_back(VpioCbVec());
+	    s_s.m_watchIndex.insert(make_pair(key, index));
+	}
+	vop->watch(index, s_s.m_watchCbs[index].size());
+	s_s.m_watchCbs[index].push_back(vop);
+    }
+    static void cbValueRemove(VerilatedVpioCb* cbp) {
+	size_t index = cbp->watch();
+	if (index == VerilatedVpioCb::NO_WATCH) return;  // Never added, or already removed
+	size_t slot = cbp->watchSlot();
+	cbp->watch(VerilatedVpioCb::NO_WATCH, 0);
+	VpioCbVec& cbs = s_s.m_watchCbs[index];
+	if (s_s.m_inValueCbs) {
+	    // callValueCbs is walking the slots, so leave a hole for watchSweep
+	    cbs[slot] = NULL;
+	    s_s.m_nulledWatches.push_back(index);
+	    return;
+	}
+	// Move the last callback into the slot; callback order within a value isn't defined
+	if (slot != cbs.size()-1) {
+	    cbs[slot] = cbs.back();
+	    cbs[slot]->watch(index, slot);
+	}
+	cbs.pop_back();
+	if (cbs.empty()) {
+	    ++s_s.m_deadWatches;
+	    if (watchCompactDue()) watchCompact();
+	}
+    }
+    static void watchSweep() {
+	// Close the holes left by removals inside callValueCbs
+	for (vector<size_t>::iterator it=s_s.m_nulledWatches.begin(); it!=s_s.m_nulledWatches.end(); ++it) {
+	    VpioCbVec& cbs = s_s.m_watchCbs[*it];
+	    size_t out = 0;
+	    for (size_t i=0; i<cbs.size(); ++i) {
+		if (!cbs[i]) continue;
+		cbs[out] = cbs[i];
+		cbs[out]->watch(*it, out);
+		++out;
+	    }
+	    if (out == cbs.size()) continue;  // Listed twice, already swept
+	    cbs.resize(out);
+	    if (cbs.empty()) ++s_s.m_deadWatches;
+	}
+	s_s.m_nulledWatches.clear();
+    }
+    static bool watchCompactDue() {
+	// Dead watches cost a compare each call; dropping them costs a pass
+	// over all watches, so wait until they are a large fraction
+	return s_s.m_deadWatches >= 8 && s_s.m_deadWatches*2 > s_s.m_watches.size();
+    }
+    static void watchCompact() {
+	// Drop watches without callbacks, moving the rest down in place
+	size_t out = 0;
+	vluint32_t prevOut = 0;
+	for (size_t i=0; i<s_s.m_watches.size(); ++i) {
+	    VpioWatch w = s_s.m_watches[i];
+	    pair<void*,vluint32_t> key ((void*)w.m_datap, w.m_size);
+	    if (s_s.m_watchCbs[i].empty()) {
+		s_s.m_watchIndex.erase(key);
+		continue;
+	    }
+	    vluint32_t words = (w.m_size+7)/8;
+	    if (out != i) {
+		memmove(&s_s.m_watchPrevs[prevOut], &s_s.m_watchPrevs[w.m_prevIndex], words*8);
+		w.m_prevIndex = prevOut;
+		s_s.m_watches[out] = w;
+		s_s.m_watchCbs[out].swap(s_s.m_watchCbs[i]);
+		s_s.m_watchIndex[key] = out;
+		VpioCbVec& cbs = s_s.m_watchCbs[out];
+		for (size_t c=0; c<cbs.size(); ++c) cbs[c]->watch(out, c);
+	    }
+	    prevOut += words;
+	    ++out;
+	}
+	s_s.m_watches.resize(out);
+	s_s.m_watchCbs.resize(out);
+	s_s.m_watchPrevs.resize(prevOut);
+	s_s.m_deadWatches = 0;
+    }
+
 public:
-    VerilatedVpi() { m_errorInfop=NULL; }
+    VerilatedVpi() { m_errorInfop=NULL; m_deadWatches=0; m_inValueCbs=false; }
     ~VerilatedVpi() {}
     static void cbReasonAdd(VerilatedVpioCb* vop) {
+	if (VL_UNLIKELY(vop->reason() >= CB_ENUM_MAX_VALUE)) vl_fatal(__FILE__,__LINE__,"", "vpi bb reason too large");
 	if (vop->reason() == cbValueChange) {
-	    if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
-		varop->createPrevDatap();
-	    }
+	    cbValueAdd(vop);
+	    return;
 	}
-	if (VL_UNLIKELY(vop->reason() >= CB_ENUM_MAX_VALUE)) vl_fatal(__FILE__,__LINE__,"", "vpi bb reason too large");
 	s_s.m_cbObjLists[vop->reason()].push_back(vop);
     }
     static void cbTimedAdd(VerilatedVpioCb* vop) {
-	s_s.m_timedCbs.insert(make_pair(vop->time(), vop));
+	vop->timedIt(s_s.m_timedCbs.insert(make_pair(vop->time(), vop)));
     }
     static void cbReasonRemove(VerilatedVpioCb* cbp) {
+	if (cbp->reason() == cbValueChange) {
+	    cbValueRemove(cbp);
+	    return;
+	}
 	VpioCbList& cbObjList = s_s.m_cbObjLists[cbp->reason()];
         cbObjList.remove(cbp);
     }
     static void cbTimedRemove(VerilatedVpioCb* cbp) {
-	VpioTimedCbs::iterator it=s_s.m_timedCbs.find(make_pair(cbp->time(),cbp));
-	if (VL_LIKELY(it != s_s.m_timedCbs.end())) {
-	    s_s.m_timedCbs.erase(it);
-	}
+	if (!cbp->timedPending()) return;  // Already called, or never added
+	s_s.m_timedCbs.erase(cbp->timedIt());
+	cbp->timedDone();
     }
     static void callTimedCbs() {
+	// Call the expired callbacks, earliest first.  Each is removed before
+	// it is called, so callbacks may add or remove others, and those added
+	// for the current time are called in this pass.
 	QData time = VL_TIME_Q();
-	for (VpioTimedCbs::iterator it=s_s.m_timedCbs.begin(); it!=s_s.m_timedCbs.end(); ) {
-	    if (VL_UNLIKELY(it->first <= time)) {
-		VerilatedVpioCb* vop = it->second;
-		++it;  // iterator may be deleted by callback
-		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  timed_callback %p\n",vop););
-		(vop->cb_rtnp()) (vop->cb_datap());
-	    }
-	    else { ++it; }
+	while (!s_s.m_timedCbs.empty()) {
+	    VpioTimedCbs::iterator it = s_s.m_timedCbs.begin();
+	    if (VL_LIKELY(it->first > time)) break;
+	    VerilatedVpioCb* vop = it->second;
+	    s_s.m_timedCbs.erase(it);
+	    vop->timedDone();
+	    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  timed_callback %p\n",vop););
+	    (vop->cb_rtnp()) (vop->cb_datap());
 	}
     }
     static QData cbNextDeadline() {
@@ -372,34 +506,94 @@ public:
 	}
     }
     static void callValueCbs() {
-	VpioCbList& cbObjList = s_s.m_cbObjLists[cbValueChange];
-        set<VerilatedVpioVar*> update; // set of objects to update after callbacks
-	for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end();) {
-	    VerilatedVpioCb* vop = *it;
-	    ++it;  // iterator may be deleted by callback
-	    if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
-		void* newDatap = varop->varDatap();
-		void* prevDatap = varop->prevDatap();  // Was malloced when we added the callback
-		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_test %s v[0]=%d/%d %p %p\n",
-					  varop->fullname(), *((CData*)newDatap), *((CData*)prevDatap),
-					  newDatap, prevDatap););
-		if (memcmp(prevDatap, newDatap, varop->entSize())) {
-		    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_callback %p %s v[0]=%d\n",
-					      vop,varop->fullname(), *((CData*)newDatap)););
-                    update.insert(varop);
-		    vpi_get_value(vop->cb_datap()->obj, vop->cb_datap()->value);
-		    (vop->cb_rtnp()) (vop->cb_datap());
-		}
+	// Compare every watched value, then call back only for those that changed
+	vector<size_t>& dirty = s_s.m_dirtyWatches;
+	dirty.clear();
+	if (s_s.m_watches.empty()) return;
+	const VpioWatch* watchesp = &s_s.m_watches[0];
+	const vluint64_t* prevsp = &s_s.m_watchPrevs[0];
+	size_t watches = s_s.m_watches.size();
+	for (size_t i=0; i<watches; ++i) {
+	    if (VL_UNLIKELY(watchChanged(watchesp[i], prevsp))) dirty.push_back(i);
+	}
+	if (VL_LIKELY(dirty.empty())) return;
+	s_s.m_inValueCbs = true;
+	for (vector<size_t>::iterator it=dirty.begin(); it!=dirty.end(); ++it) {
+	    // Callbacks may add or remove callbacks, so index rather than iterate.
+	    // Those added now didn't see this change, so aren't called until the next.
+	    size_t cbs = s_s.m_watchCbs[*it].size();
+	    for (size_t i=0; i<cbs; ++i) {
+		VerilatedVpioCb* vop = s_s.m_watchCbs[*it][i];
+		if (!vop) continue;  // Removed
+		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_callback %p %s v[0]=%d\n",
+					  vop, VerilatedVpioVar::castp(vop->cb_datap()->obj)->fullname(),
+					  *((CData*)s_s.m_watches[*it].m_datap)););
+		vpi_get_value(vop->cb_datap()->obj, vop->cb_datap()->value);
+		(vop->cb_rtnp()) (vop->cb_datap());
 	    }
 	}
-	for (set<VerilatedVpioVar*>::iterator it=update.begin(); it!=update.end(); it++ ) {
-	    memcpy((*it)->prevDatap(), (*it)->varDatap(), (*it)->entSize());
+	for (vector<size_t>::iterator it=dirty.begin(); it!=dirty.end(); ++it) {
+	    watchSave(s_s.m_watches[*it]);
+	}
+	s_s.m_inValueCbs = false;
+	if (!s_s.m_nulledWatches.empty()) {
+	    watchSweep();
+	    if (watchCompactDue()) watchCompact();
 	}
     }
 
     static VerilatedVpiError* error_info(); // getter for vpi error info
 };
 
+//======================================================================
+/// VerilatedVpiBatch - read or write many signals with one call
+///
+/// Handles are looked up and checked once, when added.  get() then copies
+/// every value into one packed buffer, and put() copies them back, without
+/// per signal format conversion.  With vpiRawTwoStateVal each value is
+/// stored as the model stores it, as a CData, SData, IData, QData or WData
+/// array, at an offset aligned to its size.  With vpiIntVal
+/// each value is one PLI_INT32, for signals up to 32 bits.
+
+class VerilatedVpiBatch {
+    struct Entry {
+	vluint8_t*	m_datap;	// Value in the model
+	vluint32_t	m_offset;	// Offset in the caller's buffer
+	vluint32_t	m_size;		// Bytes in the model
+	vluint32_t	m_mask;		// Mask of the most significant word
+	bool		m_writable;	// Public read-write, so put() may change it
+    };
+    struct Run {
+	// Entries next to each other both in the model and the buffer
+	vluint8_t*	m_datap;
+	vluint32_t	m_offset;
+	vluint32_t	m_size;
+    };
+    PLI_INT32		m_format;	// vpiRawTwoStateVal or vpiIntVal
+    vector<Entry>	m_entries;	// Each signal, in order added
+    vector<Run>		m_runs;		// Copies for get() with vpiRawTwoStateVal
+    vluint32_t		m_size;		// Bytes in the caller's buffer
+public:
+    // CREATORS
+    VerilatedVpiBatch(PLI_INT32 format = vpiRawTwoStateVal);
+    ~VerilatedVpiBatch() {}
+    // METHODS
+    /// Add a signal or memory word, returning its byte offset in the
+    /// buffer, or -1 with a VPI error if it can't be added
+    PLI_INT32 add(vpiHandle object);
+    /// Bytes the buffer passed to get() and put() must hold
+    vluint32_t size() const { return m_size; }
+    /// Number of signals added
+    vluint32_t count() const { return m_entries.size(); }
+    /// Copy every signal's value into the buffer
+    void get(void* bufp) const;
+    /// Copy every writable signal's value from the buffer, masking unused
+    /// bits; returns the number of signals written
+    PLI_INT32 put(const void* bufp) const;
+};
+
+//======================================================================
+
 #define _VL_VPI_ERROR_SET \
     do { \
         va_list args; \
@@ -486,6 +680,128 @@ VerilatedVpiError* VerilatedVpi::error_info() {
     return s_s.m_errorInfop;
 }
 
+//======================================================================
+// VerilatedVpiBatch
+
+VerilatedVpiBatch::VerilatedVpiBatch(PLI_INT32 format)
+    : m_format(format), m_size(0) {
+    if (VL_UNLIKELY(format != vpiRawTwoStateVal && format != vpiIntVal)) {
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported format (%s) for batch",
+		      VL_FUNC, VerilatedVpiError::strFromVpiVal(format));
+	m_format = vpiRawTwoStateVal;
+    }
+}
+
+PLI_INT32 VerilatedVpiBatch::add(vpiHandle object) {
+    _VL_VPI_ERROR_RESET(); // reset vpi error status
+    VerilatedVpioVar* vop = VerilatedVpioVar::castp(object);
+    if (VL_UNLIKELY(!vop)) {
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Batch object isn't a signal or memory word", VL_FUNC);
+	return -1;
+    }
+    switch (vop->varp()->vltype()) {
+    case VLVT_UINT8:
+    case VLVT_UINT16:
+    case VLVT_UINT32:
+    case VLVT_UINT64:
+    case VLVT_WDATA:
+	break;
+    default:
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported type for batch: %s",
+		      VL_FUNC, vop->fullname());
+	return -1;
+    }
+    if (VL_UNLIKELY(vop->varp()->dims() > 1 && vop->type() != vpiMemoryWord)) {
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Batch needs each word of memory %s added",
+		      VL_FUNC, vop->fullname());
+	return -1;
+    }
+    Entry ent;
+    ent.m_datap = (vluint8_t*)vop->varDatap();
+    ent.m_size = vop->entSize();
+    ent.m_mask = vop->mask();
+    ent.m_writable = vop->varp()->isPublicRW();
+    vluint32_t bufSize = ent.m_size;
+    if (m_format == vpiIntVal) {
+	if (VL_UNLIKELY(ent.m_size > sizeof(PLI_INT32))) {
+	    _VL_VPI_ERROR(__FILE__, __LINE__, "%s: Signal too wide for vpiIntVal batch: %s",
+			  VL_FUNC, vop->fullname());
+	    return -1;
+	}
+	bufSize = sizeof(PLI_INT32);
+    }
+    vluint32_t align = (bufSize==1 || bufSize==2 || bufSize==8) ? bufSize : 4;
+    ent.m_offset = (m_size + align-1) & ~(align-1);
+    m_size = ent.m_offset + bufSize;
+    m_entries.push_back(ent);
+    if (m_format == vpiRawTwoStateVal) {
+	if (!m_runs.empty()
+	    && m_runs.back().m_datap + m_runs.back().m_size == ent.m_datap
+	    && m_runs.back().m_offset + m_runs.back().m_size == ent.m_offset) {
+	    m_runs.back().m_size += ent.m_size;
+	} else {
+	    Run run;
+	    run.m_datap = ent.m_datap;
+	    run.m_offset = ent.m_offset;
+	    run.m_size = ent.m_size;
+	    m_runs.push_back(run);
+	}
+    }
+    return ent.m_offset;
+}
+
+void VerilatedVpiBatch::get(void* bufp) const {
+    vluint8_t* outp = (vluint8_t*)bufp;
+    if (m_format == vpiRawTwoStateVal) {
+	for (vector<Run>::const_iterator it=m_runs.begin(); it!=m_runs.end(); ++it) {
+	    memcpy(outp + it->m_offset, it->m_datap, it->m_size);
+	}
+    } else {
+	for (vector<Entry>::const_iterator it=m_entries.begin(); it!=m_entries.end(); ++it) {
+	    PLI_INT32* intp = (PLI_INT32*)(outp + it->m_offset);
+	    switch (it->m_size) {
+	    case 1: *intp = *(CData*)it->m_datap; break;
+	    case 2: *intp = *(SData*)it->m_datap; break;
+	    default: *intp = *(IData*)it->m_datap; break;
+	    }
+	}
+    }
+}
+
+PLI_INT32 VerilatedVpiBatch::put(const void* bufp) const {
+    _VL_VPI_ERROR_RESET(); // reset vpi error status
+    const vluint8_t* inp = (const vluint8_t*)bufp;
+    PLI_INT32 written = 0;
+    for (vector<Entry>::const_iterator it=m_entries.begin(); it!=m_entries.end(); ++it) {
+	if (VL_UNLIKELY(!it->m_writable)) {
+	    _VL_VPI_WARNING(__FILE__, __LINE__, "Ignoring batch put to signal marked read-only, use public_flat_rw instead");
+	    continue;
+	}
+	const vluint8_t* fromp = inp + it->m_offset;
+	switch (it->m_size) {
+	case 1:
+	    *(CData*)it->m_datap = (m_format == vpiIntVal ? *(const PLI_INT32*)fromp : *fromp) & it->m_mask;
+	    break;
+	case 2:
+	    *(SData*)it->m_datap = (m_format == vpiIntVal ? *(const PLI_INT32*)fromp : *(const SData*)fromp) & it->m_mask;
+	    break;
+	case 4:
+	    *(IData*)it->m_datap = *(const IData*)fromp & it->m_mask;
+	    break;
+	case 8:  // The mask is of the most significant word
+	    *(QData*)it->m_datap = *(const QData*)fromp & _VL_SET_QII(it->m_mask, 0xffffffff);
+	    break;
+	default: {
+	    memcpy(it->m_datap, fromp, it->m_size);
+	    ((IData*)it->m_datap)[it->m_size/sizeof(IData) - 1] &= it->m_mask;
+	    break;
+	}
+	}
+	++written;
+    }
+    return written;
+}
+
 // callback related
 
 vpiHandle vpi_register_cb(p_cb_data cb_data_p) {
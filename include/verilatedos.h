@@ -206,7 +206,11 @@ typedef unsigned long long	vluint64_t;	///< 64-bit unsigned type
 //=========================================================================
 // Verilated function size macros
 
-#define VL_MULS_MAX_WORDS 16		///< Max size in words of MULS operation
+#define VL_MULS_MAX_WORDS 128		///< Max size in words of MULS, DIV or MODDIV operation
+#ifndef VL_MUL_KARATSUBA_WORDS
+# define VL_MUL_KARATSUBA_WORDS 48	///< Min size in words of MUL using Karatsuba
+#endif
+#define VL_MUL_STACK_WORDS 128		///< Max size in words of Karatsuba MUL with scratch on stack
 #define VL_TO_STRING_MAX_WORDS 64	///< Max size in words of String conversion operation
 
 //=========================================================================
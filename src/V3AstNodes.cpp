@@ -175,6 +175,11 @@ string AstVar::vlArgType(bool named, bool forReturn) const {
     if (forReturn) named=false;
     if (forReturn) v3fatalSrc("verilator internal data is never passed as return, but as first argument");
     string arg;
+    if (isDpiOpenArray()) {  // Unpacked array storage, bounds are passed separately
+	arg = "void*";
+	if (named) arg += " "+name();
+	return arg;
+    }
     if (isWide() && isInOnly()) arg += "const ";
     AstBasicDType* bdtypep = basicp();
     bool strtype = bdtypep && bdtypep->keyword()==AstBasicDTypeKwd::STRING;
@@ -275,7 +280,9 @@ string AstVar::dpiArgType(bool named, bool forReturn) const {
     if (forReturn) named=false;
     string arg;
     if (!basicp()) arg = "UNKNOWN";
-    if (basicp()->isBitLogic()) {
+    if (isDpiOpenArray()) {
+	arg = "const svOpenArrayHandle";
+    } else if (basicp()->isBitLogic()) {
 	if (widthMin() == 1) {
 	    arg = "unsigned char";
 	    if (!forReturn && isOutput()) arg += "*";
@@ -768,6 +775,7 @@ void AstPin::dump(ostream& str) {
 void AstRange::dump(ostream& str) {
     this->AstNode::dump(str);
     if (littleEndian()) str<<" [LITTLE]";
+    if (unsized()) str<<" [UNSIZED]";
 }
 void AstRefDType::dump(ostream& str) {
     this->AstNodeDType::dump(str);
@@ -900,6 +908,7 @@ void AstVar::dump(ostream& str) {
     if (isConst()) str<<" [CONST]";
     if (isPullup()) str<<" [PULLUP]";
     if (isPulldown()) str<<" [PULLDOWN]";
+    if (isDpiOpenArray()) str<<" [DPIOPENA]";
     if (isUsedClock()) str<<" [CLK]";
     if (isSigPublic()) str<<" [P]";
     if (isUsedLoopIdx()) str<<" [LOOP]";
@@ -1011,4 +1020,6 @@ void AstCFunc::dump(ostream& str) {
     if (dpiImport()) str<<" [DPII]";
     if (dpiExport()) str<<" [DPIX]";
     if (dpiExportWrapper()) str<<" [DPIXWR]";
+    if (dpiExportDirect()) str<<" [DPIXDIR]";
+    if (isMTask()) str<<" [MTASK]";
 }
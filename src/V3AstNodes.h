@@ -132,19 +132,20 @@ struct AstRange : public AstNode {
     // Range specification, for use under variables and cells
 private:
     bool	m_littleEndian:1;	// Bit vector is little endian
+    bool	m_unsized:1;	// Unsized [] dimension (parser only)
 public:
     AstRange(FileLine* fl, AstNode* msbp, AstNode* lsbp)
 	:AstNode(fl) {
-	m_littleEndian = false;
+	m_littleEndian = false; m_unsized = false;
 	setOp2p(msbp); setOp3p(lsbp); }
     AstRange(FileLine* fl, int msb, int lsb)
 	:AstNode(fl) {
-	m_littleEndian = false;
+	m_littleEndian = false; m_unsized = false;
 	setOp2p(new AstConst(fl,msb)); setOp3p(new AstConst(fl,lsb));
     }
     AstRange(FileLine* fl, VNumRange range)
 	:AstNode(fl) {
-	m_littleEndian = range.littleEndian();
+	m_littleEndian = range.littleEndian(); m_unsized = false;
 	setOp2p(new AstConst(fl,range.hi())); setOp3p(new AstConst(fl,range.lo()));
     }
     ASTNODE_NODE_FUNCS(Range, RANGE)
@@ -157,6 +158,8 @@ public:
     int	     elementsConst() const { return (msbConst()>lsbConst()) ? msbConst()-lsbConst()+1 : lsbConst()-msbConst()+1; }
     bool     littleEndian() const { return m_littleEndian; }
     void     littleEndian(bool flag) { m_littleEndian=flag; }
+    bool     unsized() const { return m_unsized; }
+    void     unsized(bool flag) { m_unsized=flag; }
     virtual void dump(ostream& str);
     virtual string emitC() { V3ERROR_NA; return ""; }
     virtual V3Hash sameHash() const { return V3Hash(); }
@@ -886,6 +889,7 @@ private:
     bool	m_isPulldown:1;	// Tri0
     bool	m_isPullup:1;	// Tri1
     bool	m_isIfaceParent:1;	// dtype is reference to interface present in this module
+    bool	m_isDpiOpenArray:1;	// DPI import open array [] argument
     bool	m_trace:1;	// Trace this variable
 
     void	init() {
@@ -897,7 +901,7 @@ private:
 	m_funcLocal=false; m_funcReturn=false;
 	m_attrClockEn=false; m_attrScBv=false; m_attrIsolateAssign=false; m_attrSFormat=false;
 	m_fileDescr=false; m_isConst=false; m_isStatic=false; m_isPulldown=false; m_isPullup=false;
-	m_isIfaceParent=false;
+	m_isIfaceParent=false; m_isDpiOpenArray=false;
 	m_trace=false;
     }
 public:
@@ -989,6 +993,7 @@ public:
     void	isConst(bool flag) { m_isConst = flag; }
     void	isStatic(bool flag) { m_isStatic = flag; }
     void	isIfaceParent(bool flag) { m_isIfaceParent = flag; }
+    void	isDpiOpenArray(bool flag) { m_isDpiOpenArray = flag; }
     void	funcLocal(bool flag) { m_funcLocal = flag; }
     void	funcReturn(bool flag) { m_funcReturn = flag; }
     void	trace(bool flag) { m_trace=flag; }
@@ -1006,6 +1011,7 @@ public:
     bool	isIO() const  { return (m_input||m_output); }
     bool	isIfaceRef() const { return (varType()==AstVarType::IFACEREF); }
     bool	isIfaceParent() const { return m_isIfaceParent; }
+    bool	isDpiOpenArray() const { return m_isDpiOpenArray; }
     bool	isSignal() const  { return varType().isSignal(); }
     bool	isTemp() const { return (varType()==AstVarType::BLOCKTEMP || varType()==AstVarType::MODULETEMP
 					 || varType()==AstVarType::STMTTEMP || varType()==AstVarType::XTEMP); }
@@ -4458,7 +4464,9 @@ private:
     bool	m_pure:1;		// Pure function
     bool	m_dpiExport:1;		// From dpi export
     bool	m_dpiExportWrapper:1;	// From dpi export; static function with dispatch table
+    bool	m_dpiExportDirect:1;	// From dpi export; wrapper called through a handle, no lookup
     bool	m_dpiImport:1;		// From dpi import
+    bool	m_isMTask:1;		// Macro-task run on the --threads pool
 public:
     AstCFunc(FileLine* fl, const string& name, AstScope* scopep, const string& rtnType="")
 	: AstNode(fl) {
@@ -4478,7 +4486,9 @@ public:
 	m_pure = false;
 	m_dpiExport = false;
 	m_dpiExportWrapper = false;
+	m_dpiExportDirect = false;
 	m_dpiImport = false;
+	m_isMTask = false;
     }
     ASTNODE_NODE_FUNCS(CFunc, CFUNC)
     virtual string name()	const { return m_name; }
@@ -4499,7 +4509,7 @@ public:
     AstScope*	scopep() const { return m_scopep; }
     void	scopep(AstScope* nodep) { m_scopep = nodep; }
     string	rtnTypeVoid() const { return ((m_rtnType=="") ? "void" : m_rtnType); }
-    bool	dontCombine() const { return m_dontCombine || funcType()!=AstCFuncType::FT_NORMAL; }
+    bool	dontCombine() const { return m_dontCombine || m_isMTask || funcType()!=AstCFuncType::FT_NORMAL; }
     void	dontCombine(bool flag) { m_dontCombine = flag; }
     bool	skipDecl() const { return m_skipDecl; }
     void	skipDecl(bool flag) { m_skipDecl = flag; }
@@ -4527,8 +4537,12 @@ public:
     void	dpiExport(bool flag) { m_dpiExport = flag; }
     bool	dpiExportWrapper() const { return m_dpiExportWrapper; }
     void	dpiExportWrapper(bool flag) { m_dpiExportWrapper = flag; }
+    bool	dpiExportDirect() const { return m_dpiExportDirect; }
+    void	dpiExportDirect(bool flag) { m_dpiExportDirect = flag; }
     bool	dpiImport() const { return m_dpiImport; }
     void	dpiImport(bool flag) { m_dpiImport = flag; }
+    bool	isMTask() const { return m_isMTask; }
+    void	isMTask(bool flag) { m_isMTask = flag; }
     //
     // If adding node accessors, see below emptyBody
     AstNode*	argsp() 	const { return op1p()->castNode(); }
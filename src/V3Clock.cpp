@@ -26,6 +26,11 @@
 //		Add around the SENTREE a (IF POSEDGE(..))
 //			Add a __Vlast_{clock} for the comparison
 //			Set the __Vlast_{clock} at the end of the block
+//		If the SENTREE only uses primary inputs, which can't change
+//		during _eval, instead test a bit of __Vtriggers computed
+//		once for all such domains at the top of _eval.
+//		With --profile-triggers, count each domain's activations
+//		and print the counts from final()
 //		Replace UNTILSTABLEs with loops until specified signals become const.
 //   Create global calling function for any per-scope functions.  (For FINALs).
 //
@@ -37,11 +42,14 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
+#include <sstream>
 
 #include "V3Global.h"
 #include "V3Clock.h"
 #include "V3Ast.h"
 #include "V3EmitCBase.h"
+#include "V3EmitV.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Clock state, as a visitor of each AstNode
@@ -71,6 +79,11 @@ private:
     AstSenTree*		m_lastSenp;	// Last sensitivity match, so we can detect duplicates.
     AstIf*		m_lastIfp;	// Last sensitivity if active to add more under
     int			m_stableNum;	// Number of each untilstable
+    vector<AstSenTree*>	m_trigSenps;	// Sensitivity of each __Vtriggers bit
+    vector<AstNode*>	m_trigEqnps;	// Equation for each __Vtriggers bit
+    vector<AstVarScope*> m_trigVscps;	// __Vtriggers variables, 32 bits each
+    vector<AstSenTree*>	m_countSenps;	// Sensitivity of each --profile-triggers counter
+    V3Double0		m_statTriggers;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -181,11 +194,100 @@ private:
 	}
 	return senEqnp;
     }
+    bool senTreeStable(AstSenTree* sensesp) {
+	// True if no logic in _eval can change the sensitivity's result
+	if (m_untilp) return false;
+	for (AstNodeSenItem* senp = sensesp->sensesp(); senp; senp=senp->nextp()->castNodeSenItem()) {
+	    AstSenItem* itemp = senp->castSenItem();
+	    if (!itemp || !itemp->varrefp()) return false;  // Gated
+	    AstVarScope* vscp = itemp->varrefp()->varScopep();
+	    if (!vscp->varp()->isPrimaryIn() || !vscp->varp()->width1()
+		|| vscp->isCircular()) return false;
+	}
+	return true;
+    }
+    AstNode* createTriggerEquation(AstSenTree* sensesp) {
+	// Return reference to the domain's precomputed trigger bit, creating if needed
+	FileLine* fl = sensesp->fileline();
+	size_t bit = 0;
+	for (; bit<m_trigSenps.size(); ++bit) {
+	    if (m_trigSenps[bit]->sameTree(sensesp)) break;
+	}
+	if (bit == m_trigSenps.size()) {
+	    AstNode* senEqnp = createSenseEquation(sensesp->sensesp());
+	    if (!senEqnp) sensesp->v3fatalSrc("No sense equation, shouldn't be in sequent activation.");
+	    m_trigSenps.push_back(sensesp);
+	    m_trigEqnps.push_back(senEqnp);
+	    if (bit%32 == 0) {
+		m_trigVscps.push_back(getCreateLocalVar(fl, "__Vtriggers"+cvtToStr(bit/32), NULL, 32));
+	    }
+	    ++m_statTriggers;
+	}
+	return new AstSel(fl, new AstVarRef(fl, m_trigVscps[bit/32], false), bit%32, 1);
+    }
+    void addTriggerComputes() {
+	// At top of _eval, compute the precomputed triggers, 32 at a time
+	FileLine* fl = m_evalFuncp->fileline();
+	AstNode* stmtsp = NULL;
+	for (size_t word=0; word<m_trigVscps.size(); ++word) {
+	    AstNode* maskp = NULL;
+	    int bits = 0;
+	    for (size_t bit=word*32; bit<m_trigEqnps.size() && bit<(word+1)*32; ++bit) {
+		if (maskp) maskp = new AstConcat(fl, m_trigEqnps[bit], maskp);
+		else maskp = m_trigEqnps[bit];
+		++bits;
+	    }
+	    if (bits<32) maskp = new AstConcat(fl, new AstConst(fl, V3Number(fl, 32-bits, 0)), maskp);
+	    stmtsp = stmtsp->addNextNull(new AstAssign(fl, new AstVarRef(fl, m_trigVscps[word], true),
+						       maskp));
+	}
+	if (!stmtsp) return;
+	stmtsp = (new AstComment(fl, "Clock triggers"))->addNext(stmtsp);
+	if (m_evalFuncp->stmtsp()) m_evalFuncp->stmtsp()->addHereThisAsNext(stmtsp);
+	else m_evalFuncp->addStmtsp(stmtsp);
+	m_trigSenps.clear();
+	m_trigEqnps.clear();
+	m_trigVscps.clear();
+    }
+    void addTriggerCount(AstSenTree* sensesp, AstIf* ifp) {
+	// For --profile-triggers, count activations of each domain.  Only
+	// the first activation of a domain in _eval is counted, so counts
+	// are evals in which the domain fired.
+	for (vector<AstSenTree*>::iterator it = m_countSenps.begin(); it != m_countSenps.end(); ++it) {
+	    if ((*it)->sameTree(sensesp)) return;
+	}
+	FileLine* fl = sensesp->fileline();
+	string name = "__Vtrigcount__"+cvtToStr(m_countSenps.size());
+	m_countSenps.push_back(sensesp);
+	AstVar* newvarp = new AstVar (fl, AstVarType::MODULETEMP, name, VFlagLogicPacked(), 64);
+	m_modp->addStmtp(newvarp);
+	AstVarScope* newvscp = new AstVarScope(fl, m_scopep, newvarp);
+	m_scopep->addVarp(newvscp);
+	m_initFuncp->addStmtsp(new AstAssign(fl, new AstVarRef(fl, newvscp, true),
+					     new AstConst(fl, V3Number(fl, 64, 0))));
+	ifp->addIfsp(new AstAssign(fl, new AstVarRef(fl, newvscp, true),
+				   new AstAdd(fl, new AstConst(fl, V3Number(fl, 64, 1)),
+					      new AstVarRef(fl, newvscp, false))));
+	ostringstream os;
+	V3EmitV::verilogForTree(sensesp, os);
+	string text = os.str();
+	string::size_type pos;
+	while ((pos = text.find_first_of("%\n")) != string::npos) text.erase(pos, 1);
+	m_finalFuncp->addStmtsp(new AstDisplay(fl, AstDisplayType::DT_DISPLAY,
+					       "-Info: Trigger count "+text+": %0d", NULL,
+					       new AstVarRef(fl, newvscp, false)));
+    }
     AstIf* makeActiveIf(AstSenTree* sensesp) {
-	AstNode* senEqnp = createSenseEquation(sensesp->sensesp());
+	AstNode* senEqnp;
+	if (senTreeStable(sensesp)) {
+	    senEqnp = createTriggerEquation(sensesp);
+	} else {
+	    senEqnp = createSenseEquation(sensesp->sensesp());
+	}
 	if (!senEqnp) sensesp->v3fatalSrc("No sense equation, shouldn't be in sequent activation.");
 	AstIf* newifp = new AstIf (sensesp->fileline(),
 				   senEqnp, NULL, NULL);
+	if (v3Global.opt.profileTriggers()) addTriggerCount(sensesp, newifp);
 	return (newifp);
     }
     void clearLastSen() {
@@ -249,6 +351,7 @@ private:
 	}
 	// Process the activates
 	nodep->iterateChildren(*this);
+	addTriggerComputes();
 	// Done, clear so we can detect errors
 	UINFO(4," TOPSCOPEDONE "<<nodep<<endl);
 	clearLastSen();
@@ -535,7 +638,9 @@ public:
 	//
 	nodep->accept(*this);
     }
-    virtual ~ClockVisitor() {}
+    virtual ~ClockVisitor() {
+	V3Stats::addStat("Optimizations, Clock triggers precomputed", m_statTriggers);
+    }
 };
 
 //######################################################################
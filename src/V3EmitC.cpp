@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <cmath>
 #include <map>
+#include <set>
 #include <vector>
 #include <algorithm>
 
@@ -71,8 +72,15 @@ public:
 		    string vfmt, char fmtLetter);
 
     void emitVarDecl(AstVar* nodep, const string& prefixIfImp);
+    void emitVarInitArray(AstVar* nodep);
+    static bool isStaticConstInit(AstVar* nodep) {
+	// Static constant tables are initialized where defined, rather than in each constructor
+	return (nodep->isStatic() && nodep->isConst()
+		&& nodep->valuep() && nodep->valuep()->castInitArray());
+    }
     typedef enum {EVL_IO, EVL_SIG, EVL_TEMP, EVL_STATIC, EVL_ALL} EisWhich;
     void emitVarList(AstNode* firstp, EisWhich which, const string& prefixIfImp);
+    void sortVarList(AstNode* firstp, EisWhich which, bool isstatic, vector<AstVar*>& varps);
     void emitVarCtors();
     bool emitSimpleOk(AstNodeMath* nodep);
     void emitIQW(AstNode* nodep) {
@@ -164,6 +172,18 @@ public:
     virtual void visit(AstAlwaysPublic*, AstNUser*) {
     }
     virtual void visit(AstCCall* nodep, AstNUser*) {
+	if (nodep->funcp()->isMTask()) {
+	    // Adjacent macro-task calls are queued together, then run on the thread pool
+	    AstCCall* prevp = nodep->backp()->castCCall();
+	    if (prevp && prevp->nextp()==nodep && prevp->funcp()->isMTask()) return;  // Queued with first call
+	    for (AstNode* subnodep=nodep; subnodep; subnodep = subnodep->nextp()) {
+		AstCCall* callp = subnodep->castCCall();
+		if (!callp || !callp->funcp()->isMTask()) break;
+		puts("vlSymsp->__Vm_threadPool.addTask(&"+topClassName()+"::"+callp->funcp()->name()+", vlSymsp);\n");
+	    }
+	    puts("vlSymsp->__Vm_threadPool.execute();\n");
+	    return;
+	}
 	puts(nodep->hiername());
 	puts(nodep->funcp()->name());
 	puts("(");
@@ -503,10 +523,30 @@ public:
 	    puts(")");
 	}
     }
-    virtual void visit(AstMulS* nodep, AstNUser* vup) {
+    void checkMaxWords(AstNodeBiop* nodep, const char* whatp) {
+	// Runtime uses fixed size temporaries for these
 	if (nodep->widthWords() > VL_MULS_MAX_WORDS) {
-	    nodep->v3error("Unsupported: Signed multiply of "<<nodep->width()<<" bits exceeds hardcoded limit VL_MULS_MAX_WORDS in verilatedos.h");
+	    nodep->v3error("Unsupported: "<<whatp<<" of "<<nodep->width()<<" bits exceeds hardcoded limit VL_MULS_MAX_WORDS in verilatedos.h");
 	}
+    }
+    virtual void visit(AstMulS* nodep, AstNUser* vup) {
+	checkMaxWords(nodep, "Signed multiply");
+	visit(nodep->castNodeBiop(), vup);
+    }
+    virtual void visit(AstDiv* nodep, AstNUser* vup) {
+	checkMaxWords(nodep, "Divide");
+	visit(nodep->castNodeBiop(), vup);
+    }
+    virtual void visit(AstDivS* nodep, AstNUser* vup) {
+	checkMaxWords(nodep, "Signed divide");
+	visit(nodep->castNodeBiop(), vup);
+    }
+    virtual void visit(AstModDiv* nodep, AstNUser* vup) {
+	checkMaxWords(nodep, "Modulus");
+	visit(nodep->castNodeBiop(), vup);
+    }
+    virtual void visit(AstModDivS* nodep, AstNUser* vup) {
+	checkMaxWords(nodep, "Signed modulus");
 	visit(nodep->castNodeBiop(), vup);
     }
     virtual void visit(AstCCast* nodep, AstNUser*) {
@@ -854,6 +894,7 @@ class EmitCImp : EmitCStmts {
     void emitCoverageDecl(AstNodeModule* modp);
     void emitCoverageImp(AstNodeModule* modp);
     void emitDestructorImp(AstNodeModule* modp);
+    static bool savableRegionVar(AstVar* varp);
     void emitSavableImp(AstNodeModule* modp);
     void emitTextSection(AstType type);
     void emitIntFuncDecls(AstNodeModule* modp);
@@ -932,6 +973,7 @@ void EmitCStmts::emitVarDecl(AstVar* nodep, const string& prefixIfImp) {
 	ofp()->putAlign(nodep->isStatic(), nodep->dtypeSkipRefp()->widthAlignBytes(),
 			nodep->dtypeSkipRefp()->widthTotalBytes());
 	if (nodep->isStatic() && prefixIfImp=="") puts("static ");
+	if (isStaticConstInit(nodep)) puts("const ");
 	if (nodep->isStatic()) puts("VL_ST_"); else puts("VL_");
 	if (nodep->widthMin() <= 8) {
 	    puts("SIG8(");
@@ -951,8 +993,40 @@ void EmitCStmts::emitVarDecl(AstVar* nodep, const string& prefixIfImp) {
 	puts(","+cvtToStr(basicp->lsb()+nodep->width()-1)
 	     +","+cvtToStr(basicp->lsb()));
 	if (nodep->isWide()) puts(","+cvtToStr(nodep->widthWords()));
-	puts(");\n");
+	puts(")");
+	if (isStaticConstInit(nodep) && prefixIfImp!="") emitVarInitArray(nodep);
+	puts(";\n");
+    }
+}
+
+void EmitCStmts::emitVarInitArray(AstVar* nodep) {
+    // Brace initializer for a static const table, so it lives in the
+    // data section of the slow compilation unit instead of being set
+    // element by element in the constructor
+    AstInitArray* initarp = nodep->valuep()->castInitArray();
+    AstUnpackArrayDType* arrayp = nodep->dtypeSkipRefp()->castUnpackArrayDType();
+    if (!arrayp) nodep->v3fatalSrc("InitArray under non-arrayed var");
+    puts(" = {\n");
+    AstConst* constp = initarp->initsp()->castConst();
+    for (int i=0; i<arrayp->elementsConst(); i++) {
+	if (!constp) initarp->v3fatalSrc("Not enough values in array initalizement");
+	if (constp->num().isFourState()) {
+	    constp->v3error("Unsupported: 4-state numbers in this context");
+	} else if (constp->isWide()) {
+	    // Word 0 is the LSB, as in the data array
+	    puts("{");
+	    for (int word=0; word<nodep->widthWords(); word++) {
+		if (word) puts(",");
+		ofp()->printf("0x%08" VL_PRI64 "x", (vluint64_t)(constp->num().dataWord(word)));
+	    }
+	    puts("}");
+	} else {
+	    emitConstant(constp, NULL, "");
+	}
+	puts((i+1)<arrayp->elementsConst() ? (((i+1)%8) ? "," : ",\n") : "\n");
+	constp = constp->nextp()->castConst();
     }
+    puts("}");
 }
 
 void EmitCStmts::emitVarCtors() {
@@ -1313,6 +1387,9 @@ void EmitCImp::emitVarResets(AstNodeModule* modp) {
 		if (!varp->hasSimpleInit()) nodep->v3fatalSrc("No init for a param?");
 		//puts("// parameter "+varp->name()+" = "+varp->valuep()->name()+"\n");
 	    }
+	    else if (isStaticConstInit(varp)) {
+		// Initialized where defined, see emitVarInitArray
+	    }
 	    else if (AstInitArray* initarp = varp->valuep()->castInitArray()) {
 		AstConst* constsp = initarp->initsp()->castConst();
 		if (AstUnpackArrayDType* arrayp = varp->dtypeSkipRefp()->castUnpackArrayDType()) {
@@ -1460,9 +1537,28 @@ void EmitCImp::emitDestructorImp(AstNodeModule* modp) {
     splitSizeInc(10);
 }
 
+bool EmitCImp::savableRegionVar(AstVar* varp) {
+    // True if the variable is plain data in the class, so can be saved with its neighbors
+    return (!varp->isStatic() && !varp->isSc()
+	    && varp->basicp() && !varp->basicp()->isOpaque()
+	    && !varp->dtypeSkipRefp()->castUnpackArrayDType());
+}
+
 void EmitCImp::emitSavableImp(AstNodeModule* modp) {
     if (v3Global.opt.savable() ) {
 	puts("\n// Savable\n");
+	// Members in the order the class declares them, then anything else
+	vector<AstVar*> varps;
+	sortVarList(modp->stmtsp(), EVL_IO, false, varps);
+	sortVarList(modp->stmtsp(), EVL_SIG, false, varps);
+	sortVarList(modp->stmtsp(), EVL_TEMP, false, varps);
+	size_t declVars = varps.size();
+	set<AstVar*> declared (varps.begin(), varps.end());
+	for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		if (declared.find(varp) == declared.end()) varps.push_back(varp);
+	    }
+	}
 	for (int de=0; de<2; ++de) {
 	    string classname = de ? "VerilatedDeserialize" : "VerilatedSerialize";
 	    string funcname = de ? "__Vdeserialize" : "__Vserialize";
@@ -1472,6 +1568,7 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
 	    // Place a computed checksum to insure proper structure save/restore formatting
 	    // OK if this hash includes some things we won't dump, since just looking for loading the wrong model
 	    VHashFnv hash;
+	    hash.hash("regions");  // Format of the code below; change if it changes
 	    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
 		if (AstVar* varp = nodep->castVar()) {
 		    hash.hash(varp->name());
@@ -1488,40 +1585,69 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
 
 	    // Save all members
 	    if (v3Global.opt.inhibitSim()) puts("os"+op+"__Vm_inhibitSim;\n");
-	    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
-		if (AstVar* varp = nodep->castVar()) {
-		    if (varp->isIO() && modp->isTop() && optSystemC()) {
-			// System C top I/O doesn't need loading, as the lower level subinst code does it.
+	    for (size_t i=0; i<varps.size(); ++i) {
+		AstVar* varp = varps[i];
+		if (varp->isIO() && modp->isTop() && optSystemC()) {
+		    // System C top I/O doesn't need loading, as the lower level subinst code does it.
+		}
+		else if (varp->isParam()) {}
+		else if (varp->isStatic() && varp->isConst()) {}
+		else if (i < declVars && savableRegionVar(varp)) {
+		    // Neighboring plain members are one region of the class; save them
+		    // together, with the size to catch a model with a different layout
+		    size_t last = i;
+		    while (last+1 < declVars && savableRegionVar(varps[last+1])
+			   && !(varps[last+1]->isIO() && modp->isTop() && optSystemC())) {
+			++last;
+		    }
+		    string firstName = varp->name();
+		    string lastName = varps[last]->name();
+		    puts("{ vluint64_t __Vsize = ");
+		    if (last == i) {
+			puts("sizeof("+firstName+");\n");
+		    } else {
+			puts("((char*)&"+lastName+" - (char*)&"+firstName
+			     +") + sizeof("+lastName+");\n");
+		    }
+		    if (de) {
+			puts("os.readAssert(__Vsize);\n");
+		    } else {
+			puts("os<<__Vsize;\n");
+		    }
+		    puts("os."+writeread+"(&"+firstName+", __Vsize); }\n");
+		    i = last;
+		}
+		else if (varp->dtypeSkipRefp()->castUnpackArrayDType()
+			 && varp->basicp() && varp->basicp()->keyword() != AstBasicDTypeKwd::STRING) {
+		    // Memories are plain data; large ones are page aligned so restore can copy them in bulk
+		    puts("os."+writeread+"Aligned(&"+varp->name()+",sizeof("+varp->name()+"));\n");
+		}
+		else {
+		    int vects = 0;
+		    // This isn't very robust and may need cleanup for other data types
+		    for (AstUnpackArrayDType* arrayp=varp->dtypeSkipRefp()->castUnpackArrayDType(); arrayp;
+			 arrayp = arrayp->subDTypep()->skipRefp()->castUnpackArrayDType()) {
+			int vecnum = vects++;
+			if (arrayp->msb() < arrayp->lsb()) varp->v3fatalSrc("Should have swapped msb & lsb earlier.");
+			string ivar = string("__Vi")+cvtToStr(vecnum);
+			// MSVC++ pre V7 doesn't support 'for (int ...)', so declare in sep block
+			puts("{ int __Vi"+cvtToStr(vecnum)+"="+cvtToStr(0)+";");
+			puts(" for (; "+ivar+"<"+cvtToStr(arrayp->elementsConst()));
+			puts("; ++"+ivar+") {\n");
 		    }
-		    else if (varp->isParam()) {}
-		    else if (varp->isStatic() && varp->isConst()) {}
-		    else {
-			int vects = 0;
-			// This isn't very robust and may need cleanup for other data types
-			for (AstUnpackArrayDType* arrayp=varp->dtypeSkipRefp()->castUnpackArrayDType(); arrayp;
-			     arrayp = arrayp->subDTypep()->skipRefp()->castUnpackArrayDType()) {
-			    int vecnum = vects++;
-			    if (arrayp->msb() < arrayp->lsb()) varp->v3fatalSrc("Should have swapped msb & lsb earlier.");
-			    string ivar = string("__Vi")+cvtToStr(vecnum);
-			    // MSVC++ pre V7 doesn't support 'for (int ...)', so declare in sep block
-			    puts("{ int __Vi"+cvtToStr(vecnum)+"="+cvtToStr(0)+";");
-			    puts(" for (; "+ivar+"<"+cvtToStr(arrayp->elementsConst()));
-			    puts("; ++"+ivar+") {\n");
-			}
-			if (varp->basicp() && (varp->basicp()->keyword() == AstBasicDTypeKwd::STRING
-					       || !varp->basicp()->isWide())) {
-			    puts("os"+op+varp->name());
-			    for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
-			    puts(";\n");
-			} else {
-			    puts("os."+writeread+"(&"+varp->name());
-			    for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
-			    puts(",sizeof("+varp->name());
-			    for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
-			    puts("));\n");
-			}
-			for (int v=0; v<vects; ++v) puts( "}}\n");
+		    if (varp->basicp() && (varp->basicp()->keyword() == AstBasicDTypeKwd::STRING
+					   || !varp->basicp()->isWide())) {
+			puts("os"+op+varp->name());
+			for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
+			puts(";\n");
+		    } else {
+			puts("os."+writeread+"(&"+varp->name());
+			for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
+			puts(",sizeof("+varp->name());
+			for (int v=0; v<vects; ++v) puts( "[__Vi"+cvtToStr(v)+"]");
+			puts("));\n");
 		    }
+		    for (int v=0; v<vects; ++v) puts( "}}\n");
 		}
 	    }
 
@@ -1671,39 +1797,48 @@ void EmitCStmts::emitVarList(AstNode* firstp, EisWhich which, const string& pref
     // But for now, Smallest->largest makes it more likely a small offset will allow access to the signal.
     for (int isstatic=1; isstatic>=0; isstatic--) {
 	if (prefixIfImp!="" && !isstatic) continue;
-	const int sortmax = 9;
-	for (int sort=0; sort<sortmax; sort++) {
-	    if (sort==3) continue;
-	    for (AstNode* nodep=firstp; nodep; nodep = nodep->nextp()) {
-		if (AstVar* varp = nodep->castVar()) {
-		    bool doit = true;
-		    switch (which) {
-		    case EVL_ALL:  doit = true; break;
-		    case EVL_IO:   doit = varp->isIO(); break;
-		    case EVL_SIG:  doit = (varp->isSignal() && !varp->isIO()); break;
-		    case EVL_TEMP: doit = (varp->isTemp() && !varp->isIO()); break;
-		    default: v3fatalSrc("Bad Case");
-		    }
-		    if (varp->isStatic() ? !isstatic : isstatic) doit=false;
-		    if (doit) {
-			int sigbytes = varp->dtypeSkipRefp()->widthAlignBytes();
-			int sortbytes = sortmax-1;
-			if (varp->isUsedClock() && varp->widthMin()==1) sortbytes = 0;
-			else if (varp->dtypeSkipRefp()->castUnpackArrayDType()) sortbytes=8;
-			else if (varp->basicp() && varp->basicp()->isOpaque()) sortbytes=7;
-			else if (varp->isScBv() || varp->isScBigUint()) sortbytes=6;
-			else if (sigbytes==8) sortbytes=5;
-			else if (sigbytes==4) sortbytes=4;
-			else if (sigbytes==2) sortbytes=2;
-			else if (sigbytes==1) sortbytes=1;
-			if (sort==sortbytes) {
-			    emitVarDecl(varp, prefixIfImp);
-			}
+	vector<AstVar*> varps;
+	sortVarList(firstp, which, isstatic, varps);
+	for (vector<AstVar*>::iterator it = varps.begin(); it != varps.end(); ++it) {
+	    emitVarDecl(*it, prefixIfImp);
+	}
+	ofp()->putAlign(isstatic, 4, 0, prefixIfImp.c_str());
+    }
+}
+
+void EmitCStmts::sortVarList(AstNode* firstp, EisWhich which, bool isstatic, vector<AstVar*>& varps) {
+    // Append the variables emitVarList declares, in the order it declares them
+    const int sortmax = 9;
+    for (int sort=0; sort<sortmax; sort++) {
+	if (sort==3) continue;
+	for (AstNode* nodep=firstp; nodep; nodep = nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		bool doit = true;
+		switch (which) {
+		case EVL_ALL:  doit = true; break;
+		case EVL_IO:   doit = varp->isIO(); break;
+		case EVL_SIG:  doit = (varp->isSignal() && !varp->isIO()); break;
+		case EVL_TEMP: doit = (varp->isTemp() && !varp->isIO()); break;
+		default: v3fatalSrc("Bad Case");
+		}
+		if (varp->isStatic() ? !isstatic : isstatic) doit=false;
+		if (doit) {
+		    int sigbytes = varp->dtypeSkipRefp()->widthAlignBytes();
+		    int sortbytes = sortmax-1;
+		    if (varp->isUsedClock() && varp->widthMin()==1) sortbytes = 0;
+		    else if (varp->dtypeSkipRefp()->castUnpackArrayDType()) sortbytes=8;
+		    else if (varp->basicp() && varp->basicp()->isOpaque()) sortbytes=7;
+		    else if (varp->isScBv() || varp->isScBigUint()) sortbytes=6;
+		    else if (sigbytes==8) sortbytes=5;
+		    else if (sigbytes==4) sortbytes=4;
+		    else if (sigbytes==2) sortbytes=2;
+		    else if (sigbytes==1) sortbytes=1;
+		    if (sort==sortbytes) {
+			varps.push_back(varp);
 		    }
 		}
 	    }
 	}
-	ofp()->putAlign(isstatic, 4, 0, prefixIfImp.c_str());
     }
 }
 
@@ -1921,6 +2056,7 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
 	puts("static void traceInit ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
 	puts("static void traceFull ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
 	puts("static void traceChg  ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
+	puts("static void traceChgSub ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code, int sub);\n");
     }
     if (v3Global.opt.savable()) {
 	puts("void __Vserialize(VerilatedSerialize& os);\n");
@@ -2074,6 +2210,9 @@ void EmitCImp::main(AstNodeModule* modp, bool slow, bool fast) {
 class EmitCTrace : EmitCStmts {
     AstCFunc*	m_funcp;	// Function we're in now
     bool	m_slow;		// Making slow file
+    bool	m_staged;	// Change function stages values for chgStaged
+    vector<AstCFunc*>	m_chgSubps;	// Change sub-functions, by traceChgSub number
+    map<AstCFunc*,int>	m_chgSubNums;	// Number of each change sub-function
 
     // METHODS
     void newOutCFile(int filenum) {
@@ -2159,6 +2298,23 @@ class EmitCTrace : EmitCStmts {
 	puts("}\n");
 	splitSizeInc(10);
 
+	if (!optSystemPerl()) {
+	    puts("void "+topClassName()+"::traceChgSub("
+		 +v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code, int sub) {\n");
+	    puts("// Callback from vcd->chgSub(), perhaps on another thread\n");
+	    puts(topClassName()+"* t=("+topClassName()+"*)userthis;\n");
+	    puts(EmitCBaseVisitor::symClassVar()+" = t->__VlSymsp; // Setup global symbol table\n");
+	    puts("if (0 && vlSymsp) {}  // Prevent unused\n");
+	    puts("switch (sub) {\n");
+	    for (size_t i=0; i<m_chgSubps.size(); ++i) {
+		puts("case "+cvtToStr(i)+": t->"+m_chgSubps[i]->name()+" (vlSymsp, vcdp, code); break;\n");
+	    }
+	    puts("default: break;\n");
+	    puts("}\n");
+	    puts("}\n");
+	    splitSizeInc(10 + m_chgSubps.size());
+	}
+
 	puts("\n//======================\n\n");
     }
 
@@ -2211,11 +2367,69 @@ class EmitCTrace : EmitCStmts {
 	puts(");");
     }
 
+    bool emitTraceStaged(AstCFunc* nodep, uint32_t& minCodeRef, uint32_t& endCodeRef) {
+	// Change functions whose traces cover a contiguous range of codes
+	// can stage all values then compare them at once with chgStaged
+	if (optSystemPerl()) return false;
+	if (nodep->funcType() != AstCFuncType::TRACE_CHANGE_SUB) return false;
+	if (!nodep->stmtsp()) return false;
+	uint32_t minCode = 0;
+	uint32_t endCode = 0;
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    AstTraceInc* incp = stmtp->castTraceInc();
+	    if (!incp) return false;
+	    if (emitTraceIsScBv(incp) || emitTraceIsScBigUint(incp)) return false;
+	    uint32_t code = incp->declp()->code();
+	    if (stmtp == nodep->stmtsp()) {
+		minCode = endCode = code;
+	    } else if (code != endCode) {
+		return false;
+	    }
+	    endCode += incp->declp()->codeInc();
+	}
+	minCodeRef = minCode;
+	endCodeRef = endCode;
+	return true;
+    }
+
+    string emitTraceScope(AstTraceInc* nodep) {
+	const string& name = nodep->declp()->showname();
+	string::size_type pos = name.rfind(' ');
+	return (pos == string::npos) ? "" : name.substr(0, pos);
+    }
+
+    void emitTraceScopes(AstNode* stmtsp) {
+	// Wrap each run of traces in one scope with a check that the scope
+	// is traced, so scopes filtered out at runtime cost one branch
+	for (AstNode* stmtp = stmtsp; stmtp; ) {
+	    AstTraceInc* incp = stmtp->castTraceInc();
+	    if (!incp) {
+		stmtp->iterate(*this);
+		stmtp = stmtp->nextp();
+		continue;
+	    }
+	    string scope = emitTraceScope(incp);
+	    uint32_t code = incp->declp()->code();
+	    uint32_t endCode = code;
+	    AstNode* endp = stmtp;
+	    for (; endp; endp=endp->nextp()) {
+		AstTraceInc* runp = endp->castTraceInc();
+		if (!runp || runp->declp()->code() != endCode || emitTraceScope(runp) != scope) break;
+		endCode += runp->declp()->codeInc();
+	    }
+	    puts("if (VL_LIKELY(vcdp->anyTraced(c+"+cvtToStr(code)+",c+"+cvtToStr(endCode)+"))) {\n");
+	    for (; stmtp != endp; stmtp=stmtp->nextp()) {
+		stmtp->iterate(*this);
+	    }
+	    puts("}\n");
+	}
+    }
+
     void emitTraceChangeOne(AstTraceInc* nodep, int arrayindex) {
 	nodep->precondsp()->iterateAndNext(*this);
 	string full = ((m_funcp->funcType() == AstCFuncType::TRACE_FULL
 			|| m_funcp->funcType() == AstCFuncType::TRACE_FULL_SUB)
-		       ? "full":"chg");
+		       ? "full" : (m_staged ? "stage" : "chg"));
 	if (nodep->isDouble()) {
 	    puts("vcdp->"+full+"Double");
 	} else if (nodep->isWide() || emitTraceIsScBv(nodep) || emitTraceIsScBigUint(nodep)) {
@@ -2263,6 +2477,17 @@ class EmitCTrace : EmitCStmts {
 	}
     }
 
+    void emitTraceChgSubs() {
+	// Number the change sub-functions, which traceChgSub dispatches to
+	for (AstNode* stmtp = v3Global.rootp()->topModulep()->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    AstCFunc* funcp = stmtp->castCFunc();
+	    if (funcp && funcp->funcType() == AstCFuncType::TRACE_CHANGE_SUB) {
+		m_chgSubNums.insert(make_pair(funcp, (int)m_chgSubps.size()));
+		m_chgSubps.push_back(funcp);
+	    }
+	}
+    }
+
     // VISITORS
     virtual void visit(AstNetlist* nodep, AstNUser*) {
 	// Top module only
@@ -2271,6 +2496,16 @@ class EmitCTrace : EmitCStmts {
     virtual void visit(AstNodeModule* nodep, AstNUser*) {
 	nodep->iterateChildren(*this);
     }
+    virtual void visit(AstCCall* nodep, AstNUser*) {
+	map<AstCFunc*,int>::iterator it = m_chgSubNums.find(nodep->funcp());
+	if (!optSystemPerl() && m_funcp && m_funcp->funcType() == AstCFuncType::TRACE_CHANGE
+	    && it != m_chgSubNums.end()) {
+	    // Sub-functions dump disjoint codes, so VerilatedVcd may run them in parallel
+	    puts("vcdp->chgSub(&"+topClassName()+"::traceChgSub, this, code, "+cvtToStr(it->second)+");\n");
+	    return;
+	}
+	EmitCStmts::visit(nodep, NULL);
+    }
     virtual void visit(AstCFunc* nodep, AstNUser*) {
 	if (nodep->slow() != m_slow) return;
 	if (nodep->funcType().isTrace()) {   // TRACE_*
@@ -2308,10 +2543,24 @@ class EmitCTrace : EmitCStmts {
 	    nodep->initsp()->iterateAndNext(*this);
 	    ofp()->putAlign(V3OutFile::AL_AUTO, 4);
 
+	    uint32_t minCode = 0;
+	    uint32_t endCode = 0;
+	    m_staged = emitTraceStaged(nodep, minCode/*ref*/, endCode/*ref*/);
+
 	    puts("// Body\n");
 	    puts("{\n");
-	    nodep->stmtsp()->iterateAndNext(*this);
+	    if (!optSystemPerl()
+		&& (nodep->funcType() == AstCFuncType::TRACE_FULL_SUB
+		    || nodep->funcType() == AstCFuncType::TRACE_CHANGE_SUB)) {
+		emitTraceScopes(nodep->stmtsp());
+	    } else {
+		nodep->stmtsp()->iterateAndNext(*this);
+	    }
+	    if (m_staged) {
+		puts("vcdp->chgStaged(c+"+cvtToStr(minCode)+",c+"+cvtToStr(endCode)+");\n");
+	    }
 	    puts("}\n");
+	    m_staged = false;
 	    if (nodep->finalsp()) puts("// Final\n");
 	    nodep->finalsp()->iterateAndNext(*this);
 	    puts("}\n");
@@ -2347,11 +2596,13 @@ public:
     EmitCTrace(bool slow) {
 	m_funcp = NULL;
 	m_slow = slow;
+	m_staged = false;
     }
     virtual ~EmitCTrace() {}
     void main() {
 	// Put out the file
 	newOutCFile(0);
+	emitTraceChgSubs();
 
 	if (m_slow) emitTraceSlow();
 	else emitTraceFast();
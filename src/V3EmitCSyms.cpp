@@ -34,6 +34,8 @@
 #include "V3EmitCBase.h"
 #include "V3LanguageWords.h"
 
+#define EMITCSYMS_DATAS_CHUNK 256	// Public variable data pointers passed per varsConfigure call
+
 //######################################################################
 // Symbol table emitting
 
@@ -60,6 +62,7 @@ class EmitCSyms : EmitCBaseVisitor {
     typedef map<string,ScopeFuncData> ScopeFuncs;
     typedef map<string,ScopeVarData> ScopeVars;
     typedef map<string,ScopeNameData> ScopeNames;
+    typedef map<string,vector<ScopeVarData*> > ScopeVarLists;
     typedef pair<AstScope*,AstNodeModule*> ScopeModPair;
     typedef pair<AstNodeModule*,AstVar*> ModVarPair;
     struct CmpName {
@@ -67,6 +70,11 @@ class EmitCSyms : EmitCBaseVisitor {
 	    return lhsp.first->name() < rhsp.first->name();
 	}
     };
+    struct CmpVarPretty {
+	inline bool operator () (const ScopeVarData* lhsp, const ScopeVarData* rhsp) const {
+	    return lhsp->m_varBasePretty < rhsp->m_varBasePretty;
+	}
+    };
     struct CmpDpi {
 	inline bool operator () (const AstCFunc* lhsp, const AstCFunc* rhsp) const {
 	    if (lhsp->dpiImport() != rhsp->dpiImport()) {
@@ -94,6 +102,8 @@ class EmitCSyms : EmitCBaseVisitor {
     void emitSymImp();
     void emitDpiHdr();
     void emitDpiImp();
+    void varBounds(AstVar* varp, int& pdimr, int& udimr, string& boundsr);
+    void scopeVarLists(ScopeVarLists& listsr);
 
     void nameCheck(AstNode* nodep) {
 	// Prevent GCC compile time error; name check all things that reach C++ code
@@ -274,6 +284,9 @@ void EmitCSyms::emitSymHdr() {
     } else {
 	puts("#include \"verilated.h\"\n");
     }
+    if (v3Global.opt.threads() > 1) {
+	puts("#include \"verilated_threads.h\"\n");
+    }
 
     // for
     puts("\n// INCLUDE MODULE CLASSES\n");
@@ -307,6 +320,10 @@ void EmitCSyms::emitSymHdr() {
     puts("bool\t__Vm_activity;\t\t///< Used by trace routines to determine change occurred\n");
     ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(bool));
     puts("bool\t__Vm_didInit;\n");
+    if (v3Global.opt.threads() > 1) {
+	ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
+	puts("VerilatedThreadPool __Vm_threadPool;\t///< Workers for --threads macro-tasks\n");
+    }
 
     ofp()->putAlign(V3OutFile::AL_AUTO, sizeof(vluint64_t));
     puts("\n// SUBCELL STATE\n");
@@ -350,6 +367,52 @@ void EmitCSyms::emitSymHdr() {
     puts("#endif  /*guard*/\n");
 }
 
+void EmitCSyms::varBounds(AstVar* varp, int& pdimr, int& udimr, string& boundsr) {
+    // Dimensions of a public variable, as comma separated left,right pairs
+    pdimr = 0;
+    udimr = 0;
+    boundsr = "";
+    if (AstBasicDType* basicp = varp->basicp()) {
+	// Range is always first, it's not in "C" order
+	if (basicp->isRanged()) {
+	    boundsr += cvtToStr(basicp->left());
+	    boundsr += ","; boundsr += cvtToStr(basicp->right());
+	    pdimr++;
+	}
+	for (AstNodeDType* dtypep=varp->dtypep(); dtypep; ) {
+	    dtypep = dtypep->skipRefp();  // Skip AstRefDType/AstTypedef, or return same node
+	    if (AstNodeArrayDType* adtypep = dtypep->castNodeArrayDType()) {
+		if (boundsr != "") boundsr += ",";
+		boundsr += cvtToStr(adtypep->declRange().left());
+		boundsr += ","; boundsr += cvtToStr(adtypep->declRange().right());
+		if (dtypep->castPackArrayDType()) pdimr++; else udimr++;
+		dtypep = adtypep->subDTypep();
+	    }
+	    else break; // AstBasicDType - nothing below, 1
+	}
+	if (udimr && !pdimr) {
+	    // Single bit elements; give them a range, so the runtime doesn't
+	    // take the array for the packed range
+	    boundsr = "0,0,"+boundsr;
+	    pdimr++;
+	}
+    }
+}
+
+void EmitCSyms::scopeVarLists(ScopeVarLists& listsr) {
+    // Group supported public variables by scope, each sorted as strcmp would
+    for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
+	int pdim, udim;
+	string bounds;
+	varBounds(it->second.m_varp, pdim/*ref*/, udim/*ref*/, bounds/*ref*/);
+	if (pdim>1 || udim>1) continue;
+	listsr[it->second.m_scopeName].push_back(&(it->second));
+    }
+    for (ScopeVarLists::iterator it = listsr.begin(); it != listsr.end(); ++it) {
+	stable_sort(it->second.begin(), it->second.end(), CmpVarPretty());
+    }
+}
+
 void EmitCSyms::emitSymImp() {
     UINFO(6,__FUNCTION__<<": "<<endl);
     string filename = v3Global.opt.makeDir()+"/"+symClassName()+".cpp";
@@ -369,12 +432,53 @@ void EmitCSyms::emitSymImp() {
 
     //puts("\n// GLOBALS\n");
 
+    ScopeVarLists varLists;
+    if (v3Global.dpi()) scopeVarLists(varLists/*ref*/);
+    if (v3Global.dpi() && !m_scopeVars.empty()) {
+	puts("\n// PUBLIC VARIABLES, sorted by name for VerilatedScope::varsConfigure\n");
+	for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
+	    int pdim, udim;
+	    string bounds;
+	    varBounds(it->second.m_varp, pdim/*ref*/, udim/*ref*/, bounds/*ref*/);
+	    if (pdim>1 || udim>1) {
+		// VerilatedImp can't deal with >2d or packed arrays
+		puts("//UNSUP "+it->second.m_scopeName+" ");
+		putsQuoted(it->second.m_varBasePretty);
+		puts("\n");
+	    }
+	}
+	for (ScopeVarLists::iterator lit = varLists.begin(); lit != varLists.end(); ++lit) {
+	    puts("static const VerilatedVarDesc __Vvars_"+lit->first+"[] = {\n");
+	    for (vector<ScopeVarData*>::iterator it = lit->second.begin(); it != lit->second.end(); ++it) {
+		AstVar* varp = (*it)->m_varp;
+		int pdim, udim;
+		string bounds;
+		varBounds(varp, pdim/*ref*/, udim/*ref*/, bounds/*ref*/);
+		puts("{");
+		putsQuoted((*it)->m_varBasePretty);
+		puts(", ");
+		puts(varp->vlEnumType());  // VLVT_UINT32 etc
+		puts(", ");
+		puts(varp->vlEnumDir());  // VLVD_IN etc
+		if (varp->isSigUserRWPublic()) puts("|VLVF_PUB_RW");
+		else if (varp->isSigUserRdPublic()) puts("|VLVF_PUB_RD");
+		puts(", ");
+		puts(cvtToStr(pdim+udim));
+		puts(", {"+(bounds.empty() ? string("0") : bounds)+"}},\n");
+	    }
+	    puts("};\n");
+	}
+    }
+
     puts("\n// FUNCTIONS\n");
     puts(symClassName()+"::"+symClassName()+"("+topClassName()+"* topp, const char* namep)\n");
     puts("\t// Setup locals\n");
     puts("\t: __Vm_namep(namep)\n");	// No leak, as we get destroyed when the top is destroyed
     puts("\t, __Vm_activity(false)\n");
     puts("\t, __Vm_didInit(false)\n");
+    if (v3Global.opt.threads() > 1) {
+	puts("\t, __Vm_threadPool("+cvtToStr(v3Global.opt.threads())+")\n");
+    }
     puts("\t// Setup submodule names\n");
     char comma=',';
     for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
@@ -447,61 +551,36 @@ void EmitCSyms::emitSymImp() {
 		puts("));\n");
 	    }
 	}
-	// It would be less code if each module inserted its own variables.
-	// Someday.  For now public isn't common.
-	for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
-	    AstNodeModule* modp = it->second.m_modp;
-	    AstScope* scopep = it->second.m_scopep;
-	    AstVar* varp = it->second.m_varp;
-	    //
-	    int pdim=0;
-	    int udim=0;
-	    string bounds;
-	    if (AstBasicDType* basicp = varp->basicp()) {
-		// Range is always first, it's not in "C" order
-		if (basicp->isRanged()) {
-		    bounds += " ,"; bounds += cvtToStr(basicp->msb());
-		    bounds += ","; bounds += cvtToStr(basicp->lsb());
-		    pdim++;
-		}
-		for (AstNodeDType* dtypep=varp->dtypep(); dtypep; ) {
-		    dtypep = dtypep->skipRefp();  // Skip AstRefDType/AstTypedef, or return same node
-		    if (AstNodeArrayDType* adtypep = dtypep->castNodeArrayDType()) {
-			bounds += " ,"; bounds += cvtToStr(adtypep->msb());
-			bounds += ","; bounds += cvtToStr(adtypep->lsb());
-			if (dtypep->castPackArrayDType()) pdim++; else udim++;
-			dtypep = adtypep->subDTypep();
+	puts("}\n");
+	// Each scope copies its table, so no name map is built at runtime.
+	// Data pointers go through a fixed size buffer, so a scope with many
+	// variables doesn't make a huge array on the stack.
+	for (ScopeVarLists::iterator lit = varLists.begin(); lit != varLists.end(); ++lit) {
+	    size_t count = lit->second.size();
+	    size_t chunk = min(count, (size_t)EMITCSYMS_DATAS_CHUNK);
+	    puts("{\n");
+	    puts("void* __Vdatasp["+cvtToStr(chunk)+"];\n");
+	    for (size_t start = 0; start < count; start += chunk) {
+		size_t n = min(chunk, count - start);
+		for (size_t i = 0; i < n; ++i) {
+		    ScopeVarData* datap = lit->second[start+i];
+		    puts("__Vdatasp["+cvtToStr(i)+"] = &(");
+		    if (datap->m_modp->isTop()) {
+			puts(datap->m_scopep->nameDotless());
+			puts("p->");
+		    } else {
+			puts(datap->m_scopep->nameDotless());
+			puts(".");
 		    }
-		    else break; // AstBasicDType - nothing below, 1
+		    puts(datap->m_varp->name());
+		    puts(");\n");
 		}
+		puts("__Vscope_"+lit->first+".varsConfigure(__Vvars_"+lit->first
+		     +(start ? "+"+cvtToStr(start) : string(""))
+		     +", __Vdatasp, "+cvtToStr(n)+");\n");
 	    }
-	    //
-	    if (pdim>1 || udim>1) {
-		puts("//UNSUP ");  // VerilatedImp can't deal with >2d or packed arrays
-	    }
-	    puts("__Vscope_"+it->second.m_scopeName+".varInsert(__Vfinal,");
-	    putsQuoted(it->second.m_varBasePretty);
-	    puts(", &(");
-	    if (modp->isTop()) {
-		puts(scopep->nameDotless());
-		puts("p->");
-	    } else {
-		puts(scopep->nameDotless());
-		puts(".");
-	    }
-	    puts(varp->name());
-	    puts("), ");
-	    puts(varp->vlEnumType());  // VLVT_UINT32 etc
-	    puts(",");
-	    puts(varp->vlEnumDir());  // VLVD_IN etc
-	    if (varp->isSigUserRWPublic()) puts("|VLVF_PUB_RW");
-	    else if (varp->isSigUserRdPublic()) puts("|VLVF_PUB_RD");
-	    puts(",");
-	    puts(cvtToStr(pdim+udim));
-	    puts(bounds);
-	    puts(");\n");
+	    puts("}\n");
 	}
-	puts("}\n");
     }
 
     puts("}\n");
@@ -553,6 +632,24 @@ void EmitCSyms::emitDpiHdr() {
     puts("#endif\n");
     puts("\n");
 
+    int firstHandle = 0;
+    for (vector<AstCFunc*>::iterator it = m_dpis.begin(); it != m_dpis.end(); ++it) {
+	AstCFunc* nodep = *it;
+	if (nodep->dpiExportWrapper() && !nodep->dpiExportDirect()) {
+	    if (!firstHandle++) {
+		puts("\n// DPI EXPORT HANDLES\n");
+		puts("// {export}__Vhandle binds an export to a scope once; {export}__Vdirect\n");
+		puts("// then calls it through the handle without looking up the scope each call.\n");
+	    }
+	    puts("#ifndef _VL_DPIHANDLE_"+nodep->name()+"\n");
+	    puts("#define _VL_DPIHANDLE_"+nodep->name()+"\n");
+	    puts("typedef struct { void* m_symsp; void* m_cbp; } "+nodep->name()+"__Vhandle_t;\n");
+	    puts("extern void "+nodep->name()+"__Vhandle (const svScope scope, "
+		 +nodep->name()+"__Vhandle_t* handlep);\n");
+	    puts("#endif\n");
+	}
+    }
+
     int firstExp = 0;
     int firstImp = 0;
     for (vector<AstCFunc*>::iterator it = m_dpis.begin(); it != m_dpis.end(); ++it) {
@@ -612,6 +709,7 @@ void EmitCSyms::emitDpiImp() {
 	    puts("// DPI Export at "+nodep->fileline()->ascii()+"\n");
 	    puts("return "+topClassName()+"::"+nodep->name()+"(");
 	    string args;
+	    if (nodep->dpiExportDirect()) args += "__Vhandlep";
 	    for (AstNode* stmtp = nodep->argsp(); stmtp; stmtp=stmtp->nextp()) {
 		if (AstVar* portp = stmtp->castVar()) {
 		    if (portp->isIO() && !portp->isFuncReturn()) {
@@ -624,6 +722,22 @@ void EmitCSyms::emitDpiImp() {
 	    puts("}\n");
 	    puts("#endif\n");
 	    puts("\n");
+	    if (!nodep->dpiExportDirect()) {
+		string handleName = nodep->name()+"__Vhandle";
+		puts("#ifndef _VL_DPIDECL_"+handleName+"\n");
+		puts("#define _VL_DPIDECL_"+handleName+"\n");
+		puts("void "+handleName+" (const svScope scope, "+handleName+"_t* handlep) {\n");
+		puts("// Same lookup as each "+nodep->name()+" call does, done once for "+nodep->name()+"__Vdirect\n");
+		puts("static int __Vfuncnum = -1;\n");
+		puts("if (VL_UNLIKELY(__Vfuncnum==-1)) { __Vfuncnum = Verilated::exportFuncNum(\""+nodep->name()+"\"); }\n");
+		puts("const VerilatedScope* __Vscopep = (const VerilatedScope*)scope;\n");
+		// If scope is null or lacks the function, exportFind throws an error
+		puts("handlep->m_cbp = __Vscopep->exportFind(__Vfuncnum);\n");
+		puts("handlep->m_symsp = __Vscopep->symsp();\n");
+		puts("}\n");
+		puts("#endif\n");
+		puts("\n");
+	    }
 	}
     }
 }
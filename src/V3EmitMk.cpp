@@ -63,6 +63,8 @@ public:
 	of.puts("VM_COVERAGE = "); of.puts(v3Global.opt.coverage()?"1":"0"); of.puts("\n");
 	of.puts("# Tracing output mode?  0/1 (from --trace)\n");
 	of.puts("VM_TRACE = "); of.puts(v3Global.opt.trace()?"1":"0"); of.puts("\n");
+	of.puts("# Threaded output mode?  0/1 (from --threads)\n");
+	of.puts("VM_THREADS = "); of.puts(v3Global.opt.threads()>1?"1":"0"); of.puts("\n");
 
 	of.puts("\n### Object file lists...\n");
 	for (int support=0; support<3; support++) {
@@ -83,6 +85,9 @@ public:
 		    if (v3Global.opt.savable()) {
 			putMakeClassEntry(of, "verilated_save.cpp");
 		    }
+		    if (v3Global.opt.threads() > 1) {
+			putMakeClassEntry(of, "verilated_threads.cpp");
+		    }
 		    if (v3Global.opt.systemPerl()) {
 			putMakeClassEntry(of, "Sp.cpp");  // Note Sp.cpp includes SpTraceVcdC
 		    }
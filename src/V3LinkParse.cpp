@@ -54,6 +54,7 @@ private:
 
     // STATE
     AstVar*		m_varp;		// Variable we're under
+    AstNodeFTask*	m_ftaskp;	// Function or task we're under
     ImplTypedefMap	m_implTypedef;	// Created typedefs for each <container,name>
     FileLineSet		m_filelines;	// Filelines that have been seen
     bool		m_inAlways;	// Inside an always
@@ -85,6 +86,12 @@ private:
     }
 
     // VISITs
+    virtual void visit(AstNodeFTask* nodep, AstNUser*) {
+	cleanFileline(nodep);
+	m_ftaskp = nodep;
+	nodep->iterateChildren(*this);
+	m_ftaskp = NULL;
+    }
     virtual void visit(AstNodeFTaskRef* nodep, AstNUser*) {
 	if (!nodep->user1SetOnce()) {  // Process only once.
 	    cleanFileline(nodep);
@@ -132,6 +139,9 @@ private:
 	m_varp = nodep;
 	nodep->iterateChildren(*this);
 	m_varp = NULL;
+	if (nodep->isDpiOpenArray() && !(m_ftaskp && m_ftaskp->dpiImport())) {
+	    nodep->v3error("Unsupported: Unsized array dimension other than on a DPI import argument: "<<nodep->prettyName());
+	}
 	// temporaries under an always aren't expected to be blocking
 	if (m_inAlways) nodep->fileline()->modifyWarnOff(V3ErrorCode::BLKSEQ, true);
 	if (nodep->valuep()) {
@@ -312,6 +322,7 @@ public:
     // CONSTUCTORS
     LinkParseVisitor(AstNetlist* rootp) {
 	m_varp = NULL;
+	m_ftaskp = NULL;
 	m_modp = NULL;
 	m_inAlways = false;
 	m_inGenerate = false;
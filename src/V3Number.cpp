@@ -25,6 +25,7 @@
 #include <cstdarg>
 #include <algorithm>
 #include <iomanip>
+#include <vector>
 #include "V3Number.h"
 
 #define MAX_SPRINTF_DOUBLE_SIZE 100  // Maximum characters with a sprintf %e/%f/%g (probably < 30)
@@ -1295,8 +1296,8 @@ V3Number& V3Number::opModDivGuts(const V3Number& lhs, const V3Number& rhs, bool
     }
 
     // +1 word as we may shift during normalization
-    uint32_t un[VL_MULS_MAX_WORDS+1]; // Fixed size, as MSVC++ doesn't allow [words] here
-    uint32_t vn[VL_MULS_MAX_WORDS+1]; // v normalized
+    vector<uint32_t> un (words+1);
+    vector<uint32_t> vn (words+1); // v normalized
 
     // Zero for ease of debugging and to save having to zero for shifts
     for (int i=0; i<words; i++) { m_value[i]=0; }
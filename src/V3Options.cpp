@@ -745,6 +745,7 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( onoff   (sw, "-pins-uint8", flag/*ref*/) ){ m_pinsUint8 = flag; }
 	    else if ( !strcmp (sw, "-private") )		{ m_public = false; }
 	    else if ( onoff   (sw, "-profile-cfuncs", flag/*ref*/) )	{ m_profileCFuncs = flag; }
+	    else if ( onoff   (sw, "-profile-triggers", flag/*ref*/) )	{ m_profileTriggers = flag; }
 	    else if ( onoff   (sw, "-psl", flag/*ref*/) )		{ m_psl = flag; }
 	    else if ( onoff   (sw, "-public", flag/*ref*/) )		{ m_public = flag; }
 	    else if ( onoff   (sw, "-report-unoptflat", flag/*ref*/) )	{ m_reportUnoptflat = flag; }
@@ -871,10 +872,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		m_outputSplitCTrace = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-threads") && (i+1)<argc ) {
+		shift;
+		m_threads = atoi(argv[i]);
+		if (m_threads < 0) fl->v3fatal("--threads must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-trace-depth") && (i+1)<argc ) {
 		shift;
 		m_traceDepth = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-trace-max-activity") && (i+1)<argc ) {
+		shift;
+		m_traceMaxActivity = atoi(argv[i]);
+		if (m_traceMaxActivity < 0) fl->v3fatal("--trace-max-activity must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-trace-max-array") && (i+1)<argc ) {
 		shift;
 		m_traceMaxArray = atoi(argv[i]);
@@ -1209,6 +1220,7 @@ V3Options::V3Options() {
     m_warnFatal = true;
     m_pinsBv = 65;
     m_profileCFuncs = false;
+    m_profileTriggers = false;
     m_preprocOnly = false;
     m_psl = false;
     m_public = false;
@@ -1233,7 +1245,9 @@ V3Options::V3Options() {
     m_outputSplit = 0;
     m_outputSplitCFuncs = 0;
     m_outputSplitCTrace = 0;
+    m_threads = 0;
     m_traceDepth = 0;
+    m_traceMaxActivity = 0;
     m_traceMaxArray = 32;
     m_traceMaxWidth = 256;
     m_unrollCount = 64;
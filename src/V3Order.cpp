@@ -84,6 +84,17 @@
 //	When we have no more choices, we move to the next module
 //	and make a new block.  Add that new activation block to the list of calls to make.
 //
+//   With --threads, before moving
+//	Partition logic vertices into sets sharing no variables
+//	Serialize any impure logic ($display, calls, etc) into one set
+//	Balance the sets across one macro-task per thread
+//	Never combine logic of different macro-tasks into one function
+//   and after moving
+//	For each run of same-domain activations with multiple macro-tasks
+//	   Make one function per macro-task calling its functions in order
+//	   Replace the run with one activation calling all macro-tasks,
+//	   which EmitC dispatches to the thread pool
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -95,6 +106,7 @@
 #include <vector>
 #include <deque>
 #include <map>
+#include <set>
 #include <iomanip>
 #include <sstream>
 #include <memory>
@@ -140,18 +152,20 @@ private:
     AstSenTree*			m_domainp;		// Domain all vertices belong to
     AstScope*			m_scopep;		// Scope all vertices belong to
     OrderLoopId			m_inLoop;		// Loop member of
+    uint32_t			m_mtask;		// Macro-task all vertices belong to
 
-    typedef pair<pair<OrderLoopId, AstSenTree*>, AstScope*> DomScopeKey;
+    typedef pair<pair<OrderLoopId, AstSenTree*>, pair<AstScope*, uint32_t> > DomScopeKey;
     typedef std::map<DomScopeKey, OrderMoveDomScope*> DomScopeMap;
     static DomScopeMap	s_dsMap;	// Structure registered for each dom/scope pairing
 
 public:
-    OrderMoveDomScope(OrderLoopId inLoop, AstSenTree* domainp, AstScope* scopep)
-	: m_onReadyList(false), m_domainp(domainp), m_scopep(scopep), m_inLoop(inLoop) {}
+    OrderMoveDomScope(OrderLoopId inLoop, AstSenTree* domainp, AstScope* scopep, uint32_t mtask)
+	: m_onReadyList(false), m_domainp(domainp), m_scopep(scopep), m_inLoop(inLoop), m_mtask(mtask) {}
     OrderMoveDomScope* readyDomScopeNextp() const { return m_readyDomScopeE.nextp(); }
     OrderLoopId inLoop() const { return m_inLoop; }
     AstSenTree* domainp() const { return m_domainp; }
     AstScope*   scopep() const { return m_scopep; }
+    uint32_t    mtask() const { return m_mtask; }
     void ready(OrderVisitor* ovp);	// Check the domScope is on ready list, add if not
     void movedVertex(OrderVisitor* ovp, OrderMoveVertex* vertexp);	// Mark one vertex as finished, remove from ready list if done
     // STATIC MEMBERS (for lookup)
@@ -162,13 +176,14 @@ public:
 	s_dsMap.clear();
     }
     V3List<OrderMoveVertex*>& readyVertices() { return m_readyVertices; }
-    static OrderMoveDomScope* findCreate (OrderLoopId inLoop, AstSenTree* domainp, AstScope* scopep) {
-	const DomScopeKey key = make_pair(make_pair(inLoop,domainp),scopep);
+    static OrderMoveDomScope* findCreate (OrderLoopId inLoop, AstSenTree* domainp, AstScope* scopep,
+					  uint32_t mtask) {
+	const DomScopeKey key = make_pair(make_pair(inLoop,domainp),make_pair(scopep,mtask));
 	DomScopeMap::iterator iter = s_dsMap.find(key);
 	if (iter != s_dsMap.end()) {
 	    return iter->second;
 	} else {
-	    OrderMoveDomScope* domScopep = new OrderMoveDomScope(inLoop, domainp, scopep);
+	    OrderMoveDomScope* domScopep = new OrderMoveDomScope(inLoop, domainp, scopep, mtask);
 	    s_dsMap.insert(make_pair(key, domScopep));
 	    return domScopep;
 	}
@@ -177,7 +192,8 @@ public:
 	return (string("MDS:")
 		+" lp="+cvtToStr(inLoop())
 		+" d="+cvtToStr((void*)domainp())
-		+" s="+cvtToStr((void*)scopep()));
+		+" s="+cvtToStr((void*)scopep())
+		+" mt="+cvtToStr(mtask()));
     }
 };
 
@@ -188,6 +204,46 @@ inline ostream& operator<< (ostream& lhs, const OrderMoveDomScope& rhs) {
     return lhs;
 }
 
+//######################################################################
+// Find logic that must not run concurrently with other logic
+
+class OrderMTaskSerialVisitor : public AstNVisitor {
+private:
+    // STATE
+    bool	m_serial;	// Found side effects not visible in the order graph
+    bool	m_userCall;	// Calls public or DPI code, which sets trace activity
+    vector<AstVarScope*> m_varScps;	// Variables referenced, with or without an order edge
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep, AstNUser*) {
+	if (!nodep->varScopep()) nodep->v3fatalSrc("Var ref not scoped\n");
+	m_varScps.push_back(nodep->varScopep());
+    }
+    virtual void visit(AstCCall* nodep, AstNUser*) {
+	// Callee's variables aren't in the graph
+	m_serial = true;
+	if (nodep->funcp()->funcPublic() || nodep->funcp()->dpiImport()) m_userCall = true;
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstNode* nodep, AstNUser*) {
+	if (!nodep->isPure() || nodep->isOutputter()
+	    || nodep->castRand()) {	// Shared random state
+	    m_serial = true;
+	}
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    OrderMTaskSerialVisitor(AstNode* nodep) {
+	m_serial = false;
+	m_userCall = false;
+	nodep->accept(*this);
+    }
+    virtual ~OrderMTaskSerialVisitor() {}
+    bool serial() const { return m_serial; }
+    bool userCall() const { return m_userCall; }
+    const vector<AstVarScope*>& varScps() const { return m_varScps; }
+};
+
 //######################################################################
 // Order information stored under each AstNode::user1p()...
 
@@ -302,6 +358,9 @@ private:
     int				m_pomNewStmts;	// Statements in function being created
     V3Graph			m_pomGraph;	// Graph of logic elements to move
     V3List<OrderMoveVertex*>	m_pomWaiting;	// List of nodes needing inputs to become ready
+    vector<int>			m_pmtSets;	// processMTasks: Union-find parent of each logic set
+    typedef vector<pair<AstActive*,uint32_t> > MTaskActives;
+    MTaskActives		m_pmtActives;	// processMTasks: Activations made by move, and their macro-task
 protected:
     friend class OrderMoveDomScope;
     V3List<OrderMoveDomScope*>  m_pomReadyDomScope;	// List of ready domain/scope pairs, by loopId
@@ -310,6 +369,8 @@ protected:
 private:
     // STATS
     V3Double0		m_statCut[OrderVEdgeType::_ENUM_END];	// Count of each edge type cut
+    V3Double0		m_statMTaskSets;	// Independent logic sets found for --threads
+    V3Double0		m_statMTaskRuns;	// Activations dispatched in parallel
 
     // TYPES
     enum VarUsage { VU_NONE=0, VU_CON=1, VU_GEN=2 };
@@ -384,6 +445,11 @@ private:
     void processDomainsIterate(OrderEitherVertex* vertexp);
     void processEdgeReport();
 
+    void processMTasks();
+    int processMTasksFind(int set);
+    void processMTasksUnion(int& setr, int other);
+    void processMTasksCombine();
+
     void processMove();
     void processMoveClear();
     void processMoveBuildGraph();
@@ -847,6 +913,10 @@ public:
 		V3Stats::addStat(string("Order, cut, ")+OrderVEdgeType(type).ascii(), count);
 	    }
 	}
+	if (v3Global.opt.threads() > 1) {
+	    V3Stats::addStat("Order, threads, independent logic sets", m_statMTaskSets);
+	    V3Stats::addStat("Order, threads, parallel activations", m_statMTaskRuns);
+	}
 	// Destruction
 	for (deque<OrderUser*>::iterator it=m_orderUserps.begin(); it!=m_orderUserps.end(); ++it) {
 	    delete *it;
@@ -1353,6 +1423,142 @@ void OrderVisitor::processEdgeReport() {
 
 }
 
+//######################################################################
+// Macro-task partitioning
+
+int OrderVisitor::processMTasksFind(int set) {
+    while (m_pmtSets[set] != set) {
+	m_pmtSets[set] = m_pmtSets[m_pmtSets[set]];  // Path halving
+	set = m_pmtSets[set];
+    }
+    return set;
+}
+
+void OrderVisitor::processMTasksUnion(int& setr, int other) {
+    // Merge other into setr; setr of -1 is no set yet
+    other = processMTasksFind(other);
+    if (setr < 0) { setr = other; return; }
+    setr = processMTasksFind(setr);
+    if (setr != other) m_pmtSets[other] = setr;
+}
+
+void OrderVisitor::processMTasks() {
+    // Logic that shares no variable, even transitively, may be evaluated
+    // concurrently with no locking and no effect on the results.
+    m_pmtSets.clear();
+    vector<OrderLogicVertex*> logicps;
+    int serialSet = -1;
+    // Join all logic reading or writing each variable.  Join by reference,
+    // not by graph edge, as some reads (clock_enable variables, or reads
+    // after a write in the same block) have no edge.
+    map<AstVarScope*,int> varSets;
+    for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	if (OrderLogicVertex* lvertexp = dynamic_cast<OrderLogicVertex*>(itp)) {
+	    if (lvertexp->nodep()->castSenTree()) continue;  // Clocks are tested in _eval, not in the logic
+	    int set = logicps.size();
+	    logicps.push_back(lvertexp);
+	    m_pmtSets.push_back(set);
+	    OrderMTaskSerialVisitor serialVisitor (lvertexp->nodep());
+	    if (serialVisitor.serial()) {
+		processMTasksUnion(serialSet/*ref*/, set);
+	    }
+	    for (vector<AstVarScope*>::const_iterator it = serialVisitor.varScps().begin();
+		 it != serialVisitor.varScps().end(); ++it) {
+		map<AstVarScope*,int>::iterator vit = varSets.find(*it);
+		if (vit == varSets.end()) varSets.insert(make_pair(*it, set));
+		else processMTasksUnion(vit->second/*ref*/, set);
+	    }
+	    if (serialVisitor.userCall() && v3Global.opt.trace()) {
+		// Public functions and DPI exports set trace activity
+		// themselves, which would race with the other threads
+		UINFO(4,"  No macro-tasks, user call with tracing: "<<lvertexp->nodep()<<endl);
+		m_pmtSets.clear();
+		return;
+	    }
+	}
+    }
+    // Cost of each independent set
+    map<int,int> setCosts;
+    for (size_t i=0; i<logicps.size(); ++i) {
+	EmitCBaseCounterVisitor visitor(logicps[i]->nodep());
+	setCosts[processMTasksFind(i)] += visitor.count();
+    }
+    m_statMTaskSets += setCosts.size();
+    // Largest sets first, each to the least loaded macro-task.
+    // Ties sort by set number, which is graph order, so output is stable.
+    vector<pair<int,int> > bySize;  // -cost, set
+    for (map<int,int>::iterator it = setCosts.begin(); it != setCosts.end(); ++it) {
+	bySize.push_back(make_pair(-it->second, it->first));
+    }
+    sort(bySize.begin(), bySize.end());
+    vector<int> loads (v3Global.opt.threads(), 0);
+    map<int,uint32_t> setMTasks;
+    for (vector<pair<int,int> >::iterator it = bySize.begin(); it != bySize.end(); ++it) {
+	uint32_t leastLoaded = 0;
+	for (uint32_t i=1; i<loads.size(); ++i) {
+	    if (loads[i] < loads[leastLoaded]) leastLoaded = i;
+	}
+	loads[leastLoaded] -= it->first;
+	setMTasks[it->second] = leastLoaded+1;
+	UINFO(5,"    Set "<<it->second<<" cost "<<-it->first<<" to mtask "<<leastLoaded+1<<endl);
+    }
+    for (size_t i=0; i<logicps.size(); ++i) {
+	logicps[i]->mtask(setMTasks[processMTasksFind(i)]);
+    }
+    m_pmtSets.clear();
+}
+
+void OrderVisitor::processMTasksCombine() {
+    // Replace each run of activations under one domain which has more than
+    // one macro-task with a single activation calling one function per
+    // macro-task.  Logic in different macro-tasks is independent, so only
+    // the order within each macro-task needs preserving.
+    for (size_t start=0; start<m_pmtActives.size(); ) {
+	AstActive* firstp = m_pmtActives[start].first;
+	AstSenTree* domainp = firstp->sensesp();
+	size_t end = start;
+	set<uint32_t> mtasks;
+	for (; end<m_pmtActives.size() && m_pmtActives[end].first->sensesp()==domainp; ++end) {
+	    mtasks.insert(m_pmtActives[end].second);
+	}
+	if (mtasks.size() > 1 && !domainp->hasInitial() && !domainp->hasSettle()) {
+	    UINFO(5,"    Parallel "<<firstp<<" mtasks "<<mtasks.size()<<endl);
+	    ++m_statMTaskRuns;
+	    map<uint32_t,AstCFunc*> funcps;  // Sorted by mtask, for stable output
+	    for (size_t i=start; i<end; ++i) {
+		AstActive* activep = m_pmtActives[i].first;
+		AstCFunc*& funcpr = funcps[m_pmtActives[i].second];
+		if (!funcpr) {
+		    AstNodeModule* modp = m_scopetopp->modp();
+		    modp->user3Inc();
+		    string name = "_mtask__"+m_scopetopp->nameDotless()+"__"+cvtToStr(modp->user3());
+		    FileLine* fl = activep->fileline();
+		    funcpr = new AstCFunc(fl, name, m_scopetopp);
+		    funcpr->argTypes("void* __Vvoidp");
+		    funcpr->isMTask(true);
+		    funcpr->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symClassVar()
+						   +" = static_cast<"+EmitCBaseVisitor::symClassName()
+						   +"*>(__Vvoidp);\n"));
+		    funcpr->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symTopAssign()+"\n"));
+		    m_scopetopp->addActivep(funcpr);
+		}
+		funcpr->addStmtsp(activep->stmtsp()->unlinkFrBackWithNext());
+		if (activep != firstp) {
+		    activep->unlinkFrBack();
+		    pushDeletep(activep); activep=NULL;
+		}
+	    }
+	    for (map<uint32_t,AstCFunc*>::iterator it = funcps.begin(); it != funcps.end(); ++it) {
+		AstCCall* callp = new AstCCall(firstp->fileline(), it->second);
+		callp->argTypes("vlSymsp");
+		firstp->addStmtsp(callp);
+	    }
+	}
+	start = end;
+    }
+    m_pmtActives.clear();
+}
+
 //######################################################################
 // Move graph construction
 
@@ -1516,8 +1722,9 @@ void OrderVisitor::processMovePrepScopes() {
 	AstSenTree* domainp = vertexp->logicp()->domainp();
 	AstScope* scopep = vertexp->logicp()->scopep();
 	OrderLoopId inLoop = vertexp->logicp()->inLoop();
+	uint32_t mtask = vertexp->logicp()->mtask();
 	// Create the dom pairing for later lookup
-	OrderMoveDomScope* domScopep = OrderMoveDomScope::findCreate(inLoop, domainp, scopep);
+	OrderMoveDomScope* domScopep = OrderMoveDomScope::findCreate(inLoop, domainp, scopep, mtask);
 	vertexp->domScopep(domScopep);
     }
 }
@@ -1631,6 +1838,7 @@ void OrderVisitor::processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* d
 	    // Where will we be adding the call?
 	    AstActive* callunderp = new AstActive(nodep->fileline(), name, domainp);
 	    processMoveLoopStmt(callunderp);
+	    if (v3Global.opt.threads() > 1) m_pmtActives.push_back(make_pair(callunderp, lvertexp->mtask()));
 	    // Add a top call to it
 	    AstCCall* callp = new AstCCall(nodep->fileline(), m_pomNewFuncp);
 	    callp->argTypes("vlSymsp");
@@ -1789,6 +1997,13 @@ void OrderVisitor::process() {
 
     if (debug() && v3Global.opt.dumpTree()) processEdgeReport();
 
+#ifndef NEW_ORDERING
+    if (v3Global.opt.threads() > 1) {
+	UINFO(2,"  Macro-tasks...\n");
+	processMTasks();
+    }
+#endif
+
     UINFO(2,"  Construct Move Graph...\n");
     processMoveBuildGraph();
     if (debug()>=4) m_pomGraph.dumpDotFilePrefixed("ordermv_start");  // Different prefix (ordermv) as it's not the same graph
@@ -1797,6 +2012,7 @@ void OrderVisitor::process() {
 
     UINFO(2,"  Move...\n");
     processMove();
+    processMTasksCombine();
 
     // Any SC inputs feeding a combo domain must be marked, so we can make them sc_sensitive
     UINFO(2,"  Sensitive...\n");
@@ -201,12 +201,15 @@ public:
 class OrderLogicVertex : public OrderEitherVertex {
     AstNode*		m_nodep;
     OrderMoveVertex*	m_moveVxp;
+    uint32_t		m_mtask;	// Macro-task number for --threads, 0=none
 protected:
     OrderLogicVertex(V3Graph* graphp, const OrderLogicVertex& old)
-	: OrderEitherVertex(graphp, old), m_nodep(old.m_nodep), m_moveVxp(old.m_moveVxp) {}
+	: OrderEitherVertex(graphp, old), m_nodep(old.m_nodep), m_moveVxp(old.m_moveVxp)
+	, m_mtask(old.m_mtask) {}
 public:
     OrderLogicVertex(V3Graph* graphp, AstScope* scopep, AstSenTree* domainp, AstNode* nodep)
-	: OrderEitherVertex(graphp, scopep, domainp), m_nodep(nodep), m_moveVxp(NULL) {}
+	: OrderEitherVertex(graphp, scopep, domainp), m_nodep(nodep), m_moveVxp(NULL)
+	, m_mtask(0) {}
     virtual ~OrderLogicVertex() {}
     virtual OrderLogicVertex* clone(V3Graph* graphp) const {
 	return new OrderLogicVertex(graphp, *this); }
@@ -218,6 +221,8 @@ public:
     virtual string dotColor() const { return "yellow"; }
     OrderMoveVertex*	moveVxp() const { return m_moveVxp; }
     void moveVxp(OrderMoveVertex* moveVxp) { m_moveVxp = moveVxp; }
+    uint32_t mtask() const { return m_mtask; }
+    void mtask(uint32_t num) { m_mtask = num; }
 };
 
 class OrderVarVertex : public OrderEitherVertex {
@@ -20,6 +20,7 @@
 //
 // void example_usage() {
 //	SimulateVisitor simvis (false, false);
+//	simvis.mainTableCompile(nodep);  // Optional, faster when called many times
 //	simvis.clear();
 //	// Set all inputs to the constant
 //	for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
@@ -44,9 +45,345 @@
 #include "V3Task.h"
 
 #include <deque>
+#include <map>
+#include <vector>
 
 //============================================================================
 
+//######################################################################
+// Simulate bytecode
+
+class SimulateCode {
+    // A block that passed SimulateVisitor checking, lowered once into
+    // register-based code over 64 bit words, so that it may be run for
+    // many input values without walking the tree with V3Numbers.
+    // compile() fails on anything it can't represent exactly, such as
+    // 4-state constants, reals, values wider than 64 bits, loops or
+    // jumps; run() returns false when a result would contain X, such
+    // as a select out of range.  The caller then uses the tree walk.
+public:
+    // TYPES
+    enum Op {
+	OP_MOV, OP_NOT, OP_NEGATE, OP_EXTENDS, OP_LOGNOT,
+	OP_REDAND, OP_REDOR, OP_REDXOR, OP_COUNTONES,
+	OP_AND, OP_OR, OP_XOR, OP_ADD, OP_SUB, OP_MUL, OP_MULS,
+	OP_EQ, OP_NEQ, OP_GT, OP_GTE, OP_GTS, OP_GTES,
+	OP_LOGAND, OP_LOGOR, OP_LOGIF,
+	OP_SHIFTL, OP_SHIFTR, OP_SHIFTRS, OP_CONCAT, OP_SEL, OP_COND,
+	OP_SETFLAG, OP_JUMPZ, OP_JUMP
+    };
+    struct Insn {
+	Op		m_op;
+	int		m_dst;		// Destination register, flag number, or jump target
+	int		m_a;		// Operand registers
+	int		m_b;
+	int		m_c;
+	int		m_awidth;	// Width of operand A, for sign extension and reductions
+	int		m_bwidth;	// Width of operand B
+	vluint64_t	m_mask;		// Mask of result width
+    };
+    struct Var {
+	AstNode*	m_nodep;	// AstVarScope
+	int		m_reg;		// Register with current value
+	int		m_outReg;	// Register with delayed assignment value
+	int		m_flag;		// Flag set when assigned
+	bool		m_dly;		// Assigned with delayed assignment
+    };
+private:
+    // MEMBERS
+    AstNode*		m_blockp;	// Block compiled
+    vector<Insn>	m_code;		// Instructions
+    vector<vluint64_t>	m_regs;		// Registers, constants are preloaded
+    vector<bool>	m_flags;	// Variable assigned flags
+    vector<Var>		m_vars;		// Variables referenced
+    map<AstNode*,int>	m_varNums;	// Index into m_vars for each AstVarScope
+    bool		m_ok;		// Compiled successfully so far
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+    bool fail(AstNode* nodep, const char* why) {
+	if (m_ok) UINFO(5,"  Can't compile, "<<why<<": "<<nodep<<endl);
+	m_ok = false;
+	return false;
+    }
+    bool widthOk(AstNode* nodep) {
+	if (nodep->isDouble() || nodep->width()<1 || nodep->width()>VL_QUADSIZE) return fail(nodep, "width");
+	return true;
+    }
+    int newReg(vluint64_t value=0) {
+	m_regs.push_back(value);
+	return (int)m_regs.size()-1;
+    }
+    int emit(Op op, AstNode* nodep, int a=0, int b=0, int c=0, int awidth=0, int bwidth=0) {
+	// Append instruction with result in a new register of nodep's width
+	Insn insn;
+	insn.m_op = op;  insn.m_dst = newReg();
+	insn.m_a = a;  insn.m_b = b;  insn.m_c = c;
+	insn.m_awidth = awidth;  insn.m_bwidth = bwidth;
+	insn.m_mask = VL_MASK_Q(nodep->width());
+	m_code.push_back(insn);
+	return insn.m_dst;
+    }
+    int emitJump(Op op, int a) {
+	// Append jump, target filled in later with setTarget
+	Insn insn;
+	insn.m_op = op;  insn.m_dst = 0;  insn.m_a = a;  insn.m_b = 0;  insn.m_c = 0;
+	insn.m_awidth = 0;  insn.m_bwidth = 0;  insn.m_mask = 0;
+	m_code.push_back(insn);
+	return (int)m_code.size()-1;
+    }
+    void setTarget(int jumppc) { m_code[jumppc].m_dst = (int)m_code.size(); }
+    Var& findVar(AstVarScope* vscp) {
+	map<AstNode*,int>::iterator it = m_varNums.find(vscp);
+	if (it != m_varNums.end()) return m_vars[it->second];
+	Var var;
+	var.m_nodep = vscp;
+	var.m_reg = newReg();
+	var.m_outReg = newReg();
+	var.m_flag = (int)m_flags.size();  m_flags.push_back(false);
+	var.m_dly = false;
+	m_varNums.insert(make_pair((AstNode*)vscp, (int)m_vars.size()));
+	m_vars.push_back(var);
+	return m_vars.back();
+    }
+
+    int compileExpr(AstNode* nodep) {
+	// Return register holding the expression's value, masked to its width
+	if (!m_ok || !widthOk(nodep)) return 0;
+	if (AstConst* constp = nodep->castConst()) {
+	    if (constp->num().isFourState()) { fail(nodep, "4-state"); return 0; }
+	    return newReg(constp->num().toUQuad());
+	}
+	else if (AstVarRef* refp = nodep->castVarRef()) {
+	    if (refp->lvalue() || !refp->varScopep()) { fail(nodep, "varref"); return 0; }
+	    if (refp->varp()->isParam()) {
+		AstConst* constp = refp->varp()->valuep()->castConst();
+		if (!constp || constp->num().isFourState() || constp->width()>VL_QUADSIZE) {
+		    fail(nodep, "param"); return 0;
+		}
+		return newReg(constp->num().toUQuad() & VL_MASK_Q(refp->varp()->width()));
+	    }
+	    if (!widthOk(refp->varScopep())) return 0;
+	    return findVar(refp->varScopep()).m_reg;
+	}
+	else if (AstNodeCond* condp = nodep->castNodeCond()) {
+	    int c = compileExpr(condp->condp());
+	    int a = compileExpr(condp->expr1p());
+	    int b = compileExpr(condp->expr2p());
+	    return emit(OP_COND, nodep, a, b, c);
+	}
+	else if (AstSel* selp = nodep->castSel()) {
+	    AstConst* widthp = selp->widthp()->castConst();
+	    if (!widthp || (int)widthp->toUInt() != selp->width()
+		|| selp->lsbp()->width() > VL_WORDSIZE) { fail(nodep, "sel"); return 0; }
+	    int a = compileExpr(selp->fromp());
+	    int b = compileExpr(selp->lsbp());
+	    return emit(OP_SEL, nodep, a, b, selp->width(), selp->fromp()->width());
+	}
+	else if (AstNodeUniop* unip = nodep->castNodeUniop()) {
+	    Op op;
+	    if (nodep->castNot()) op = OP_NOT;
+	    else if (nodep->castNegate()) op = OP_NEGATE;
+	    else if (nodep->castExtend() || nodep->castSigned() || nodep->castUnsigned()) op = OP_MOV;
+	    else if (nodep->castExtendS()) op = OP_EXTENDS;
+	    else if (nodep->castLogNot()) op = OP_LOGNOT;
+	    else if (nodep->castRedAnd()) op = OP_REDAND;
+	    else if (nodep->castRedOr()) op = OP_REDOR;
+	    else if (nodep->castRedXor()) op = OP_REDXOR;
+	    else if (nodep->castCountOnes()) op = OP_COUNTONES;
+	    else { fail(nodep, "unknown uniop"); return 0; }
+	    int a = compileExpr(unip->lhsp());
+	    return emit(op, nodep, a, 0, 0, unip->lhsp()->width());
+	}
+	else if (AstNodeBiop* bip = nodep->castNodeBiop()) {
+	    AstNode* lhsp = bip->lhsp();
+	    AstNode* rhsp = bip->rhsp();
+	    bool sameWidths = (lhsp->width() == rhsp->width());
+	    bool swap = false;
+	    Op op;
+	    if (nodep->castAnd()) op = OP_AND;
+	    else if (nodep->castOr()) op = OP_OR;
+	    else if (nodep->castXor()) op = OP_XOR;
+	    else if (nodep->castAdd()) op = OP_ADD;
+	    else if (nodep->castSub()) op = OP_SUB;
+	    else if (nodep->castMul()) op = OP_MUL;
+	    else if (nodep->castMulS()) op = OP_MULS;
+	    else if (nodep->castEq()) op = OP_EQ;
+	    else if (nodep->castNeq()) op = OP_NEQ;
+	    else if (nodep->castEqCase() && sameWidths) op = OP_EQ;
+	    else if (nodep->castNeqCase() && sameWidths) op = OP_NEQ;
+	    else if (nodep->castGt()) op = OP_GT;
+	    else if (nodep->castGte()) op = OP_GTE;
+	    else if (nodep->castLt()) { op = OP_GT; swap = true; }
+	    else if (nodep->castLte()) { op = OP_GTE; swap = true; }
+	    // Signed compares sign extend inconsistently when widths differ, so leave to V3Number
+	    else if (nodep->castGtS() && sameWidths) op = OP_GTS;
+	    else if (nodep->castGteS() && sameWidths) op = OP_GTES;
+	    else if (nodep->castLtS() && sameWidths) { op = OP_GTS; swap = true; }
+	    else if (nodep->castLteS() && sameWidths) { op = OP_GTES; swap = true; }
+	    else if (nodep->castLogAnd()) op = OP_LOGAND;
+	    else if (nodep->castLogOr()) op = OP_LOGOR;
+	    else if (nodep->castLogIf()) op = OP_LOGIF;
+	    else if (nodep->castShiftL() && rhsp->width() <= VL_WORDSIZE) op = OP_SHIFTL;
+	    else if (nodep->castShiftR() && rhsp->width() <= VL_WORDSIZE) op = OP_SHIFTR;
+	    else if (nodep->castShiftRS() && rhsp->width() <= VL_WORDSIZE) op = OP_SHIFTRS;
+	    else if (nodep->castConcat()) op = OP_CONCAT;
+	    else { fail(nodep, "unknown biop"); return 0; }
+	    int a = compileExpr(lhsp);
+	    int b = compileExpr(rhsp);
+	    if (swap) return emit(op, nodep, b, a, 0, rhsp->width(), lhsp->width());
+	    return emit(op, nodep, a, b, 0, lhsp->width(), rhsp->width());
+	}
+	else {
+	    fail(nodep, "unknown node");
+	    return 0;
+	}
+    }
+
+    void compileStmts(AstNode* listp) {
+	for (AstNode* nodep = listp; nodep && m_ok; nodep = nodep->nextp()) {
+	    if (nodep->castComment()) {
+	    }
+	    else if (AstBegin* beginp = nodep->castBegin()) {
+		compileStmts(beginp->stmtsp());
+	    }
+	    else if (AstNodeIf* ifp = nodep->castNodeIf()) {
+		int c = compileExpr(ifp->condp());
+		int elsepc = emitJump(OP_JUMPZ, c);
+		compileStmts(ifp->ifsp());
+		int endpc = emitJump(OP_JUMP, 0);
+		setTarget(elsepc);
+		compileStmts(ifp->elsesp());
+		setTarget(endpc);
+	    }
+	    else if (nodep->castAssign() || nodep->castAssignDly()) {
+		AstNodeAssign* assp = nodep->castNodeAssign();
+		AstVarRef* lhsp = assp->lhsp()->castVarRef();
+		if (!lhsp || !lhsp->varScopep()) { fail(nodep, "lhs"); return; }
+		if (!widthOk(lhsp->varScopep())) return;
+		int a = compileExpr(assp->rhsp());
+		Var& var = findVar(lhsp->varScopep());
+		var.m_dly = nodep->castAssignDly();
+		// Copy, and zero extend or truncate to the variable's width
+		Insn insn;
+		insn.m_op = OP_MOV;  insn.m_dst = var.m_dly ? var.m_outReg : var.m_reg;
+		insn.m_a = a;  insn.m_b = 0;  insn.m_c = 0;
+		insn.m_awidth = 0;  insn.m_bwidth = 0;
+		insn.m_mask = VL_MASK_Q(lhsp->varScopep()->width());
+		m_code.push_back(insn);
+		insn.m_op = OP_SETFLAG;  insn.m_dst = var.m_flag;
+		m_code.push_back(insn);
+	    }
+	    else {
+		fail(nodep, "unknown statement");
+	    }
+	}
+    }
+
+    static vluint64_t sext(vluint64_t value, int width) {
+	// Sign extend value of given width to 64 bits
+	if (width >= VL_QUADSIZE) return value;
+	return (value & (VL_ULL(1)<<(width-1))) ? (value | ~VL_MASK_Q(width)) : value;
+    }
+    static int countOnes(vluint64_t value) {
+	int count = 0;
+	for (; value; value &= value-1) ++count;
+	return count;
+    }
+
+public:
+    // CONSTRUCTORS
+    SimulateCode() : m_blockp(NULL), m_ok(false) {}
+    ~SimulateCode() {}
+    // ACCESSORS
+    AstNode* blockp() const { return m_blockp; }
+    vector<Var>& vars() { return m_vars; }
+    vluint64_t& reg(int regnum) { return m_regs[regnum]; }
+    bool flag(int flagnum) const { return m_flags[flagnum]; }
+    int instrs() const { return (int)m_code.size(); }
+    // METHODS
+    bool compile(AstAlways* nodep) {
+	// Lower the block, return true if successful
+	m_ok = true;
+	m_blockp = nodep;
+	compileStmts(nodep->bodysp());
+	if (m_ok) UINFO(5,"  Compiled "<<m_code.size()<<" instructions, "
+			<<m_regs.size()<<" registers: "<<nodep<<endl);
+	return m_ok;
+    }
+    bool run() {
+	// Run the code with inputs already loaded into variable registers
+	for (vector<bool>::iterator it = m_flags.begin(); it != m_flags.end(); ++it) *it = false;
+	vluint64_t* r = &m_regs[0];
+	for (size_t pc = 0; pc < m_code.size(); ) {
+	    const Insn& i = m_code[pc++];
+	    switch (i.m_op) {
+	    case OP_MOV:	r[i.m_dst] = r[i.m_a] & i.m_mask; break;
+	    case OP_NOT:	r[i.m_dst] = ~r[i.m_a] & i.m_mask; break;
+	    case OP_NEGATE:	r[i.m_dst] = (~r[i.m_a] + 1) & i.m_mask; break;
+	    case OP_EXTENDS:	r[i.m_dst] = sext(r[i.m_a], i.m_awidth) & i.m_mask; break;
+	    case OP_LOGNOT:	r[i.m_dst] = !r[i.m_a]; break;
+	    case OP_REDAND:	r[i.m_dst] = (r[i.m_a] == VL_MASK_Q(i.m_awidth)); break;
+	    case OP_REDOR:	r[i.m_dst] = (r[i.m_a] != 0); break;
+	    case OP_REDXOR:	r[i.m_dst] = countOnes(r[i.m_a]) & 1; break;
+	    case OP_COUNTONES:	r[i.m_dst] = countOnes(r[i.m_a]) & i.m_mask; break;
+	    case OP_AND:	r[i.m_dst] = r[i.m_a] & r[i.m_b] & i.m_mask; break;
+	    case OP_OR:		r[i.m_dst] = (r[i.m_a] | r[i.m_b]) & i.m_mask; break;
+	    case OP_XOR:	r[i.m_dst] = (r[i.m_a] ^ r[i.m_b]) & i.m_mask; break;
+	    case OP_ADD:	r[i.m_dst] = (r[i.m_a] + r[i.m_b]) & i.m_mask; break;
+	    // V3Number negates the subtrahend in its own width, then adds
+	    case OP_SUB:	r[i.m_dst] = (r[i.m_a] + ((~r[i.m_b] + 1) & VL_MASK_Q(i.m_bwidth))) & i.m_mask; break;
+	    case OP_MUL:	r[i.m_dst] = (r[i.m_a] * r[i.m_b]) & i.m_mask; break;
+	    case OP_MULS:	r[i.m_dst] = (sext(r[i.m_a], i.m_awidth) * sext(r[i.m_b], i.m_bwidth)) & i.m_mask; break;
+	    case OP_EQ:		r[i.m_dst] = (r[i.m_a] == r[i.m_b]); break;
+	    case OP_NEQ:	r[i.m_dst] = (r[i.m_a] != r[i.m_b]); break;
+	    case OP_GT:		r[i.m_dst] = (r[i.m_a] > r[i.m_b]); break;
+	    case OP_GTE:	r[i.m_dst] = (r[i.m_a] >= r[i.m_b]); break;
+	    case OP_GTS:	r[i.m_dst] = ((vlsint64_t)sext(r[i.m_a], i.m_awidth)
+					      > (vlsint64_t)sext(r[i.m_b], i.m_bwidth)); break;
+	    case OP_GTES:	r[i.m_dst] = ((vlsint64_t)sext(r[i.m_a], i.m_awidth)
+					      >= (vlsint64_t)sext(r[i.m_b], i.m_bwidth)); break;
+	    case OP_LOGAND:	r[i.m_dst] = (r[i.m_a] && r[i.m_b]); break;
+	    case OP_LOGOR:	r[i.m_dst] = (r[i.m_a] || r[i.m_b]); break;
+	    case OP_LOGIF:	r[i.m_dst] = (!r[i.m_a] || r[i.m_b]); break;
+	    // V3Number shifts by amounts this large index out of range, so let it do them
+	    case OP_SHIFTL:
+		if (r[i.m_b] & VL_ULL(0x80000000)) return false;
+		if (r[i.m_b] >= VL_QUADSIZE) { r[i.m_dst] = 0; break; }
+		r[i.m_dst] = (r[i.m_a] << r[i.m_b]) & i.m_mask; break;
+	    case OP_SHIFTR:
+		if (r[i.m_b] & VL_ULL(0x80000000)) return false;
+		if (r[i.m_b] >= VL_QUADSIZE) { r[i.m_dst] = 0; break; }
+		r[i.m_dst] = (r[i.m_a] >> r[i.m_b]) & i.m_mask; break;
+	    case OP_SHIFTRS: {
+		vluint64_t shift = r[i.m_b];
+		if (shift & VL_ULL(0x80000000)) return false;
+		if (shift >= VL_QUADSIZE) shift = VL_QUADSIZE-1;
+		r[i.m_dst] = (vluint64_t)((vlsint64_t)sext(r[i.m_a], i.m_awidth) >> shift) & i.m_mask;
+		break;
+	    }
+	    case OP_CONCAT:	r[i.m_dst] = ((r[i.m_a] << i.m_bwidth) | r[i.m_b]) & i.m_mask; break;
+	    case OP_SEL: {
+		// Bits selected beyond the source are X, which only V3Number represents
+		vluint64_t lsb = r[i.m_b];
+		if (lsb + i.m_c > (vluint64_t)i.m_awidth) return false;
+		r[i.m_dst] = (r[i.m_a] >> lsb) & i.m_mask;
+		break;
+	    }
+	    case OP_COND:	r[i.m_dst] = (r[i.m_c] ? r[i.m_a] : r[i.m_b]) & i.m_mask; break;
+	    case OP_SETFLAG:	m_flags[i.m_dst] = true; break;
+	    case OP_JUMPZ:	if (!r[i.m_a]) pc = i.m_dst; break;
+	    case OP_JUMP:	pc = i.m_dst; break;
+	    }
+	}
+	return true;
+    }
+};
+
 //######################################################################
 // Simulate class functions
 
@@ -90,6 +427,7 @@ private:
     // Simulating:
     deque<V3Number*>	m_numFreeps;	///< List of all numbers free and not in use
     deque<V3Number*>	m_numAllps; 	///< List of all numbers free and in use
+    SimulateCode*	m_codep;	///< Compiled block, or NULL
 
     // Note level 8&9 include debugging each simulation value
     static int debug() {
@@ -192,6 +530,50 @@ private:
 	UINFO(9,"     set num "<<*nump<<" on "<<nodep<<endl);
 	nodep->user2p((AstNUser*)nump);
     }
+    static void setNumberQuad(V3Number* nump, vluint64_t value) {
+	if (nump->width() > VL_WORDSIZE) nump->setQuad(value);
+	else nump->setLong((uint32_t)value);
+    }
+
+    bool loadCode() {
+	// Load inputs into the compiled block's registers, return false if it can't represent them
+	vector<SimulateCode::Var>& vars = m_codep->vars();
+	for (vector<SimulateCode::Var>::iterator it = vars.begin(); it != vars.end(); ++it) {
+	    V3Number* nump = fetchNumberNull(it->m_nodep);
+	    if (nump && nump->isFourState()) return false;
+	    m_codep->reg(it->m_reg) = nump ? nump->toUQuad() : 0;
+	}
+	return true;
+    }
+    void storeCode() {
+	// Set variables from the results of running the compiled block
+	vector<SimulateCode::Var>& vars = m_codep->vars();
+	for (vector<SimulateCode::Var>::iterator it = vars.begin(); it != vars.end(); ++it) {
+	    if (m_codep->flag(it->m_flag)) {
+		vluint64_t value = m_codep->reg(it->m_dly ? it->m_outReg : it->m_reg);
+		setNumberQuad(newOutNumber(it->m_nodep), value);
+		if (!it->m_dly) setNumberQuad(newNumber(it->m_nodep), value);
+	    }
+	}
+    }
+    void checkCode(AstNode* nodep) {
+	// Compare results of the compiled block against those of the tree walk
+	vector<SimulateCode::Var>& vars = m_codep->vars();
+	for (vector<SimulateCode::Var>::iterator it = vars.begin(); it != vars.end(); ++it) {
+	    V3Number* nump = fetchOutNumberNull(it->m_nodep);
+	    bool set = m_codep->flag(it->m_flag);
+	    vluint64_t value = m_codep->reg(it->m_dly ? it->m_outReg : it->m_reg);
+	    if (set != (nump != NULL)
+		|| (nump && (nump->isFourState()
+			     || (nump->toUQuad() & VL_MASK_Q(it->m_nodep->width())) != value))) {
+		ostringstream os;
+		if (set) os<<hex<<value; else os<<"unset";
+		nodep->v3fatalSrc("Table bytecode result "<<os.str()<<" differs from simulation "
+				  <<(nump ? nump->ascii() : string("unset"))
+				  <<" for "<<it->m_nodep->prettyName());
+	    }
+	}
+    }
 
     void checkNodeInfo(AstNode* nodep) {
 	if (m_checkOnly) {
@@ -663,6 +1045,7 @@ private:
 public:
     // CONSTRUCTORS
     SimulateVisitor() {
+	m_codep = NULL;
 	setMode(false,false,false);
 	clear(); // We reuse this structure in the main loop, so put initializers inside clear()
     }
@@ -687,8 +1070,23 @@ public:
 	setMode(true/*scoped*/,true/*checking*/, false/*params*/);
 	mainGuts(nodep);
     }
+    bool mainTableCompile (AstAlways* nodep) {
+	// Lower a block which passed mainTableCheck, so following
+	// mainTableEmulate calls are faster.  Return true if compiled.
+	if (m_codep) { delete m_codep; m_codep = NULL; }
+	m_codep = new SimulateCode;
+	if (!m_codep->compile(nodep)) { delete m_codep; m_codep = NULL; }
+	return m_codep != NULL;
+    }
     void mainTableEmulate (AstNode* nodep) {
 	setMode(true/*scoped*/,false/*checking*/, false/*params*/);
+	if (m_codep && m_codep->blockp() == nodep && loadCode() && m_codep->run()) {
+	    // With --debug-check, also walk the tree, and check the results match
+	    if (!v3Global.opt.debugCheck()) { storeCode(); return; }
+	    mainGuts(nodep);
+	    if (optimizable()) checkCode(nodep);
+	    return;
+	}
 	mainGuts(nodep);
     }
     void mainParamEmulate (AstNode* nodep) {
@@ -696,6 +1094,7 @@ public:
 	mainGuts(nodep);
     }
     virtual ~SimulateVisitor() {
+	if (m_codep) { delete m_codep; m_codep = NULL; }
 	for (deque<V3Number*>::iterator it = m_numAllps.begin(); it != m_numAllps.end(); ++it) {
 	    delete (*it);
 	}
@@ -22,6 +22,8 @@
 //	Count # of input bits and # of output bits, and # of statements
 //	If high # of statements relative to inpbits*outbits,
 //	replace with lookup table
+//	If all outputs plus their change bits fit in 64 bits,
+//	pack them into a single table, one entry per input value
 //
 //*************************************************************************
 
@@ -32,6 +34,7 @@
 #include <unistd.h>
 #include <cmath>
 #include <deque>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3Table.h"
@@ -47,6 +50,7 @@ static const double TABLE_MAX_BYTES = 1*1024*1024;	// 1MB is max table size (bet
 static const double TABLE_TOTAL_BYTES = 64*1024*1024;	// 64MB is close to max memory of some systems (256MB or so), so don't get out of control
 static const double TABLE_SPACE_TIME_MULT = 8;		// Worth 8 bytes of data to replace a instruction
 static const int TABLE_MIN_NODE_COUNT = 32;	// If < 32 instructions, not worth the effort
+static const int TABLE_PACKED_MAX_WIDTH = 64;	// Widest entry for a packed table, so each entry is one QData
 
 //######################################################################
 
@@ -77,6 +81,10 @@ private:
     // STATE
     double	m_totalBytes;		// Total bytes in tables created
     V3Double0	m_statTablesCre;	// Statistic tracking
+    V3Double0	m_statTablesPacked;	// Statistic tracking
+    V3Double0	m_statTablesCompiled;	// Statistic tracking
+    V3Double0	m_statTableBytes;	// Statistic tracking
+    map<string,V3Double0> m_statRejects;	// Statistic tracking, by reason
 
     //  State cleared on each module
     AstNodeModule*	m_modp;		// Current MODULE
@@ -90,9 +98,12 @@ private:
     bool	m_assignDly;		// Consists of delayed assignments instead of normal assignments
     int		m_inWidth;		// Input table width
     int		m_outWidth;		// Output table width
+    int		m_outBits;		// Output bits, sum of all output widths
+    bool	m_packable;		// All outputs may be packed into one table
     deque<AstVarScope*> m_inVarps;	// Input variable list
     deque<AstVarScope*> m_outVarps;	// Output variable list
     deque<bool>    m_outNotSet;		// True if output variable is not set at some point
+    vector<vluint64_t> m_packedValues;	// Packed table values, by input value
 
     // When creating a table
     deque<AstVarScope*> m_tableVarps;	// Table being created
@@ -121,11 +132,22 @@ private:
 	// Also sets m_inVarps
 	// Also sets m_outVarps
 
-	// Calc data storage in bytes
-	size_t chgWidth = m_outVarps.size();	// Width of one change-it-vector
-	if (chgWidth<8) chgWidth = 8;
-	double space = (pow((double)2,((double)(m_inWidth)))
-			*(double)(m_outWidth+chgWidth));
+	bool simulatable = chkvis.optimizable();
+
+	// Can outputs be packed, along with a change bit for each, into one table?
+	m_outBits = 0;
+	m_packable = true;
+	for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
+	    AstVarScope* outvscp = *it;
+	    if (outvscp->width() > TABLE_PACKED_MAX_WIDTH || outvscp->varp()->isDouble()) m_packable = false;
+	    m_outBits += outvscp->width();
+	}
+	if (m_outBits + (int)m_outVarps.size() > TABLE_PACKED_MAX_WIDTH) m_packable = false;
+
+	// Calc data storage in bytes, assuming the worst case of every output needing a change bit
+	double entryBytes = (m_packable ? entryWidthBytes(m_outBits + m_outVarps.size())
+			     : (m_outWidth + entryWidthBytes(m_outVarps.size())));
+	double space = pow((double)2,((double)(m_inWidth))) * entryBytes;
 	// Instruction count bytes (ok, it's space also not time :)
 	double bytesPerInst = 4;
 	double time  = (chkvis.instrCount()*bytesPerInst + chkvis.dataCount()) + 1;  // +1 so won't div by zero
@@ -146,16 +168,44 @@ private:
 	}
 	UINFO(4, "  Test: Opt="<<(chkvis.optimizable()?"OK":"NO")
 	      <<", Instrs="<<chkvis.instrCount()<<" Data="<<chkvis.dataCount()
-	      <<" inw="<<m_inWidth<<" outw="<<m_outWidth
+	      <<" inw="<<m_inWidth<<" outw="<<m_outWidth<<" packed="<<m_packable
 	      <<" Spacetime="<<(space/time)<<"("<<space<<"/"<<time<<")"
 	      <<": "<<nodep<<endl);
 	if (chkvis.optimizable()) {
 	    UINFO(3, " Table Optimize spacetime="<<(space/time)<<" "<<nodep<<endl);
 	    m_totalBytes += space;
 	}
+	statTest(nodep, chkvis, simulatable, space);
 	return chkvis.optimizable();
     }
 
+    void statTest(AstAlways* nodep, const TableSimulateVisitor& chkvis, bool simulatable, double space) {
+	// Record why each candidate was or wasn't made into a table, so the cost model may be tuned.
+	// Blocks that can't be simulated aren't candidates, so are only counted.
+	string outcome;
+	if (!simulatable) outcome = "rejected, not simulatable";
+	else if (!chkvis.optimizable()) {
+	    string why = chkvis.whyNotMessage();
+	    if (why.substr(0,6) == "Table ") why = why.substr(6);
+	    outcome = "rejected, "+why;
+	} else outcome = m_packable ? "created packed" : "created";
+	if (!chkvis.optimizable()) ++m_statRejects[outcome];
+	if (simulatable && chkvis.instrCount() >= TABLE_MIN_NODE_COUNT) {
+	    V3Stats::addStat("Optimizations, Table "+nodep->fileline()->ascii()+" "+outcome
+			     +", inputs "+cvtToStr(m_inWidth)+" instrs "+cvtToStr(chkvis.instrCount())
+			     +", bytes", space);
+	}
+    }
+
+    static int entryWidthBytes(int width) {
+	// Bytes for one table entry of the given width, as the C++ will declare it
+	if (width <= 8) return 1;
+	else if (width <= 16) return 2;
+	else if (width <= VL_WORDSIZE) return 4;
+	else if (width <= VL_QUADSIZE) return 8;
+	else return VL_WORDS_I(width)*(VL_WORDSIZE/8);
+    }
+
 public:
     void simulateVarRefCb(AstVarRef* nodep) {
 	// Called by TableSimulateVisitor on each unique varref enountered
@@ -185,7 +235,27 @@ private:
 	m_modp->addStmtp(indexVarp);
 	AstVarScope* indexVscp = new AstVarScope (indexVarp->fileline(), m_scopep, indexVarp);
 	m_scopep->addVarp(indexVscp);
+	AstNode* stmtsp = createLookupInput(nodep, indexVscp);
+
+	if (m_packable) {
+	    createPackedTable(nodep, stmtsp, indexVscp);
+	} else {
+	    createUnpackedTables(nodep, stmtsp, indexVscp);
+	}
+
+	// Link it in.
+	if (AstAlways* nodeap = nodep->castAlways()) {
+	    // Keep sensitivity list, but delete all else
+	    nodeap->bodysp()->unlinkFrBackWithNext()->deleteTree();
+	    nodeap->addStmtp(stmtsp);
+	    if (debug()>=6) nodeap->dumpTree(cout,"  table_new: ");
+	} else {
+	    nodep->v3fatalSrc("Creating table under unknown node type");
+	}
+    }
 
+    void createUnpackedTables(AstAlways* nodep, AstNode* stmtsp, AstVarScope* indexVscp) {
+	// A table for each output, and a table of which outputs change
 	// Change it variable
 	FileLine* fl = nodep->fileline();
 	AstNodeDType* dtypep
@@ -199,13 +269,13 @@ private:
 			  "__Vtablechg" + cvtToStr(m_modTables),
 			  dtypep);
 	chgVarp->isConst(true);
+	chgVarp->isStatic(true);
 	chgVarp->valuep(new AstInitArray (nodep->fileline(), NULL));
 	m_modp->addStmtp(chgVarp);
 	AstVarScope* chgVscp = new AstVarScope (chgVarp->fileline(), m_scopep, chgVarp);
 	m_scopep->addVarp(chgVscp);
 
 	createTableVars(nodep);
-	AstNode* stmtsp = createLookupInput(nodep, indexVscp);
 	createTableValues(nodep, chgVscp);
 
 	// Collapse duplicate tables
@@ -215,21 +285,85 @@ private:
 	}
 
 	createOutputAssigns(nodep, stmtsp, indexVscp, chgVscp);
-
-	// Link it in.
-	if (AstAlways* nodeap = nodep->castAlways()) {
-	    // Keep sensitivity list, but delete all else
-	    nodeap->bodysp()->unlinkFrBackWithNext()->deleteTree();
-	    nodeap->addStmtp(stmtsp);
-	    if (debug()>=6) nodeap->dumpTree(cout,"  table_new: ");
-	} else {
-	    nodep->v3fatalSrc("Creating table under unknown node type");
-	}
+	m_statTableBytes += (double)(VL_MASK_I(m_inWidth)+1) * (m_outWidth + entryWidthBytes(m_outVarps.size()));
 
 	// Cleanup internal structures
 	m_tableVarps.clear();
     }
 
+    void createPackedTable(AstAlways* nodep, AstNode* stmtsp, AstVarScope* indexVscp) {
+	// One table holding all outputs, LSB first, then a change bit for
+	// each output that isn't set for some input value.  This needs only
+	// one AstConst per input value, and one load per evaluation.
+	++m_statTablesPacked;
+	FileLine* fl = nodep->fileline();
+	createPackedValues(nodep);
+
+	vector<int> chgBits;  // Bit in table entry that output changed, or -1 if always changes
+	int width = m_outBits;
+	for (deque<bool>::iterator it = m_outNotSet.begin(); it!=m_outNotSet.end(); ++it) {
+	    chgBits.push_back(*it ? width++ : -1);
+	}
+
+	AstNodeDType* dtypep
+	    = new AstUnpackArrayDType (fl,
+				       nodep->findBitDType(width, width, AstNumeric::UNSIGNED),
+				       new AstRange (fl, VL_MASK_I(m_inWidth), 0));
+	v3Global.rootp()->typeTablep()->addTypesp(dtypep);
+	AstVar* tablevarp
+	    = new AstVar (fl, AstVarType::MODULETEMP,
+			  "__Vtable" + cvtToStr(m_modTables),
+			  dtypep);
+	tablevarp->isConst(true);
+	tablevarp->isStatic(true);
+	AstInitArray* initp = new AstInitArray (fl, NULL);
+	tablevarp->valuep(initp);
+	m_modp->addStmtp(tablevarp);
+	AstVarScope* tablevscp = new AstVarScope(tablevarp->fileline(), m_scopep, tablevarp);
+	m_scopep->addVarp(tablevscp);
+
+	for (uint32_t inValue=0; inValue <= VL_MASK_I(m_inWidth); inValue++) {
+	    vluint64_t value = m_packedValues[inValue];
+	    vluint64_t chgMask = m_packedValues[inValue + VL_MASK_I(m_inWidth) + 1];
+	    for (int outnum=0; outnum<(int)chgBits.size(); ++outnum) {
+		if (chgBits[outnum] >= 0 && ((chgMask >> outnum) & 1)) {
+		    value |= VL_ULL(1) << chgBits[outnum];
+		}
+	    }
+	    V3Number num (fl, width, 0);
+	    if (width > VL_WORDSIZE) num.setQuad(value);
+	    else num.setLong((uint32_t)value);
+	    initp->addInitsp(new AstConst (fl, num));
+	}
+	m_packedValues.clear();
+	tablevscp = findDuplicateTable(tablevscp);
+	m_statTableBytes += (double)(VL_MASK_I(m_inWidth)+1) * entryWidthBytes(width);
+
+	// Set each output from its bits of the table entry
+	int lsb = 0;
+	int outnum = 0;
+	for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
+	    AstVarScope* outvscp = *it;
+	    AstNode* alhsp = new AstVarRef(fl, outvscp, true);
+	    AstNode* arhsp = new AstSel(fl, new AstArraySel(fl, new AstVarRef(fl, tablevscp, false),
+							    new AstVarRef(fl, indexVscp, false)),
+					lsb, outvscp->width());
+	    AstNode* outsetp = (m_assignDly
+				? (AstNode*)(new AstAssignDly (fl, alhsp, arhsp))
+				: (AstNode*)(new AstAssign (fl, alhsp, arhsp)));
+	    if (chgBits[outnum] >= 0) {
+		outsetp = new AstIf (fl,
+				     new AstSel(fl, new AstArraySel(fl, new AstVarRef(fl, tablevscp, false),
+								    new AstVarRef(fl, indexVscp, false)),
+						chgBits[outnum], 1),
+				     outsetp, NULL);
+	    }
+	    stmtsp->addNext(outsetp);
+	    lsb += outvscp->width();
+	    outnum++;
+	}
+    }
+
     void createTableVars(AstNode* nodep) {
 	// Create table for each output
 	for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
@@ -273,6 +407,65 @@ private:
 	return stmtsp;
     }
 
+    void simulateInput(TableSimulateVisitor& simvis, AstAlways* nodep, uint32_t inValue) {
+	// Simulate the block with inputs set from the given table index
+	UINFO(8," Simulating "<<hex<<inValue<<endl);
+
+	// Above simulateVisitor clears user 3, so
+	// all outputs default to NULL to mean 'recirculating'.
+	simvis.clear();
+
+	// Set all inputs to the constant
+	uint32_t shift = 0;
+	for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
+	    AstVarScope* invscp = *it;
+	    // LSB is first variable, so extract it that way
+	    simvis.newNumber(invscp, VL_MASK_I(invscp->width()) & (inValue>>shift));
+	    shift += invscp->width();
+	    // We're just using32 bit arithmetic, because there's no way the input table can be 2^32 bytes!
+	    if (shift>31) nodep->v3fatalSrc("shift overflow");
+	    UINFO(8,"   Input "<<invscp->name()<<" = "<<*(simvis.fetchNumber(invscp))<<endl);
+	}
+
+	// Simulate
+	simvis.mainTableEmulate(nodep);
+	if (!simvis.optimizable()) simvis.whyNotNodep()->v3fatalSrc("Optimizable cleared, even though earlier test run said not: "<<simvis.whyNotMessage());
+    }
+
+    void createPackedValues(AstAlways* nodep) {
+	// Simulate each input value into m_packedValues, with the packed
+	// outputs for every input value, followed by masks of outputs set
+	uint32_t entries = VL_MASK_I(m_inWidth)+1;
+	m_outNotSet.assign(m_outVarps.size(), false);
+	m_packedValues.assign(2*(size_t)entries, 0);
+	TableSimulateVisitor simvis (this);
+	if (simvis.mainTableCompile(nodep)) ++m_statTablesCompiled;
+	for (uint32_t inValue=0; inValue < entries; inValue++) {
+	    simulateInput(simvis, nodep, inValue);
+	    vluint64_t value = 0;
+	    vluint64_t chgMask = 0;
+	    int lsb = 0;
+	    int outnum = 0;
+	    for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
+		AstVarScope* outvscp = *it;
+		V3Number* outnump = simvis.fetchOutNumberNull(outvscp);
+		if (!outnump) {
+		    // Value in table is arbitrary, leave zero
+		    m_outNotSet[outnum] = true;
+		} else if (outnump->isFourState()) {
+		    outvscp->v3error("Unsupported: 4-state numbers in this context");
+		} else {
+		    value |= (outnump->toUQuad() & VL_MASK_Q(outvscp->width())) << lsb;
+		    chgMask |= VL_ULL(1) << outnum;
+		}
+		lsb += outvscp->width();
+		outnum++;
+	    }
+	    m_packedValues[inValue] = value;
+	    m_packedValues[inValue + entries] = chgMask;
+	}
+    }
+
     void createTableValues(AstAlways* nodep, AstVarScope* chgVscp) {
 	// Create table
 	// There may be a simulation path by which the output doesn't change value.
@@ -283,29 +476,9 @@ private:
 	}
 	uint32_t inValueNextInitArray=0;
 	TableSimulateVisitor simvis (this);
+	if (simvis.mainTableCompile(nodep)) ++m_statTablesCompiled;
 	for (uint32_t inValue=0; inValue <= VL_MASK_I(m_inWidth); inValue++) {
-	    // Make a new simulation structure so we can set new input values
-	    UINFO(8," Simulating "<<hex<<inValue<<endl);
-
-	    // Above simulateVisitor clears user 3, so
-	    // all outputs default to NULL to mean 'recirculating'.
-	    simvis.clear();
-
-	    // Set all inputs to the constant
-	    uint32_t shift = 0;
-	    for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
-		AstVarScope* invscp = *it;
-		// LSB is first variable, so extract it that way
-		simvis.newNumber(invscp, VL_MASK_I(invscp->width()) & (inValue>>shift));
-		shift += invscp->width();
-		// We're just using32 bit arithmetic, because there's no way the input table can be 2^32 bytes!
-		if (shift>31) nodep->v3fatalSrc("shift overflow");
-		UINFO(8,"   Input "<<invscp->name()<<" = "<<*(simvis.fetchNumber(invscp))<<endl);
-	    }
-
-	    // Simulate
-	    simvis.mainTableEmulate(nodep);
-	    if (!simvis.optimizable()) simvis.whyNotNodep()->v3fatalSrc("Optimizable cleared, even though earlier test run said not: "<<simvis.whyNotMessage());
+	    simulateInput(simvis, nodep, inValue);
 
 	    // If a output changed, add it to table
 	    int outnum = 0;
@@ -444,11 +617,19 @@ public:
 	m_assignDly = 0;
 	m_inWidth = 0;
 	m_outWidth = 0;
+	m_outBits = 0;
+	m_packable = false;
 	m_totalBytes = 0;
 	nodep->accept(*this);
     }
     virtual ~TableVisitor() {
 	V3Stats::addStat("Optimizations, Tables created", m_statTablesCre);
+	V3Stats::addStat("Optimizations, Tables packed", m_statTablesPacked);
+	V3Stats::addStat("Optimizations, Tables compiled", m_statTablesCompiled);
+	V3Stats::addStat("Optimizations, Tables bytes", m_statTableBytes);
+	for (map<string,V3Double0>::iterator it = m_statRejects.begin(); it!=m_statRejects.end(); ++it) {
+	    V3Stats::addStat("Optimizations, Tables "+it->first, it->second);
+	}
     }
 };
 
@@ -476,12 +476,14 @@ private:
 	// Convert complicated outputs to temp signals
 
 	V3TaskConnects tconnects = V3Task::taskConnects(refp, refp->taskp()->stmtsp());
+	map<AstArg*,AstVar*> openArgs;  // DPI open array arguments, which also pass bounds
 	for (V3TaskConnects::iterator it=tconnects.begin(); it!=tconnects.end(); ++it) {
 	    AstVar* portp = it->first;
 	    AstNode* pinp = it->second->exprp();
 	    if (!pinp) {
 		// Too few arguments in function call
 	    } else {
+		if (portp->isDpiOpenArray()) openArgs[it->second] = portp;
 		UINFO(9, "     Port "<<portp<<endl);
 		UINFO(9, "      pin "<<pinp<<endl);
 		if ((portp->isInout()||portp->isOutput()) && pinp->castConst()) {
@@ -538,6 +540,13 @@ private:
 	    AstNode* exprp = pinp->castArg()->exprp();
 	    exprp->unlinkFrBack();
 	    ccallp->addArgsp(exprp);
+	    if (AstVar* portp = openArgs[pinp->castArg()]) {
+		// Bounds of the connected array follow it; V3Width checked it's a whole unpacked array
+		AstUnpackArrayDType* adtypep = exprp->castNodeVarRef()->varp()->dtypeSkipRefp()->castUnpackArrayDType();
+		if (!adtypep) portp->v3fatalSrc("DPI open array not connected to an unpacked array");
+		ccallp->addArgsp(new AstConst(exprp->fileline(), adtypep->declRange().left()));
+		ccallp->addArgsp(new AstConst(exprp->fileline(), adtypep->declRange().right()));
+	    }
 	}
 
 	if (outvscp) {
@@ -644,22 +653,32 @@ private:
 	return newp;
     }
 
-    AstCFunc* makeDpiExportWrapper(AstNodeFTask* nodep, AstVar* rtnvarp) {
+    AstCFunc* makeDpiExportWrapper(AstNodeFTask* nodep, AstVar* rtnvarp, bool direct) {
+	// If direct, the wrapper is called with a handle from {cname}__Vhandle,
+	// already bound to one scope, so skips the scope and function lookup
 	string dpiproto = dpiprotoName(nodep,rtnvarp);
+	string cname = nodep->cname() + (direct ? "__Vdirect" : "");
 
 	AstCFunc* dpip = new AstCFunc(nodep->fileline(),
-				      nodep->cname(),
+				      cname,
 				      m_scopep,
 				      (rtnvarp ? rtnvarp->dpiArgType(true,true) : ""));
 	dpip->dontCombine(true);
 	dpip->entryPoint(true);
 	dpip->isStatic(true);
 	dpip->dpiExportWrapper(true);
-	dpip->cname(nodep->cname());
+	dpip->dpiExportDirect(direct);
+	dpip->cname(cname);
+	if (direct) dpip->argTypes("const "+nodep->cname()+"__Vhandle_t* __Vhandlep");
 	// Add DPI reference to top, since it's a global function
 	m_topScopep->scopep()->addActivep(dpip);
 
-	{// Create dispatch wrapper
+	string cbtype = v3Global.opt.prefix()+"__Vcb_"+nodep->cname()+"_t";
+	if (direct) {
+	    // Handle holds the callback and symbol table exportFind would give
+	    string stmt = cbtype+" __Vcb = ("+cbtype+")(__Vhandlep->m_cbp);\n";
+	    dpip->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
+	} else {// Create dispatch wrapper
 	    // Note this function may dispatch to myfunc on a different class.
 	    // Thus we need to be careful not to assume a particular function layout.
 	    //
@@ -675,7 +694,6 @@ private:
 	    // If the find fails, it will throw an error
 	    stmt += "const VerilatedScope* __Vscopep = Verilated::dpiScope();\n";
 	    // If dpiScope is fails and is null; the exportFind function throws and error
-	    string cbtype = v3Global.opt.prefix()+"__Vcb_"+nodep->cname()+"_t";
 	    stmt += cbtype+" __Vcb = ("+cbtype+")__Vscopep->exportFind(__Vfuncnum);\n";
 	    // If __Vcb is null the exportFind function throws and error
 	    dpip->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
@@ -683,7 +701,11 @@ private:
 
 	// Convert input/inout DPI arguments to Internal types
 	string args;
-	args += "("+v3Global.opt.prefix()+"__Syms*)(__Vscopep->symsp())";  // Upcast w/o overhead
+	if (direct) {
+	    args += "("+v3Global.opt.prefix()+"__Syms*)(__Vhandlep->m_symsp)";
+	} else {
+	    args += "("+v3Global.opt.prefix()+"__Syms*)(__Vscopep->symsp())";  // Upcast w/o overhead
+	}
 	AstNode* argnodesp = NULL;
 	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
 	    if (AstVar* portp = stmtp->castVar()) {
@@ -778,6 +800,22 @@ private:
 		    bool bitvec = (portp->basicp()->isBitLogic() && portp->width() > 32);
 
 		    if (args != "") { args+= ", "; }
+		    if (portp->isDpiOpenArray()) {
+			// Wrap the caller's storage; the callee reads and writes it in place
+			stmtp = stmtp->nextp();  // __Vleft
+			stmtp = stmtp->nextp();  // __Vright
+			if (!stmtp || stmtp->name() != portp->name()+"__Vright") portp->v3fatalSrc("DPI open array missing bounds");
+			AstBasicDType* basicp = portp->basicp();
+			int packedLeft = basicp->isRanged() ? basicp->left() : portp->width()-1;
+			int packedRight = basicp->isRanged() ? basicp->right() : 0;
+			string stmt = ("VerilatedDpiOpenVar "+portp->name()+"__Vcvt ("
+				       +portp->name()+", "+portp->vlEnumType()+", 2, "
+				       +cvtToStr(packedLeft)+", "+cvtToStr(packedRight)+", "
+				       +portp->name()+"__Vleft, "+portp->name()+"__Vright);\n");
+			cfuncp->addStmtsp(new AstCStmt(portp->fileline(), stmt));
+			args += "(svOpenArrayHandle)&"+portp->name()+"__Vcvt";
+			continue;
+		    }
 		    if (bitvec) {}
 		    else if (portp->isOutput()) args += "&";
 		    else if (portp->basicp() && portp->basicp()->isBitLogic() && portp->width() != 1) args += "&";  // it's a svBitVecVal
@@ -810,7 +848,8 @@ private:
 	// Convert output/inout arguments back to internal type
 	for (AstNode* stmtp = cfuncp->argsp(); stmtp; stmtp=stmtp->nextp()) {
 	    if (AstVar* portp = stmtp->castVar()) {
-		if (portp->isIO() && (portp->isOutput() || portp->isFuncReturn())) {
+		if (portp->isIO() && (portp->isOutput() || portp->isFuncReturn())
+		    && !portp->isDpiOpenArray()) {  // Already written in place
 		    AstVarScope* portvscp = portp->user2p()->castNode()->castVarScope();  // Remembered when we created it earlier
 		    cfuncp->addStmtsp(createAssignDpiToInternal(portvscp,portp->name()+"__Vcvt",true));
 		}
@@ -896,6 +935,7 @@ private:
 	}
 
 	AstCFunc* dpip = NULL;
+	AstCFunc* directp = NULL;  // DPI export wrapper called through a handle
 	string dpiproto;
 	if (nodep->dpiImport() || nodep->dpiExport()) {
 	    dpiproto = dpiprotoName(nodep, rtnvarp);
@@ -908,7 +948,8 @@ private:
 		if (nodep->dpiImport()) {
 		    dpip = makeDpiImportWrapper(nodep, rtnvarp);
 		} else if (nodep->dpiExport()) {
-		    dpip = makeDpiExportWrapper(nodep, rtnvarp);
+		    dpip = makeDpiExportWrapper(nodep, rtnvarp, false);
+		    directp = makeDpiExportWrapper(nodep, rtnvarp, true);
 		    cfuncp->addInitsp(new AstComment(dpip->fileline(), (string)("Function called from: ")+dpip->cname()));
 		}
 
@@ -932,11 +973,17 @@ private:
 		    cfuncp->addArgsp(portp);
 		    if (dpip) {
 			dpip->addArgsp(portp->cloneTree(false));
+			if (directp) directp->addArgsp(portp->cloneTree(false));
 			if (!portp->basicp() || portp->basicp()->keyword().isDpiUnsupported()) {
 			    portp->v3error("Unsupported: DPI argument of type "<<portp->basicp()->prettyTypeName()<<endl
 					   <<portp->warnMore()<<"... For best portability, use bit, byte, int, or longint");
 			}
 		    }
+		    if (portp->isDpiOpenArray()) {
+			// Caller passes the array's unpacked bounds; see bodyDpiImportFunc
+			createInputVar (cfuncp, portp->name()+"__Vleft", AstBasicDTypeKwd::INT);
+			createInputVar (cfuncp, portp->name()+"__Vright", AstBasicDTypeKwd::INT);
+		    }
 		} else {
 		    // "Normal" variable, mark inside function
 		    portp->funcLocal(true);
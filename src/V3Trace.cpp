@@ -28,6 +28,11 @@
 //	then all functions for that call can get the same activity code.
 //	Likewise, all _slow functions can get the same code.
 //	CFUNCs that are public need unique codes, as does _eval
+//	With --threads, calls under macro-tasks get the code of the call
+//	dispatching the macro-task, as the threads would race to set it.
+//	With --trace-max-activity, IF branches that set traced variables
+//	may also get codes, so those traces are only checked if the branch
+//	ran; branches setting the most traced variables win the codes.
 //
 //	For each CFUNC with unique callReason
 //		Make vertex
@@ -69,6 +74,7 @@ class TraceActivityVertex : public V3GraphVertex {
     vlsint32_t	m_activityCode;
     bool	m_activityCodeValid;
     bool	m_slow;		// If always slow, we can use the same code
+    bool	m_fine;		// For an IF branch, from --trace-max-activity
 public:
     enum { ACTIVITY_NEVER =((1UL<<31) - 1) };
     enum { ACTIVITY_ALWAYS=((1UL<<31) - 2) };
@@ -78,12 +84,14 @@ public:
 	m_activityCode = 0;
 	m_activityCodeValid = false;
 	m_slow = slow;
+	m_fine = false;
     }
     TraceActivityVertex(V3Graph* graphp, vlsint32_t code)
 	: V3GraphVertex(graphp), m_insertp(NULL) {
 	m_activityCode = code;
 	m_activityCodeValid = true;
 	m_slow = false;
+	m_fine = false;
     }
     virtual ~TraceActivityVertex() {}
     // Accessors
@@ -102,6 +110,8 @@ public:
     void activityCode(vlsint32_t code) { m_activityCode=code; m_activityCodeValid=true;}
     bool slow() const { return m_slow; }
     void slow(bool flag) { if (!flag) m_slow=false; }
+    bool fine() const { return m_fine; }
+    void fine(bool flag) { m_fine=flag; }
 };
 
 class TraceCFuncVertex : public V3GraphVertex {
@@ -146,6 +156,33 @@ public:
     virtual string dotColor() const { return "skyblue"; }
 };
 
+//######################################################################
+// Find functions called, directly or not, by macro-tasks
+
+class TraceMTaskCallsVisitor : public AstNVisitor {
+private:
+    // STATE
+    set<AstCFunc*>&	m_funcsr;	// Functions found
+    // VISITORS
+    virtual void visit(AstCFunc* nodep, AstNUser*) {
+	if (nodep->isMTask()) nodep->iterateChildren(*this);  // Others are only reached via calls
+    }
+    virtual void visit(AstCCall* nodep, AstNUser*) {
+	if (m_funcsr.insert(nodep->funcp()).second) nodep->funcp()->iterateChildren(*this);
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstNode* nodep, AstNUser*) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    TraceMTaskCallsVisitor(AstNode* nodep, set<AstCFunc*>& funcsr)
+	: m_funcsr(funcsr) {
+	nodep->accept(*this);
+    }
+    virtual ~TraceMTaskCallsVisitor() {}
+};
+
 //######################################################################
 // Trace state, as a visitor of each AstNode
 
@@ -184,10 +221,19 @@ private:
     TraceActivityVertex* m_alwaysVtxp;	// "Always trace" vertex
     bool		m_finding;	// Pass one of algorithm?
     int			m_funcNum;	// Function number being built
+    set<AstCFunc*>	m_mtaskFuncps;	// Functions run by --threads workers
+    vector<pair<AstTraceDecl*,AstTraceDecl*> > m_dupDecls;	// Duplicate decl, and master decl to copy code from
+    bool		m_fineOk;	// Function may have activity codes for IF branches
+    TraceActivityVertex* m_fineVtxp;	// Activity of IF branch we're under, or NULL for function
+    vector<pair<TraceActivityVertex*,V3GraphVertex*> > m_fineVtxps;	// Branch activities, and vertex that sets its variables if not kept
 
     V3Double0		m_statChgSigs;	// Statistic tracking
     V3Double0		m_statUniqSigs;	// Statistic tracking
     V3Double0		m_statUniqCodes;// Statistic tracking
+    V3Double0		m_statActivity;	// Statistic tracking
+    V3Double0		m_statFineActivity;	// Statistic tracking
+    V3Double0		m_statChgAlways;	// Statistic tracking
+    V3Double0		m_statChgSkippable;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -235,6 +281,35 @@ private:
 	hashed.clear();
     }
 
+    void fineActivityPrune() {
+	// Keep activity codes for the branches setting the most traced
+	// variables.  Others' variables are set by their enclosing branch,
+	// or function; innermost are merged first so chains collapse.
+	vector<pair<size_t,size_t> > order;  // Variables set, index
+	for (size_t i=0; i<m_fineVtxps.size(); ++i) {
+	    set<V3GraphVertex*> varps;
+	    for (V3GraphEdge* edgep = m_fineVtxps[i].first->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		varps.insert(edgep->top());
+	    }
+	    if (!varps.empty()) order.push_back(make_pair(varps.size(), m_fineVtxps.size()-i));
+	}
+	sort(order.begin(), order.end());
+	set<TraceActivityVertex*> keeps;
+	for (vector<pair<size_t,size_t> >::reverse_iterator it = order.rbegin(); it != order.rend(); ++it) {
+	    if ((int)keeps.size() >= v3Global.opt.traceMaxActivity()) break;
+	    keeps.insert(m_fineVtxps[m_fineVtxps.size()-it->second].first);
+	}
+	for (size_t i=m_fineVtxps.size(); i-- > 0; ) {
+	    TraceActivityVertex* vtxp = m_fineVtxps[i].first;
+	    if (keeps.find(vtxp) != keeps.end()) continue;
+	    for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		new V3GraphEdge(&m_graph, m_fineVtxps[i].second, edgep->top(), 1);
+	    }
+	    vtxp->unlinkDelete(&m_graph);
+	}
+	m_fineVtxps.clear();
+    }
+
     void graphSimplify() {
 	// Remove all variable nodes
 	for (V3GraphVertex* nextp, *itp = m_graph.verticesBeginp(); itp; itp=nextp) {
@@ -303,6 +378,8 @@ private:
 			vvertexp->activityCode(TraceActivityVertex::ACTIVITY_SLOW);
 		    } else {
 			vvertexp->activityCode(activityNumber++);
+			++m_statActivity;
+			if (vvertexp->fine()) ++m_statFineActivity;
 		    }
 		}
 	    }
@@ -435,6 +512,11 @@ private:
 	    }
 	    AstNode* addp = assignTraceCode(vvertexp, vvertexp->nodep(), needChg);
 	    if (addp) {	 // Else no activity or duplicate
+		if (actset.find(TraceActivityVertex::ACTIVITY_ALWAYS) != actset.end()) {
+		    ++m_statChgAlways;
+		} else {
+		    ++m_statChgSkippable;
+		}
 		if (actset.find(TraceActivityVertex::ACTIVITY_NEVER) != actset.end()) {
 		    vvertexp->nodep()->v3fatalSrc("If never, needChg=0 and shouldn't need to add.");
 		} else if (actset.find(TraceActivityVertex::ACTIVITY_ALWAYS) != actset.end()) {
@@ -465,6 +547,13 @@ private:
 	    }
 	}
 
+	// Duplicates seen before their master get the master's code only now,
+	// so each activity group's codes stay contiguous
+	for (vector<pair<AstTraceDecl*,AstTraceDecl*> >::iterator it = m_dupDecls.begin(); it!=m_dupDecls.end(); ++it) {
+	    it->first->code(assignDeclCode(it->second));
+	}
+	m_dupDecls.clear();
+
 	// Set in initializer
 
 	// Clear activity after tracing completes
@@ -499,10 +588,15 @@ private:
 		  <<" "<<dupvertexp<<endl);
 	}
 	if (dupvertexp != vvertexp) {
-	    // It's an exact copy.  We'll assign the code to the master on
-	    // the first one we hit; the later ones will share the code.
-	    codePreassigned = assignDeclCode(dupvertexp->nodep()->declp());
-	    nodep->declp()->code(codePreassigned);
+	    // It's an exact copy.  The master assigns the code when we hit
+	    // it; copies found earlier share the code once all are assigned.
+	    codePreassigned = dupvertexp->nodep()->declp()->code();
+	    if (codePreassigned) {
+		nodep->declp()->code(codePreassigned);
+	    } else {
+		codePreassigned = 1;  // Any nonzero; real code set after sorting
+		m_dupDecls.push_back(make_pair(nodep->declp(), dupvertexp->nodep()->declp()));
+	    }
 	} else {
 	    assignDeclCode(nodep->declp());
 	}
@@ -560,6 +654,9 @@ private:
 	// Make a always vertex
 	m_alwaysVtxp = new TraceActivityVertex(&m_graph, TraceActivityVertex::ACTIVITY_ALWAYS);
 
+	// Functions that mustn't set activity themselves
+	TraceMTaskCallsVisitor mtaskVisitor (nodep, m_mtaskFuncps);
+
 	// Add vertexes for all TRACES, and edges from VARs each trace looks at
 	m_finding = false;
 	nodep->iterateChildren(*this);
@@ -568,6 +665,7 @@ private:
 	m_finding = true;
 	nodep->iterateChildren(*this);
 	m_finding = false;
+	fineActivityPrune();
 
 	// Detect and remove duplicate values
 	detectDuplicates();
@@ -593,7 +691,8 @@ private:
     }
     virtual void visit(AstCCall* nodep, AstNUser*) {
 	UINFO(8,"   CCALL "<<nodep<<endl);
-	if (!m_finding && !nodep->user2()) {
+	if (!m_finding && !nodep->user2()
+	    && !m_mtaskFuncps.count(m_funcp)) {  // Else activity set where macro-task dispatched
 	    // See if there are other calls in same statement list;
 	    // If so, all funcs might share the same activity code
 	    TraceActivityVertex* activityVtxp = getActivityVertexp(nodep, nodep->funcp()->slow());
@@ -601,6 +700,14 @@ private:
 		if (AstCCall* ccallp = nextp->castCCall()) {
 		    ccallp->user2(true); // Processed
 		    UINFO(8,"     SubCCALL "<<ccallp<<endl);
+		    if (ccallp->funcp()->isMTask()) {
+			// Code covers everything the macro-task may call
+			set<AstCFunc*> funcps;
+			TraceMTaskCallsVisitor mtaskVisitor (ccallp->funcp(), funcps);
+			for (set<AstCFunc*>::iterator it = funcps.begin(); it != funcps.end(); ++it) {
+			    new V3GraphEdge (&m_graph, activityVtxp, getCFuncVertexp(*it), 1);
+			}
+		    }
 		    V3GraphVertex* ccallFuncVtxp = getCFuncVertexp(ccallp->funcp());
 		    activityVtxp->slow(ccallp->funcp()->slow());
 		    new V3GraphEdge (&m_graph, activityVtxp, ccallFuncVtxp, 1);
@@ -629,8 +736,33 @@ private:
 	    }
 	}
 	m_funcp = nodep;
+	m_fineOk = (m_finding && v3Global.opt.traceMaxActivity()
+		    && !nodep->slow() && !nodep->isMTask() && !m_mtaskFuncps.count(nodep)
+		    && !nodep->funcType().isTrace());
 	nodep->iterateChildren(*this);
 	m_funcp = NULL;
+	m_fineOk = false;
+    }
+    virtual void visit(AstIf* nodep, AstNUser*) {
+	if (!m_fineOk) {
+	    nodep->iterateChildren(*this);
+	    return;
+	}
+	nodep->condp()->iterateAndNext(*this);
+	for (int branch=0; branch<2; ++branch) {
+	    AstNode* stmtsp = branch ? nodep->elsesp() : nodep->ifsp();
+	    if (!stmtsp) continue;
+	    // Each branch may set its own activity, as the first statement in the branch
+	    TraceActivityVertex* activityVtxp = new TraceActivityVertex(&m_graph, stmtsp, false);
+	    activityVtxp->fine(true);
+	    m_fineVtxps.push_back(make_pair(activityVtxp,
+					    (m_fineVtxp ? (V3GraphVertex*)m_fineVtxp
+					     : getCFuncVertexp(m_funcp))));
+	    TraceActivityVertex* lastVtxp = m_fineVtxp;
+	    m_fineVtxp = activityVtxp;
+	    stmtsp->iterateAndNext(*this);
+	    m_fineVtxp = lastVtxp;
+	}
     }
     virtual void visit(AstTraceInc* nodep, AstNUser*) {
 	UINFO(8,"   TRACE "<<nodep<<endl);
@@ -663,7 +795,7 @@ private:
 	}
 	else if (m_funcp && m_finding && nodep->lvalue()) {
 	    if (!nodep->varScopep()) nodep->v3fatalSrc("No var scope?");
-	    V3GraphVertex* funcVtxp = getCFuncVertexp(m_funcp);
+	    V3GraphVertex* funcVtxp = m_fineVtxp ? (V3GraphVertex*)m_fineVtxp : getCFuncVertexp(m_funcp);
 	    V3GraphVertex* varVtxp = nodep->varScopep()->user1p()->castGraphVertex();
 	    if (varVtxp) { // else we're not tracing this signal
 		new V3GraphEdge(&m_graph, funcVtxp, varVtxp, 1);
@@ -694,12 +826,18 @@ public:
 	m_chgSubParentp = NULL;
 	m_chgSubStmts = 0;
 	m_funcNum = 0;
+	m_fineOk = false;
+	m_fineVtxp = NULL;
 	nodep->accept(*this);
     }
     virtual ~TraceVisitor() {
 	V3Stats::addStat("Tracing, Unique changing signals", m_statChgSigs);
 	V3Stats::addStat("Tracing, Unique traced signals", m_statUniqSigs);
 	V3Stats::addStat("Tracing, Unique trace codes", m_statUniqCodes);
+	V3Stats::addStat("Tracing, Activity flags", m_statActivity);
+	V3Stats::addStat("Tracing, Activity flags for branches", m_statFineActivity);
+	V3Stats::addStat("Tracing, Change checks each dump", m_statChgAlways);
+	V3Stats::addStat("Tracing, Change checks skipped when inactive", m_statChgSkippable);
     }
 };
 
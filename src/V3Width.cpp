@@ -1688,7 +1688,16 @@ private:
 		AstVar* portp = it->first;
 		AstArg* argp = it->second;
 		AstNode* pinp = argp->exprp();
-		if (pinp!=NULL) {  // Else argument error we'll find later
+		if (pinp!=NULL && portp->isDpiOpenArray()) {
+		    // Passed by reference as a whole array, so no sizing or conversions
+		    if (accept_mode==0) {
+			pinp->accept(*this,WidthVP(ANYSIZE,0,PRELIM).p());  pinp=NULL;
+		    } else if (accept_mode==2) {
+			pinp->accept(*this,WidthVP(ANYSIZE,0,BOTH).p());
+			checkDpiOpenArrayPin(portp, pinp);
+		    }
+		}
+		else if (pinp!=NULL) {  // Else argument error we'll find later
 		    if (accept_mode==0) {
 			// Prelim may cause the node to get replaced; we've lost our
 			// pointer, so need to iterate separately later
@@ -2330,6 +2339,25 @@ private:
 	}
     }
 
+    void checkDpiOpenArrayPin(AstVar* portp, AstNode* pinp) {
+	// The import wrapper wraps the caller's own storage, so it must be a whole one
+	// dimensional unpacked array whose elements match the formal's type
+	AstNodeVarRef* refp = pinp->castNodeVarRef();
+	AstUnpackArrayDType* adtypep = refp ? refp->varp()->dtypeSkipRefp()->castUnpackArrayDType() : NULL;
+	AstBasicDType* elemp = adtypep ? adtypep->subDTypep()->skipRefp()->castBasicDType() : NULL;
+	if (portp->isOutOnly()) {
+	    pinp->v3error("Unsupported: DPI open array output argument, use inout: "<<portp->prettyName());
+	} else if (!elemp || elemp->isOpaque() || elemp->isDouble()
+		   || !portp->basicp() || portp->basicp()->isOpaque() || portp->basicp()->isDouble()) {
+	    pinp->v3error("Unsupported: DPI open array argument '"<<portp->prettyName()<<"'"
+			  <<" must connect to a one dimensional unpacked array of integral elements");
+	} else if (elemp->width() != portp->width()) {
+	    pinp->v3error("DPI open array argument '"<<portp->prettyName()<<"'"
+			  <<" has "<<portp->width()<<" bit elements,"
+			  <<" but connection's elements are "<<elemp->width()<<" bits.");
+	}
+    }
+
     //----------------------------------------------------------------------
     // SIGNED/DOUBLE METHODS
 
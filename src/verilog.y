@@ -1444,9 +1444,9 @@ variable_dimensionList<rangep>:	// IEEE: variable_dimension + empty
 
 variable_dimension<rangep>:	// ==IEEE: variable_dimension
 	//			// IEEE: unsized_dimension
-	//UNSUP	'[' ']'					{ UNSUP }
+		'[' ']'					{ $$ = new AstRange($1,new AstConst($1,0), new AstConst($1,0)); $$->unsized(true); }
 	//			// IEEE: unpacked_dimension
-		anyrange				{ $$ = $1; }
+	|	anyrange				{ $$ = $1; }
 	|	'[' constExpr ']'			{ $$ = new AstRange($1,new AstSub($1,$2, new AstConst($1,1)), new AstConst($1,0)); }
 	//			// IEEE: associative_dimension
 	//UNSUP	'[' data_type ']'			{ UNSUP }
@@ -3679,12 +3679,26 @@ AstVar* V3ParseGrammar::createVariable(FileLine* fileline, string name, AstRange
     if (type == AstVarType::GENVAR) {
 	if (arrayp) fileline->v3error("Genvars may not be arrayed: "<<name);
     }
+    bool dpiOpenArray = false;
+    for (AstRange* rangep = arrayp; rangep; rangep = rangep->nextp()->castRange()) {
+	if (rangep->unsized()) {
+	    // Only a lone [] on a function/task port; V3LinkParse checks it's a DPI import
+	    if (rangep != arrayp || rangep->nextp() || GRAMMARP->m_varIO == AstVarType::UNKNOWN) {
+		rangep->v3error("Unsupported: Unsized array dimension other than on a DPI import argument: "<<name);
+	    }
+	    dpiOpenArray = true;
+	}
+    }
+    if (dpiOpenArray) {  // Storage comes from the caller's array
+	arrayp->deleteTree(); arrayp=NULL;
+    }
 
     // Split RANGE0-RANGE1-RANGE2 into ARRAYDTYPE0(ARRAYDTYPE1(ARRAYDTYPE2(BASICTYPE3),RANGE),RANGE)
     AstNodeDType* arrayDTypep = createArray(dtypep,arrayp,false);
 
     AstVar* nodep = new AstVar(fileline, type, name, VFlagChildDType(), arrayDTypep);
     nodep->addAttrsp(attrsp);
+    if (dpiOpenArray) nodep->isDpiOpenArray(true);
     if (GRAMMARP->m_varDecl != AstVarType::UNKNOWN) nodep->combineType(GRAMMARP->m_varDecl);
     if (GRAMMARP->m_varIO != AstVarType::UNKNOWN) nodep->combineType(GRAMMARP->m_varIO);
 
@@ -8,11 +8,14 @@ if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); di
 # Version 2.0.
 
 compile (
-	 verilator_flags2 => ["--stats --profile-cfuncs"],
+	 verilator_flags2 => ["--stats --profile-cfuncs --debug-check"],
 	 );
 
 if ($Self->{vlt}) {
     file_grep ($Self->{stats}, qr/Optimizations, Tables created\s+(\d+)/i, 10);
+    file_grep ($Self->{stats}, qr/Optimizations, Tables packed\s+(\d+)/i, 10);
+    file_grep ($Self->{stats}, qr/Optimizations, Tables compiled\s+(\d+)/i, 10);
+    file_grep ($Self->{stats}, qr/Optimizations, Table \S*t_case_huge_sub4.v:\d+ created packed/i);
     file_grep ($Self->{stats}, qr/Optimizations, Combined CFuncs\s+(\d+)/i, 10);
 }
 
@@ -0,0 +1,27 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+top_filename("t/t_clk_dsp.v");
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    verilator_flags2 => ["--profile-triggers --stats"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Clock triggers precomputed\s+([1-9]\d*)/i);
+
+execute (
+    check_finished=>1,
+    );
+
+file_grep ($Self->{run_log_filename}, qr/-Info: Trigger count .*posedge.*clk.*: [1-9]/);
+
+ok(1);
+1;
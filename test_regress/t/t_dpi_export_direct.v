@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2017 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+module t ();
+
+   sub a (.inst(1));
+   sub b (.inst(2));
+
+   initial begin
+      a.test;
+      b.test;
+      if (a.calls != 1001 || b.calls != 1001) $stop;
+
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+
+endmodule
+
+module sub (input integer inst);
+
+   import "DPI-C" context function int dpii_call_direct(int count);
+
+   export "DPI-C" function dpix_add;
+
+   int calls = 0;
+
+   function int dpix_add(int a, int b);
+      calls = calls + 1;
+      dpix_add = a + b + inst*1000;
+   endfunction
+
+   task test;
+      if (dpii_call_direct(1000) != 0) $stop;
+   endtask
+
+endmodule
@@ -0,0 +1,48 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2017-2017 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include <cstdio>
+#include "svdpi.h"
+
+#include "Vt_dpi_export_direct__Dpi.h"
+
+#include "verilated.h"
+
+//======================================================================
+
+// Calls the export through a handle bound once to the calling scope,
+// checking it matches the ordinary lookup on every call
+int dpii_call_direct(int count) {
+    svScope scope = svGetScope();
+    dpix_add__Vhandle_t handle;
+    dpix_add__Vhandle(scope, &handle);
+
+    int exp = dpix_add(1, 2);
+    int got = dpix_add__Vdirect(&handle, 1, 2);
+    if (got != exp) {
+	printf("%%Error: %s: dpix_add__Vdirect()=%d, expected %d\n",
+	       svGetNameFromScope(scope), got, exp);
+	return 1;
+    }
+    for (int i=1; i<count; ++i) {
+	got = dpix_add__Vdirect(&handle, i, 2*i);
+	if (got != exp - 3 + 3*i) {
+	    printf("%%Error: %s: dpix_add__Vdirect(%d)=%d, expected %d\n",
+		   svGetNameFromScope(scope), i, got, exp - 3 + 3*i);
+	    return 1;
+	}
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+import "DPI-C" context function int dpii_mem_sum (input string name);
+import "DPI-C" context function void dpii_mem_fill (input string name, input int base);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // Read and written in place by the C model
+   reg [31:0] mem [0:1023] /*verilator public*/;
+   reg [69:0] wmem [3:0] /*verilator public*/;
+   reg 	      bits [0:7] /*verilator public*/;
+
+   integer    cyc=0;
+   integer    i;
+
+   initial begin
+      for (i=0; i<1024; i=i+1) mem[i] = i;
+      for (i=0; i<4; i=i+1) wmem[i] = {6'h3f, i[31:0], i[31:0]};
+      for (i=0; i<8; i=i+1) bits[i] = i[0];
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==1) begin
+	 if (dpii_mem_sum("mem") != 523776) $stop;
+	 if (dpii_mem_sum("wmem") != 6) $stop;
+	 if (dpii_mem_sum("bits") != 4) $stop;
+	 dpii_mem_fill("mem", 32'h1000);
+	 dpii_mem_fill("wmem", 32'h20);
+	 dpii_mem_fill("bits", 1);
+      end
+      else if (cyc==2) begin
+	 if (mem[0] !== 32'h1000) $stop;
+	 if (mem[1023] !== 32'h1000+1023) $stop;
+	 if (wmem[3] !== {6'h15, 32'h23, 32'h23}) $stop;
+	 if (wmem[0] !== {6'h15, 32'h20, 32'h20}) $stop;
+	 for (i=0; i<8; i=i+1) if (bits[i] !== !i[0]) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,56 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+import "DPI-C" function int dpii_open_sum (input int a[], input int left, input int right);
+import "DPI-C" function void dpii_open_fill (inout int a[], input int base);
+import "DPI-C" function int dpii_open_wide (inout bit [69:0] a[]);
+import "DPI-C" function int dpii_open_bits (inout bit a[]);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // Passed to the C model by reference, no public needed
+   int        up [0:3];
+   int        down [9:2];
+   reg [69:0] wide [1:3];
+   reg 	      bits [0:7];
+
+   integer    cyc=0;
+   integer    i;
+
+   initial begin
+      for (i=0; i<4; i=i+1) up[i] = i;
+      for (i=2; i<10; i=i+1) down[i] = i*10;
+      for (i=1; i<4; i=i+1) wide[i] = {6'h3f, i[31:0], i[31:0]};
+      for (i=0; i<8; i=i+1) bits[i] = i[0];
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==1) begin
+	 // Same import called with arrays of different sizes and directions
+	 if (dpii_open_sum(up, 0, 3) != 6) $stop;
+	 if (dpii_open_sum(down, 9, 2) != 440) $stop;
+	 dpii_open_fill(up, 32'h100);
+	 dpii_open_fill(down, 32'h200);
+	 if (dpii_open_wide(wide) != 6) $stop;
+	 if (dpii_open_bits(bits) != 4) $stop;
+      end
+      else if (cyc==2) begin
+	 for (i=0; i<4; i=i+1) if (up[i] !== 32'h100+i) $stop;
+	 for (i=2; i<10; i=i+1) if (down[i] !== 32'h200+i) $stop;
+	 if (wide[1] !== {6'h15, 32'h1, 32'h2}) $stop;
+	 if (wide[3] !== {6'h15, 32'h3, 32'h6}) $stop;
+	 for (i=0; i<8; i=i+1) if (bits[i] !== !i[0]) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
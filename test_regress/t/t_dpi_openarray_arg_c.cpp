@@ -0,0 +1,83 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include <cstdio>
+#include <cstdlib>
+#include "svdpi.h"
+
+#include "Vt_dpi_openarray_arg__Dpi.h"
+
+//======================================================================
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+	printf("%%Error: %s:%d: GOT = %d   EXP = %d\n", \
+	       __FILE__,__LINE__, (int)(got), (int)(exp)); \
+	exit(1); \
+    }
+
+// Only the svdpi.h open array interface is used here
+
+int dpii_open_sum(const svOpenArrayHandle a, int left, int right) {
+    CHECK_RESULT(svDimensions(a), 1);
+    CHECK_RESULT(svLeft(a,0), 31);
+    CHECK_RESULT(svRight(a,0), 0);
+    CHECK_RESULT(svLeft(a,1), left);
+    CHECK_RESULT(svRight(a,1), right);
+    CHECK_RESULT(svSize(a,1), (left>right ? left-right : right-left) + 1);
+    CHECK_RESULT(svGetArrElemPtr1(a, svHigh(a,1)+1) == NULL, 1);
+    int sum = 0;
+    for (int i=svLow(a,1); i<=svHigh(a,1); ++i) {
+	sum += *(int*)svGetArrElemPtr1(a, i);
+    }
+    return sum;
+}
+
+void dpii_open_fill(const svOpenArrayHandle a, int base) {
+    for (int i=svLow(a,1); i<=svHigh(a,1); ++i) {
+	*(int*)svGetArrElemPtr1(a, i) = base + i;
+    }
+}
+
+int dpii_open_wide(const svOpenArrayHandle a) {
+    CHECK_RESULT(svLeft(a,0), 69);
+    CHECK_RESULT(svLeft(a,1), 1);
+    CHECK_RESULT(svRight(a,1), 3);
+    int sum = 0;
+    svBitVecVal val[3];
+    for (int i=svLow(a,1); i<=svHigh(a,1); ++i) {
+	svGetBitArrElem1VecVal(val, a, i);
+	CHECK_RESULT(val[2], 0x3f);
+	sum += val[0];
+	// Set every bit, so the simulator must mask the unused ones
+	val[0] = i*2;  val[1] = i;  val[2] = 0xffffffd5;
+	svPutBitArrElem1VecVal(a, val, i);
+    }
+    return sum;
+}
+
+int dpii_open_bits(const svOpenArrayHandle a) {
+    // Single bit elements
+    CHECK_RESULT(svLeft(a,0), 0);
+    CHECK_RESULT(svRight(a,0), 0);
+    CHECK_RESULT(svSize(a,1), 8);
+    int ones = 0;
+    for (int i=svLow(a,1); i<=svHigh(a,1); ++i) {
+	svBit bit = svGetBitArrElem1(a, i);
+	ones += bit;
+	svPutBitArrElem1(a, !bit, i);
+    }
+    return ones;
+}
@@ -0,0 +1,102 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include <cstdio>
+#include "svdpi.h"
+
+#include "Vt_dpi_openarray__Dpi.h"
+
+#include "verilated.h"
+#include "verilated_dpi.h"
+#include "verilated_syms.h"
+
+//======================================================================
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+	printf("%%Error: %s:%d: GOT = %d   EXP = %d\n", \
+	       __FILE__,__LINE__, (int)(got), (int)(exp)); \
+	exit(1); \
+    }
+
+// A C model that only knows the open array interface
+
+static int model_sum(const svOpenArrayHandle h) {
+    // Scan in place; the low word of each element
+    int sum = 0;
+    for (int i=svLow(h,1); i<=svHigh(h,1); ++i) {
+	svBitVecVal* elemp = (svBitVecVal*)svGetArrElemPtr1(h, i);
+	sum += elemp[0];
+    }
+    return sum;
+}
+
+static void model_fill(const svOpenArrayHandle h, int base) {
+    svBitVecVal val[3];
+    for (int i=svLow(h,1); i<=svHigh(h,1); ++i) {
+	// Set every bit, so the simulator must mask the unused ones
+	val[0] = base + i;  val[1] = base + i;  val[2] = 0xffffffd5;
+	svPutBitArrElem1VecVal(h, val, i);
+    }
+}
+
+//======================================================================
+
+static VerilatedDpiOpenVar openVar(const char* namep) {
+    const VerilatedVar* varp = Verilated::dpiScope()->varFind(namep);
+    if (!varp) vl_fatal(__FILE__,__LINE__,"",(string("No public variable ")+namep).c_str());
+    return VerilatedDpiOpenVar(varp);
+}
+
+int dpii_mem_sum(const char* namep) {
+    VerilatedDpiOpenVar var = openVar(namep);
+    svOpenArrayHandle h = (svOpenArrayHandle)&var;
+    CHECK_RESULT(svDimensions(h), 1);
+    if (0==strcmp(namep, "mem")) {
+	CHECK_RESULT(svLeft(h,1), 0);
+	CHECK_RESULT(svRight(h,1), 1023);
+	CHECK_RESULT(svIncrement(h,1), -1);
+	CHECK_RESULT(svSize(h,1), 1024);
+	CHECK_RESULT(svSizeOfArray(h), (int)(1024*sizeof(IData)));
+	CHECK_RESULT(svGetArrElemPtr1(h, 1024) == NULL, 1);
+    } else if (0==strcmp(namep, "bits")) {
+	// Single bit elements; the only range given is the unpacked one
+	CHECK_RESULT(svLeft(h,0), 0);
+	CHECK_RESULT(svRight(h,0), 0);
+	CHECK_RESULT(svLeft(h,1), 0);
+	CHECK_RESULT(svRight(h,1), 7);
+	CHECK_RESULT(svSize(h,1), 8);
+	CHECK_RESULT(svSizeOfArray(h), (int)(8*sizeof(CData)));
+	int ones = 0;
+	for (int i=svLow(h,1); i<=svHigh(h,1); ++i) ones += svGetBitArrElem1(h, i);
+	return ones;
+    } else {
+	CHECK_RESULT(svLeft(h,0), 69);
+	CHECK_RESULT(svLeft(h,1), 3);
+	CHECK_RESULT(svIncrement(h,1), 1);
+	svLogicVecVal lv[3];
+	svGetLogicArrElem1VecVal(lv, h, 2);
+	CHECK_RESULT(lv[2].aval, 0x3f);
+	CHECK_RESULT(lv[2].bval, 0);
+    }
+    // No copy was made
+    CHECK_RESULT(svGetArrayPtr(h) == Verilated::dpiScope()->varFind(namep)->datap(), 1);
+    return model_sum(h);
+}
+
+void dpii_mem_fill(const char* namep, int base) {
+    VerilatedDpiOpenVar var = openVar(namep);
+    model_fill((svOpenArrayHandle)&var, base);
+}
@@ -0,0 +1,75 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_save.h>
+#include "Vt_savable_delta.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+const char* save_name(int num) {
+    static char name[1000];
+    snprintf(name,1000,"obj_dir/t_savable_delta/saved_%d.vltsv", num);
+    return name;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    if (Verilated::commandArgsPlusMatch("save_restore=")[0]) {
+	// Base image, then two deltas in order
+	vector<string> names;
+	for (int num=0; num<3; ++num) names.push_back(save_name(num));
+	VerilatedRestoreDelta os;
+	os.open(names);
+	if (!os.isOpen()) vl_fatal(__FILE__,__LINE__,"main","Can't open saved files");
+	os >> main_time;
+	os >> *topp;
+	os.close();
+    } else {
+	topp->clk = 0;
+	topp->eval();
+	main_time += 10;
+    }
+
+    VerilatedSaveDelta save;
+    int saves = 0;
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	main_time += 1;
+	if (!Verilated::commandArgsPlusMatch("save_restore=")[0]
+	    && (main_time % 20) == 0) {
+	    save.open(save_name(saves));
+	    save << main_time;
+	    save << *topp;
+	    save.close();
+	    printf("Save %d, %d of %d blocks written\n", saves,
+		   (int)save.dirtyBlocks(), (int)save.totalBlocks());
+	    // Only a few memory words change between saves
+	    if (saves ? (save.dirtyBlocks()*4 > save.totalBlocks())
+		: (save.dirtyBlocks() != save.totalBlocks() || save.totalBlocks() < 16)) {
+		vl_fatal(__FILE__,__LINE__,"main","Unexpected number of blocks written");
+	    }
+	    if (++saves == 3) {
+		printf("Exiting after save %d\n", saves);
+		exit(0);
+	    }
+	}
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    delete topp; topp=NULL;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--savable --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>0,
+    );
+
+-r "$Self->{obj_dir}/saved_2.vltsv" or $Self->error("saved_2.vltsv not created\n");
+# Deltas are much smaller than the base image
+(-s "$Self->{obj_dir}/saved_1.vltsv") * 4 < (-s "$Self->{obj_dir}/saved_0.vltsv")
+    or $Self->error("saved_1.vltsv delta not smaller than base image\n");
+
+execute (
+    all_run_flags => ['+save_restore=1'],
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,54 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+
+   // Many save blocks, of which every fourth cycle changes one word
+   reg [31:0] 	mem [0:32767];
+   reg [31:0] 	after;
+
+   integer 	i;
+   reg [31:0]	c;
+
+   // Test loop
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d\n",$time, cyc);
+`endif
+      cyc <= cyc + 1;
+      if (cyc==0) begin
+	 // Setup
+	 for (i=0; i<32768; i=i+1) mem[i] = i*32'h9e3779b1;
+	 after <= 32'hfeedface;
+      end
+      else if (cyc>=2 && cyc<99 && cyc[1:0]==2'b0) begin
+	 mem[(cyc*1031) & 32767] <= cyc;
+      end
+      if (cyc==1) begin
+	 if ($test$plusargs("save_restore")!=0) begin
+	    // Don't allow the restored model to run from time 0, it must run from a restore
+	    $write("%%Error: didn't really restore\n");
+	    $stop;
+	 end
+      end
+      else if (cyc==99) begin
+	 for (i=4; i<99; i=i+4) if (mem[(i*1031) & 32767] !== i) $stop;
+	 for (i=0; i<32768; i=i+1) begin
+	    c = mem[i];
+	    if (c !== i*32'h9e3779b1 && (c < 4 || c >= 99 || c[1:0] != 2'b0
+					 || ((c*1031) & 32767) != i)) $stop;
+	 end
+	 if (after !== 32'hfeedface) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,51 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2014 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+
+   // Large enough to be saved page aligned
+   reg [31:0] 	mem [0:32767];
+   reg [127:0] 	wmem [0:8191];
+   reg [7:0] 	small [0:15];
+   reg [31:0] 	after;
+
+   integer 	i;
+
+   // Test loop
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d\n",$time, cyc);
+`endif
+      cyc <= cyc + 1;
+      if (cyc==0) begin
+	 // Setup
+	 for (i=0; i<32768; i=i+1) mem[i] = i*32'h9e3779b1;
+	 for (i=0; i<8192; i=i+1) wmem[i] = {4{i[31:0]^32'h5a5a5a5a}};
+	 for (i=0; i<16; i=i+1) small[i] = i[7:0]+8'h30;
+	 after <= 32'hfeedface;
+      end
+      if (cyc==1) begin
+	 if ($test$plusargs("save_restore")!=0) begin
+	    // Don't allow the restored model to run from time 0, it must run from a restore
+	    $write("%%Error: didn't really restore\n");
+	    $stop;
+	 end
+      end
+      else if (cyc==99) begin
+	 for (i=0; i<32768; i=i+1) if (mem[i] !== i*32'h9e3779b1) $stop;
+	 for (i=0; i<8192; i=i+1) if (wmem[i] !== {4{i[31:0]^32'h5a5a5a5a}}) $stop;
+	 for (i=0; i<16; i=i+1) if (small[i] !== i[7:0]+8'h30) $stop;
+	 if (after !== 32'hfeedface) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,126 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Checks each wide operator kernel set against a reference, then
+// reports the time of each kernel against the scalar versions.
+// Run with +bench for longer, more stable timings.
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "Vt_simd_kernels.h"
+
+unsigned int main_time = false;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+#define MAX_WORDS 80
+
+static int errors = 0;
+static WData l[MAX_WORDS+1], r[MAX_WORDS+1], o[MAX_WORDS+1], e[MAX_WORDS+1];
+
+static void randomize(WDataOutP wp) {
+    for (int i=0; i<MAX_WORDS+1; i++) wp[i] = (rand()<<16) ^ rand();
+}
+
+static void check(const char* namep, const char* kernelp, int words, bool ok) {
+    if (!ok) {
+	VL_PRINTF("%%Error: %s %s words=%d mismatch\n", namep, kernelp, words);
+	++errors;
+    }
+}
+
+static bool same(int words) {
+    for (int i=0; i<words; i++) if (o[i] != e[i]) return false;
+    return true;
+}
+
+static void verify(const VerilatedSimd::Kernels& k) {
+    for (int words=1; words<=MAX_WORDS; words++) {
+	randomize(l); randomize(r);
+	if (words & 1) for (int i=0; i<words; i++) r[i] = l[i];  // Equal case
+	IData changed = 0; IData redor = 0; IData ones = 0;
+	for (int i=0; i<words; i++) {
+	    changed |= l[i] ^ r[i]; redor |= l[i]; ones += VL_COUNTONES_I(l[i]);
+	}
+	for (int i=0; i<words; i++) e[i] = l[i] & r[i];
+	k.m_and(words,o,l,r); check("and", k.m_namep, words, same(words));
+	for (int i=0; i<words; i++) e[i] = l[i] | r[i];
+	k.m_or(words,o,l,r); check("or", k.m_namep, words, same(words));
+	for (int i=0; i<words; i++) e[i] = l[i] ^ r[i];
+	k.m_xor(words,o,l,r); check("xor", k.m_namep, words, same(words));
+	for (int i=0; i<words; i++) e[i] = ~l[i];
+	k.m_not(words,o,l); check("not", k.m_namep, words, same(words));
+	check("changeXor", k.m_namep, words, k.m_changeXor(words,l,r) == changed);
+	check("redOr", k.m_namep, words, k.m_redOr(words,l) == redor);
+	check("countOnes", k.m_namep, words, k.m_countOnes(words,l) == ones);
+	for (int diff=0; diff<=words; diff++) {
+	    for (int i=0; i<words; i++) o[i] = l[i];
+	    if (diff<words) o[diff] ^= 1U<<(diff&31);
+	    check("firstDiff", k.m_namep, words, k.m_firstDiff(words,l,o) == diff);
+	}
+	for (int shift=1; shift<32; shift++) {
+	    for (int i=0; i<words; i++) e[i] = (l[i+1]<<shift) | (l[i]>>(32-shift));
+	    k.m_funnel(words,o,l+1,l,shift); check("funnel", k.m_namep, words, same(words));
+	}
+    }
+}
+
+static double nsPerOp(clock_t start, int iters) {
+    return (double)(clock()-start) * 1e9 / CLOCKS_PER_SEC / iters;
+}
+
+static void bench(const VerilatedSimd::Kernels& k, int words, int iters) {
+    volatile IData sink = 0;
+    clock_t start;
+    VL_PRINTF("  %-6s w%-5d", k.m_namep, words*32);
+    start = clock(); for (int n=0; n<iters; n++) { k.m_and(words,o,l,o); }
+    VL_PRINTF(" and %6.1f", nsPerOp(start,iters));
+    start = clock(); for (int n=0; n<iters; n++) { k.m_not(words,o,o); }
+    VL_PRINTF(" not %6.1f", nsPerOp(start,iters));
+    start = clock(); for (int n=0; n<iters; n++) { sink += k.m_changeXor(words,l,r); r[0]++; }
+    VL_PRINTF(" chg %6.1f", nsPerOp(start,iters));
+    start = clock(); for (int n=0; n<iters; n++) { sink += k.m_countOnes(words,l); l[0]++; }
+    VL_PRINTF(" cnt %6.1f", nsPerOp(start,iters));
+    start = clock(); for (int n=0; n<iters; n++) { k.m_funnel(words,o,l+1,l,(n&15)+1); }
+    VL_PRINTF(" shift %6.1f ns\n", nsPerOp(start,iters));
+}
+
+int main (int argc, char *argv[]) {
+    Verilated::commandArgs(argc, argv);
+    static const char* const names[] = { "scalar", "sse2", "avx2", NULL };
+
+    VL_PRINTF("Active kernels: %s\n", VerilatedSimd::s_active.m_namep);
+    for (const char* const* namepp = names; *namepp; ++namepp) {
+	if (const VerilatedSimd::Kernels* kp = VerilatedSimd::find(*namepp)) verify(*kp);
+    }
+
+    int iters = Verilated::commandArgsPlusMatch("bench")[0] ? 2000000 : 20000;
+    static const int widths[] = { 8, 16, 32, 64, 0 };
+    for (const int* wordsp = widths; *wordsp; ++wordsp) {
+	for (const char* const* namepp = names; *namepp; ++namepp) {
+	    if (const VerilatedSimd::Kernels* kp = VerilatedSimd::find(*namepp)) bench(*kp, *wordsp, iters);
+	}
+    }
+    if (errors) vl_stop(__FILE__, __LINE__, "TOP-cpp");
+
+    // And the operators in a model
+    Vt_simd_kernels* topp = new Vt_simd_kernels;
+    topp->clk = 0;
+    topp->eval();
+    while (!Verilated::gotFinish() && main_time < 1000) {
+	main_time += 5;
+	topp->clk = !topp->clk;
+	topp->eval();
+    }
+    topp->final();
+    delete topp;
+    return 0;
+}
@@ -0,0 +1,57 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   integer cyc; initial cyc=0;
+   reg [511:0] a;
+   reg [511:0] b;
+   reg [8:0] 	 s;
+
+   // Identities that exercise each wide kernel
+   wire [511:0] and_w = a & b;
+   wire [511:0] or_w = a | b;
+   wire [511:0] xor_w = a ^ b;
+   wire [511:0] not_a = ~a;
+   wire [1023:0] cat_w = {a, b};
+   wire [575:0]  cat_odd = {a, b[63:0]} >> 0;
+   wire [511:0] shl = a << s;
+   wire [511:0] shr = shl >> s;
+   wire [511:0] mask = ~(512'd0) >> s;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= {a[510:0], a[511] ^ a[509] ^ a[505] ^ a[0]} ^ {16{cyc}};
+      b <= {b[0], b[511:1]} + {480'd0, cyc};
+      s <= s + 9'd37;
+      if (cyc == 0) begin
+	 a <= {16{32'h12345679}};
+	 b <= {16{32'hfedcba98}};
+	 s <= 9'd3;
+      end
+      else begin
+	 if ((and_w | xor_w) != or_w) $stop;
+	 if ((and_w ^ xor_w) != or_w) $stop;
+	 if ((not_a & a) != 512'd0) $stop;
+	 if (~not_a != a) $stop;
+	 if ($countones(a) + $countones(not_a) != 512) $stop;
+	 if ($countones(xor_w) == 0 && a != b) $stop;
+	 if (|(a ^ a)) $stop;
+	 if (!(|or_w) && (a != 0)) $stop;
+	 if (cat_w[1023:512] != a || cat_w[511:0] != b) $stop;
+	 if (cat_odd[575:64] != a || cat_odd[63:0] != b[63:0]) $stop;
+	 if (shr != (a & mask)) $stop;
+	 if (cyc == 99) begin
+	    $write("*-* All Finished *-*\n");
+	    $finish;
+	 end
+      end
+   end
+endmodule
@@ -0,0 +1,52 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include <verilated_save.h>
+#include "Vt_snapshot.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    topp->trace(tfp,99);
+    tfp->open("obj_dir/t_snapshot/simx.vcd");
+
+    topp->clk = 0;
+    int rewinds = 0;
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+	if (main_time == 50) {
+	    printf("Snapshot taken\n");
+	    rewinds = VerilatedSnapshot::snapshot();
+	    if (rewinds) printf("Snapshot resumed after %d rewind\n", rewinds);
+	}
+	if (main_time == 120 && !rewinds) {
+	    printf("Rewinding\n");
+	    VerilatedSnapshot::rewind();
+	}
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+    }
+    tfp->close();
+    topp->final();
+    delete topp; topp=NULL;
+    return 0;
+}
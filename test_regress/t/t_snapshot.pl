@@ -0,0 +1,41 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_savable.v");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    expect=>
+'Snapshot taken
+Rewinding
+Snapshot resumed after 1 rewind
+\*-\* All Finished \*-\*',
+    );
+
+# The rewound cycles' values are discarded, so time only moves forward
+{
+    my $vcd = file_contents("$Self->{obj_dir}/simx.vcd");
+    my $last = -1;
+    foreach my $time ($vcd =~ /^#([0-9]+)$/mg) {
+	$time > $last or $Self->error("Time $time follows $last in simx.vcd\n");
+	$last = $time;
+    }
+    $last > 100 or $Self->error("simx.vcd ends at time $last\n");
+}
+
+ok(1);
+1;
@@ -0,0 +1,64 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include <verilated_save.h>
+#include "Vt_snapshot_fork.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+#define CHILDREN 2
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    topp->trace(tfp,99);
+    tfp->open("obj_dir/t_snapshot_fork/simx.vcd");
+
+    topp->clk = 0;
+    topp->child = 0;
+    int child = 0;
+    int pids[CHILDREN];
+    while (main_time < 1000 && !Verilated::gotFinish()) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+	if (main_time == 20) {
+	    // Warm start each child from here, each with its own stimulus and files
+	    for (int c=1; c<=CHILDREN && !child; ++c) {
+		pids[c-1] = VerilatedSnapshot::forkChild();
+		if (pids[c-1] < 0) vl_fatal(__FILE__,__LINE__,"main","forkChild failed");
+		if (pids[c-1] == 0) child = c;
+	    }
+	    topp->child = child;
+	    if (!child) {
+		for (int c=1; c<=CHILDREN; ++c) {
+		    int status = VerilatedSnapshot::waitChild(pids[c-1]);
+		    printf("Child %d exited %d\n", c, status);
+		    if (status != 10+c) vl_fatal(__FILE__,__LINE__,"main","Unexpected child exit status");
+		}
+	    }
+	}
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+    }
+    tfp->close();
+    topp->final();
+    delete topp; topp=NULL;
+    if (child) exit(10+child);
+    return 0;
+}
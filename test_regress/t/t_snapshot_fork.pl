@@ -0,0 +1,66 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+unlink(glob("$Self->{obj_dir}/out_*.log"), glob("$Self->{obj_dir}/in_*.dat"),
+       glob("$Self->{obj_dir}/simx_*.vcd"));
+write_wholefile("$Self->{obj_dir}/in.dat", join("", map { "$_\n" } (1..50)));
+
+execute (
+    check_finished=>1,
+    );
+
+file_grep ($Self->{run_log_filename}, qr/^Child 1 exited 11$/m);
+file_grep ($Self->{run_log_filename}, qr/^Child 2 exited 12$/m);
+
+# The parent's log has the cycles before the fork, then its own
+file_grep ("$Self->{obj_dir}/out.log", qr/^\[0\] child 0 cyc 0$/m);
+# Every process reads 1 to 41 from in.dat, the children from where the fork was
+file_grep ("$Self->{obj_dir}/out.log", qr/^child 0 done sum 40 rdsum 861$/m);
+file_grep_not ("$Self->{obj_dir}/out.log", qr/child [12]/);
+
+# Each child's log starts as the parent's was at the fork, then has its own
+my @logs = glob("$Self->{obj_dir}/out_*.log");
+@logs == 2 or $Self->error("Expected 2 child logs, got: @logs\n");
+my %children;
+foreach my $log (@logs) {
+    my $contents = file_contents($log);
+    my ($c) = ($contents =~ /^child ([12]) done/m)
+	or $Self->error("$log: no completion\n");
+    next if !$c;
+    $children{$c} = 1;
+    file_grep ($log, qr/^\[0\] child 0 cyc 0$/m);
+    file_grep ($log, qr/^\[18\] child 0 cyc 9$/m);
+    file_grep_not ($log, qr/child 0 cyc [1-9][0-9]/);
+    file_grep_not ($log, qr/child 0 done/);
+    file_grep_not ($log, qr/child ${\(3-$c)}/);
+    # 10 cycles before the fork, then 30 with child added to each
+    my $sum = 10 + 30*(1+$c);
+    file_grep ($log, qr/^child $c done sum $sum rdsum 861$/m);
+}
+(keys %children) == 2 or $Self->error("Children's logs not distinct\n");
+
+my @vcds = glob("$Self->{obj_dir}/simx_*.vcd");
+@vcds == 2 or $Self->error("Expected 2 child traces, got: @vcds\n");
+foreach my $vcd (@vcds) {
+    file_grep ($vcd, qr/\$enddefinitions/);
+    file_grep ($vcd, qr/^#20$/m);
+    file_grep_not ($vcd, qr/^#10$/m);
+}
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/^#10$/m);
+
+ok(1);
+1;
@@ -0,0 +1,43 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk, child
+   );
+   input clk;
+   input [7:0] child;	// Set by each forked child, 0 in the parent
+
+   integer 	cyc=0;
+   integer 	fd;
+   integer 	fdin;
+   integer 	chars;
+   reg [31:0]	sum;
+   reg [31:0]	rd;
+   reg [31:0]	rdsum;
+
+   initial begin
+      fd = $fopen("obj_dir/t_snapshot_fork/out.log", "w");
+      // Read and write, each process continues reading where the fork was
+      fdin = $fopen("obj_dir/t_snapshot_fork/in.dat", "r+");
+      sum = 0;
+      rdsum = 0;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      sum <= sum + {24'h0, child} + 1;
+      $fwrite(fd, "[%0t] child %0d cyc %0d\n", $time, child, cyc);
+      chars = $fscanf(fdin, "%d", rd);
+      rdsum = rdsum + rd;
+      if (cyc==40) begin
+	 $fwrite(fd, "child %0d done sum %0d rdsum %0d\n", child, sum, rdsum);
+	 $fclose(fd);
+	 $fclose(fdin);
+	 if (child == 0) $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2014 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+# --debug-check compares the table bytecode against the tree walk for every input
+compile (
+	 verilator_flags2 => ["--stats --debug-check"],
+	 );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/Optimizations, Tables created\s+(\d+)/i, 3);
+    file_grep ($Self->{stats}, qr/Optimizations, Tables compiled\s+(\d+)/i, 2);
+}
+
+execute (
+	 check_finished=>1,
+     );
+
+ok(1);
+1;
@@ -0,0 +1,84 @@
+// DESCRIPTION: Verilator: Verilog Test module
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2014 by Wilson Snyder.
+
+// Each block below becomes a lookup table.  The check block computes the
+// same expressions at run time, so the tables must match for every input.
+
+// Narrow arithmetic; compiled to bytecode
+`define F_A(i) ( (i[0]) ? ({4'h0,i} + 12'h123) \
+		 : (i[7:6] == 2'b10) ? (({i,4'h5} ^ 12'hf0f) - {i[3:0],i}) \
+		 : ($signed(i) > $signed(8'h10)) ? ((({4'h0,i} << i[2:0]) | 12'h801) & ~{i,i[7:4]}) \
+		 : (i > 8'h40) ? ({i[3:0],i} * 12'h3) \
+		 : (({i,i[3:0]} >> i[5:3]) ^ {3'h0,^i,i}) )
+
+// Wider than 64 bits; not compiled, so always simulated by walking the tree
+`define F_B(i) ( (({i,88'h0} | {12{i}}) >> i[6:0]) \
+		 ^ ({96{i[7]}} & 96'h0123_4567_89ab_cdef_0f1e_2d3c) \
+		 ^ ({i,i,i,i,i,i,i,i,i,i,i,i} + {i[3:0],92'h1}) )
+
+// Bit selects beyond the vector are X; compiled, but those inputs are simulated by walking the tree
+// verilator lint_off WIDTH
+`define F_C(i) ( {i[{i[0],i[7:5]}], i[{i[3:1],i[6]}], i[4] ^ i[{i[5],i[2:0]}], 5'h0} \
+		 + ((i[6:4] > 3'd2) ? {4'h0,i[3:0]} : {i[7:4],4'h0}) )
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+   reg [7:0]	in;
+
+   reg [11:0]	outa, outa2;
+   reg [11:0]	outb, outb2;
+   reg [7:0]	outc, outc2;
+
+   // Second assignments keep each block from being inlined into the check
+   always @ (/*AS*/in) begin
+      outa = `F_A(in);
+      outa2 = outa ^ 12'h5a5;
+   end
+   always @ (/*AS*/in) begin
+      outb = `F_B(in);
+      outb2 = outb + 12'h1;
+   end
+   always @ (/*AS*/in) begin
+      outc = `F_C(in);
+      outc2 = ~outc;
+   end
+
+   reg [11:0]	expa;
+   reg [11:0]	expb;
+   reg [7:0]	expc;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      in <= cyc[7:0];
+      if (cyc > 0) begin
+	 expa = `F_A(in);
+	 expb = `F_B(in);
+	 expc = `F_C(in);
+`ifdef TEST_VERBOSE
+	 $write("in=%x a=%x b=%x c=%x\n", in, outa, outb, outc);
+`endif
+	 if (outa !== expa || outa2 !== (expa ^ 12'h5a5)) begin
+	    $write("%%Error: in=%x outa=%x expected %x\n", in, outa, expa);
+	    $stop;
+	 end
+	 if (outb !== expb || outb2 !== expb + 12'h1) begin
+	    $write("%%Error: in=%x outb=%x expected %x\n", in, outb, expb);
+	    $stop;
+	 end
+	 if (outc !== expc || outc2 !== ~expc) begin
+	    $write("%%Error: in=%x outc=%x expected %x\n", in, outc, expc);
+	    $stop;
+	 end
+      end
+      if (cyc == 260) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
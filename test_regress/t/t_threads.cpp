@@ -0,0 +1,57 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_threads.h"
+
+unsigned int main_time = false;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+// Reference model of t_threads_sub
+struct Ref {
+    vluint64_t m_crc;
+    vluint64_t m_sum;
+    Ref(vluint64_t seed) : m_crc(seed), m_sum(0) {}
+    void clock() {
+	vluint64_t mix = m_crc ^ ((m_crc << 32) | (m_crc >> 32));
+	m_crc = (m_crc << 1) | (((m_crc >> 63) ^ (m_crc >> 2) ^ m_crc) & 1);
+	m_sum += mix;
+    }
+};
+
+int main (int argc, char *argv[]) {
+    Vt_threads* topp = new Vt_threads;
+    Ref refs[4] = { Ref(VL_ULL(0x5aa50f0f12345678)), Ref(VL_ULL(0x1)),
+		    Ref(VL_ULL(0xdeadbeefcafef00d)), Ref(VL_ULL(0x8000000000000000)) };
+
+    topp->clk = 0;
+    topp->eval();
+    for (int cyc=0; cyc<100; ++cyc) {
+	main_time += 5;
+	topp->clk = 1;
+	topp->eval();
+	for (int i=0; i<4; ++i) refs[i].clock();
+	main_time += 5;
+	topp->clk = 0;
+	topp->eval();
+	vluint64_t sums[4] = { topp->a_sum, topp->b_sum, topp->c_sum, topp->d_sum };
+	for (int i=0; i<4; ++i) {
+	    if (sums[i] != refs[i].m_sum) {
+		VL_PRINTF("%%Error: cyc %d sum %d got %" VL_PRI64 "x exp %" VL_PRI64 "x\n",
+			  cyc, i, sums[i], refs[i].m_sum);
+		vl_stop(__FILE__, __LINE__, "TOP-cpp");
+	    }
+	}
+    }
+    topp->final();
+    delete topp; topp=NULL;
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
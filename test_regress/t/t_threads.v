@@ -0,0 +1,50 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   a_sum, b_sum, c_sum, d_sum,
+   // Inputs
+   clk
+   );
+
+   input clk;
+   output [63:0] a_sum;
+   output [63:0] b_sum;
+   output [63:0] c_sum;
+   output [63:0] d_sum;
+
+   // No logic shared between the instances, so each may run on its own thread
+   t_threads_sub #(.SEED(64'h5aa5_0f0f_1234_5678)) a (.clk(clk), .sum(a_sum));
+   t_threads_sub #(.SEED(64'h0000_0000_0000_0001)) b (.clk(clk), .sum(b_sum));
+   t_threads_sub #(.SEED(64'hdead_beef_cafe_f00d)) c (.clk(clk), .sum(c_sum));
+   t_threads_sub #(.SEED(64'h8000_0000_0000_0000)) d (.clk(clk), .sum(d_sum));
+
+endmodule
+
+module t_threads_sub (/*AUTOARG*/
+   // Outputs
+   sum,
+   // Inputs
+   clk
+   );
+   parameter [63:0] SEED = 64'h1;
+
+   input clk;
+   output reg [63:0] sum;
+
+   reg [63:0] crc;
+   wire [63:0] mix = crc ^ {crc[31:0], crc[63:32]};
+
+   initial begin
+      crc = SEED;
+      sum = 64'h0;
+   end
+
+   always @ (posedge clk) begin
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      sum <= sum + mix;
+   end
+endmodule
@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+compile (
+    verilator_flags2 => ["--threads 4 --stats"],
+    );
+
+if ($Self->{vlt}) {
+    # The main block, and each instance's writer and reader together
+    file_grep ($Self->{stats}, qr/Order, threads, independent logic sets\s+(\d+)/i, 3);
+}
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   a_out, b_out,
+   // Inputs
+   clk
+   );
+
+   input clk;
+   output [7:0] a_out;
+   output [7:0] b_out;
+
+   integer cyc; initial cyc=0;
+
+   t_threads_clock_en_sub a (.clk(clk), .out(a_out));
+   t_threads_clock_en_sub b (.clk(clk), .out(b_out));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 9) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module t_threads_clock_en_sub (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk
+   );
+
+   input clk;
+   output [7:0] out;
+
+   // The combinational read of a clock_enable variable has no order edge,
+   // but must still be in the same logic set as the write
+   reg en /*verilator clock_enable*/;
+   initial en = 1'b0;
+   always @ (posedge clk) en <= ~en;
+   assign out = en ? 8'h55 : 8'haa;
+endmodule
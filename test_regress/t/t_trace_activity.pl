@@ -0,0 +1,27 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+compile (
+	 verilator_flags2 => ['--trace --trace-max-activity 4 --stats'],
+	 );
+
+execute (
+	 check_finished=>1,
+	 );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/Tracing, Activity flags for branches\s+[1-4]\n/i);
+    file_grep ($Self->{stats}, qr/Tracing, Change checks skipped when inactive\s+[1-9]/i);
+    # Changes made only under branch activity must still be dumped
+    file_grep ("$Self->{obj_dir}/simx.vcd", qr/^b1010101 /m);
+    file_grep ("$Self->{obj_dir}/simx.vcd", qr/^b0101010 /m);
+}
+
+ok(1);
+1;
@@ -0,0 +1,29 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc; initial cyc = 0;
+   reg [6:0] gated; initial gated = 0;
+   reg [5:0] other; initial other = 0;
+
+   // Blocking assignments under ifs, so branches set traced signals
+   always @ (posedge clk) begin
+      cyc = cyc + 1;
+      if (cyc == 5) gated = 7'h55;
+      else if (cyc == 7) gated = 7'h2a;
+      if (cyc[1]) other = other + 6'd1;
+      if (cyc == 10) begin
+	 if (gated != 7'h2a) $stop;
+	 if (other != 6'd4) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
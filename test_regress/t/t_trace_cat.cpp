@@ -14,6 +14,10 @@
 # include "Vt_trace_cat_reopen.h"
 #elif defined(T_TRACE_CAT_RENEW)
 # include "Vt_trace_cat_renew.h"
+#elif defined(T_TRACE_CAT_ASYNC)
+# include "Vt_trace_cat_async.h"
+#elif defined(T_TRACE_CAT_THREADS)
+# include "Vt_trace_cat_threads.h"
 #else
 # error "Unknown test"
 #endif
@@ -31,6 +35,10 @@ const char* trace_name() {
     snprintf(name,1000,"obj_dir/t_trace_cat_reopen/simpart_%04d.vcd", (int)main_time);
 #elif defined(T_TRACE_CAT_RENEW)
     snprintf(name,1000,"obj_dir/t_trace_cat_renew/simpart_%04d.vcd", (int)main_time);
+#elif defined(T_TRACE_CAT_ASYNC)
+    snprintf(name,1000,"obj_dir/t_trace_cat_async/simpart_%04d.vcd", (int)main_time);
+#elif defined(T_TRACE_CAT_THREADS)
+    snprintf(name,1000,"obj_dir/t_trace_cat_threads/simpart_%04d.vcd", (int)main_time);
 #else
 # error "Unknown test"
 #endif
@@ -46,6 +54,11 @@ int main(int argc, char **argv, char **env) {
     VerilatedVcdC* tfp = new VerilatedVcdC;
     top->trace(tfp,99);
 
+#if defined(T_TRACE_CAT_ASYNC)
+    tfp->asyncBuffers(2);
+#elif defined(T_TRACE_CAT_THREADS)
+    tfp->threads(2);
+#endif
     tfp->open(trace_name());
 
     top->clk = 0;
@@ -55,7 +68,7 @@ int main(int argc, char **argv, char **env) {
 	top->eval();
 
 	if ((main_time % 100) == 0) {
-#if defined(T_TRACE_CAT)
+#if defined(T_TRACE_CAT) || defined(T_TRACE_CAT_ASYNC) || defined(T_TRACE_CAT_THREADS)
 	    tfp->openNext(true);
 #elif defined(T_TRACE_CAT_REOPEN)
 	    tfp->close();
@@ -71,6 +84,9 @@ int main(int argc, char **argv, char **env) {
 #endif
 	}
 	tfp->dump((unsigned int)(main_time));
+#if defined(T_TRACE_CAT_ASYNC)
+	if ((main_time % 50) == 0) tfp->flush();
+#endif
 	++main_time;
     }
     tfp->close();
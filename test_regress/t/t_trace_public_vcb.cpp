@@ -0,0 +1,50 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcb_c.h>
+
+#include "Vt_trace_public_vcb.h"
+#include "Vt_trace_public_vcb_t.h"
+#include "Vt_trace_public_vcb_glbl.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+const unsigned long long dt_2 = 3;
+
+int main(int argc, char **argv, char **env) {
+    Vt_trace_public_vcb *top = new Vt_trace_public_vcb("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcbC* tfp = new VerilatedVcbC;
+    top->trace(tfp,99);
+    tfp->open("obj_dir/t_trace_public_vcb/simx.vcb");
+
+    while (main_time <= 20) {
+	top->CLK   = (main_time/dt_2)%2;
+	top->eval();
+
+	top->v->glbl->GSR = (main_time < 7);
+
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+    }
+    tfp->close();
+    top->final();
+
+    if (!VerilatedVcbC::toVcd("obj_dir/t_trace_public_vcb/simx.vcb",
+			      "obj_dir/t_trace_public_vcb/simx.vcd")) {
+	vl_fatal(__FILE__,__LINE__,"top","Can't convert simx.vcb");
+    }
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
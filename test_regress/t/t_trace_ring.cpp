@@ -0,0 +1,52 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+
+#include "Vt_trace_ring.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    Vt_trace_ring* top = new Vt_trace_ring("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    top->trace(tfp,99);
+    tfp->ringBuffer(4096);  // Far less than the run's changes
+    tfp->open("obj_dir/t_trace_ring/simx.vcd");
+
+    top->clk = 0;
+
+    while (main_time < 2000) {
+	top->clk   = ~top->clk;
+	top->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+	if (main_time == 1000) tfp->trigger();
+    }
+    tfp->trigger();
+    tfp->trigger();
+    // Flushes, as from vpi_flush or $finish, don't write a window
+    for (int i=0; i<10; ++i) {
+	top->clk   = ~top->clk;
+	top->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+    }
+    Verilated::flushCall();
+    tfp->close();
+    top->final();
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_trace_cat.v");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# Window written at the trigger, starting with a full dump after time 0
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/\$enddefinitions \$end\s+#([0-9]+)\n/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/^#0\n/m);
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/^#999\n/m);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/^#1000\n/m);
+# Second window, after more dumps
+file_grep ("$Self->{obj_dir}/simx_cat0000.vcd", qr/^#1999\n/m);
+# Repeated trigger without dumps, or a flush, writes nothing
+(!-r "$Self->{obj_dir}/simx_cat0001.vcd") or $Self->error("Unexpected third window");
+
+ok(1);
+1;
@@ -0,0 +1,52 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2013 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+
+#include "Vt_trace_scope.h"
+#include "Vt_trace_scope_t.h"
+#include "Vt_trace_scope_glbl.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+const unsigned long long dt_2 = 3;
+
+int main(int argc, char **argv, char **env) {
+    Vt_trace_scope *top = new Vt_trace_scope("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    top->trace(tfp,99);
+    tfp->scopeInclude("top.v");
+    tfp->scopeExclude("top.v.n?g");
+    // Patterns longer than any scope must match nothing
+    tfp->scopeExclude("top.v.littl?x");
+    tfp->scopeExclude("top.v.little?");
+    tfp->scopeExclude("top.v.little*x");
+    tfp->open("obj_dir/t_trace_scope/simx.vcd");
+
+    while (main_time <= 20) {
+	top->CLK   = (main_time/dt_2)%2;
+	top->eval();
+
+	top->v->glbl->GSR = (main_time < 7);
+
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+    }
+    tfp->close();
+    top->final();
+
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
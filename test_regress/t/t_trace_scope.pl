@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2013 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+top_filename("t/t_trace_public.v");
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# Scopes filtered when opened, see t_trace_public.out for unfiltered
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/module little/);
+file_grep ("$Self->{obj_dir}/simx.vcd", qr/\$var wire 32 \$ val/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/module neg/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/\$var wire  1 7 RESET/);
+# No values for neg.i128
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/^b[01]+ \($/m);
+
+ok(1);
+1;
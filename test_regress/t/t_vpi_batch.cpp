@@ -0,0 +1,178 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include "Vt_vpi_batch.h"
+#include "verilated.h"
+
+#include "verilated_vpi.h"
+#include "verilated_vpi.cpp"
+
+// __FILE__ is too long
+#define FILENM "t_vpi_batch.cpp"
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+	printf("%%Error: %s:%d: GOT = %d   EXP = %d\n", \
+	       FILENM,__LINE__, (int)(got), (int)(exp)); \
+	return __LINE__; \
+    }
+
+#define CHECK_RESULT_HEX(got, exp) \
+    if ((got) != (exp)) { \
+	printf("%%Error: %s:%d: GOT = %llx   EXP = %llx\n", \
+	       FILENM,__LINE__, (unsigned long long)(got), (unsigned long long)(exp)); \
+	return __LINE__; \
+    }
+
+unsigned int main_time = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+//======================================================================
+
+static vpiHandle handle(const char* name) {
+    return vpi_handle_by_name((PLI_BYTE8*)name, NULL);
+}
+
+static vpiHandle mem_word(int index) {
+    return vpi_handle_by_index(handle("t.mem"), index);
+}
+
+int _mon_check_raw() {
+    VerilatedVpiBatch batch;
+    PLI_INT32 narrowOff = batch.add(handle("t.narrow"));
+    PLI_INT32 halfOff = batch.add(handle("t.half"));
+    PLI_INT32 wordOff = batch.add(handle("t.word"));
+    PLI_INT32 quadOff = batch.add(handle("t.quad"));
+    PLI_INT32 wideOff = batch.add(handle("t.wide"));
+    PLI_INT32 mem0Off = batch.add(mem_word(0));
+    PLI_INT32 mem3Off = batch.add(mem_word(3));
+    PLI_INT32 cycOff = batch.add(handle("t.cyc"));
+    CHECK_RESULT(batch.count(), 8);
+    // Offsets are aligned to each value's size
+    CHECK_RESULT(narrowOff, 0);
+    CHECK_RESULT(halfOff, 2);
+    CHECK_RESULT(wordOff, 4);
+    CHECK_RESULT(quadOff, 8);
+    CHECK_RESULT(wideOff, 16);
+    CHECK_RESULT(mem0Off, 28);
+    CHECK_RESULT(mem3Off, 32);
+    CHECK_RESULT(cycOff, 36);
+    CHECK_RESULT(batch.size(), 40);
+
+    vluint8_t buf[40];
+    memset(buf, 0, sizeof(buf));
+    batch.get(buf);
+    CHECK_RESULT_HEX(*(CData*)(buf+narrowOff), 0x15);
+    CHECK_RESULT_HEX(*(SData*)(buf+halfOff), 0x1234);
+    CHECK_RESULT_HEX(*(IData*)(buf+wordOff), 0xdeadbeef);
+    CHECK_RESULT_HEX(*(QData*)(buf+quadOff), VL_ULL(0x123456789a));
+    CHECK_RESULT_HEX(((WData*)(buf+wideOff))[0], 0x9abcdef0);
+    CHECK_RESULT_HEX(((WData*)(buf+wideOff))[1], 0x12345678);
+    CHECK_RESULT_HEX(((WData*)(buf+wideOff))[2], 0x2a);
+    CHECK_RESULT_HEX(*(IData*)(buf+mem0Off), 0x100);
+    CHECK_RESULT_HEX(*(IData*)(buf+mem3Off), 0x103);
+
+    // Values agree with vpi_get_value
+    s_vpi_value v;
+    v.format = vpiIntVal;
+    vpi_get_value(handle("t.cyc"), &v);
+    CHECK_RESULT(*(IData*)(buf+cycOff), v.value.integer);
+
+    // Put with the unused bits set; they must be masked off
+    *(CData*)(buf+narrowOff) = 0xea;
+    *(SData*)(buf+halfOff) = 0x4321;
+    *(IData*)(buf+wordOff) = 0x0badf00d;
+    *(QData*)(buf+quadOff) = VL_ULL(0xffffffff87654321);
+    ((WData*)(buf+wideOff))[0] = 0x22222222;
+    ((WData*)(buf+wideOff))[1] = 0x11111111;
+    ((WData*)(buf+wideOff))[2] = 0xffffffff;
+    *(IData*)(buf+mem0Off) = 0x200;
+    *(IData*)(buf+mem3Off) = 0x203;
+    // cyc is read only, so it's skipped with a warning
+    CHECK_RESULT(batch.put(buf), 7);
+    CHECK_RESULT(vpi_chk_error(NULL), vpiWarning);
+
+    memset(buf, 0, sizeof(buf));
+    batch.get(buf);
+    CHECK_RESULT_HEX(*(CData*)(buf+narrowOff), 0x0a);
+    CHECK_RESULT_HEX(*(QData*)(buf+quadOff), VL_ULL(0xff87654321));
+    CHECK_RESULT_HEX(((WData*)(buf+wideOff))[2], 0x3f);
+    return 0;
+}
+
+int _mon_check_int() {
+    VerilatedVpiBatch batch (vpiIntVal);
+    PLI_INT32 halfOff = batch.add(handle("t.half"));
+    PLI_INT32 cycOff = batch.add(handle("t.cyc"));
+    CHECK_RESULT(halfOff, 0);
+    CHECK_RESULT(cycOff, 4);
+    // Too wide for vpiIntVal
+    CHECK_RESULT(batch.add(handle("t.quad")), -1);
+    CHECK_RESULT(vpi_chk_error(NULL), vpiError);
+    // A whole memory needs each word added
+    VerilatedVpiBatch rawBatch;
+    CHECK_RESULT(rawBatch.add(handle("t.mem")), -1);
+    CHECK_RESULT(batch.count(), 2);
+
+    PLI_INT32 buf[2];
+    batch.get(buf);
+    CHECK_RESULT_HEX(buf[0], 0x4321);
+    s_vpi_value v;
+    v.format = vpiIntVal;
+    vpi_get_value(handle("t.cyc"), &v);
+    CHECK_RESULT(buf[1], v.value.integer);
+    return 0;
+}
+
+//======================================================================
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+    // Errors are checked by the test
+    Verilated::fatalOnVpiError(0);
+
+    VM_PREFIX* topp = new VM_PREFIX ("");  // Note null name - we're flattening it out
+
+    topp->eval();
+    topp->clk = 0;
+
+    while (sc_time_stamp() < 100 && !Verilated::gotFinish()) {
+	main_time += 1;
+	topp->eval();
+	if (main_time == 2) {
+	    if (int status = _mon_check_raw()) {
+		printf("%%Error: t_vpi_batch raw check failed at line %d\n", status);
+		exit(1);
+	    }
+	    if (int status = _mon_check_int()) {
+		printf("%%Error: t_vpi_batch int check failed at line %d\n", status);
+		exit(1);
+	    }
+	}
+	VerilatedVpi::callValueCbs();
+	topp->clk = !topp->clk;
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(FILENM,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    delete topp; topp=NULL;
+    exit(0L);
+}
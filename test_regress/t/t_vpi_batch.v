@@ -0,0 +1,51 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+
+   reg [4:0] 	narrow	/*verilator public_flat_rw @(posedge clk) */;
+   reg [15:0] 	half	/*verilator public_flat_rw @(posedge clk) */;
+   reg [31:0] 	word	/*verilator public_flat_rw @(posedge clk) */;
+   reg [39:0] 	quad	/*verilator public_flat_rw @(posedge clk) */;
+   reg [69:0] 	wide	/*verilator public_flat_rw @(posedge clk) */;
+   reg [31:0] 	mem[3:0] /*verilator public_flat_rw @(posedge clk) */;
+   reg [31:0] 	cyc	/*verilator public_flat_rd */;
+
+   initial begin
+      narrow = 5'h15;
+      half = 16'h1234;
+      word = 32'hdeadbeef;
+      quad = 40'h12_3456789a;
+      wide = 70'h2a_12345678_9abcdef0;
+      mem[0] = 32'h100;
+      mem[1] = 32'h101;
+      mem[2] = 32'h102;
+      mem[3] = 32'h103;
+      cyc = 0;
+   end
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 10) begin
+	 // Written by VerilatedVpiBatch::put
+	 if (narrow !== 5'h0a) $stop;
+	 if (half !== 16'h4321) $stop;
+	 if (word !== 32'h0badf00d) $stop;
+	 if (quad !== 40'hff_87654321) $stop;
+	 if (wide !== 70'h3f_11111111_22222222) $stop;
+	 if (mem[0] !== 32'h200) $stop;
+	 if (mem[3] !== 32'h203) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
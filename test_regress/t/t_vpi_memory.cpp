@@ -149,7 +149,7 @@ int _mon_check_memory() {
     // check type
     int vpitype = vpi_get(vpiType, mem_h);
     CHECK_RESULT(vpitype, vpiMemory);
-    _mon_check_range(mem_h, 16, 16, 1);
+    if (int status = _mon_check_range(mem_h, 16, 16, 1)) return status;
     // iterate and store
     iter_h = vpi_iterate(vpiMemoryWord, mem_h);
     cnt = 0;
@@ -157,7 +157,7 @@ int _mon_check_memory() {
 	value.value.integer = ++cnt;
         vpi_put_value(lcl_h, &value, NULL, vpiNoDelay);
         // check size and range
-        _mon_check_range(lcl_h, 32, 31, 0);
+        if (int status = _mon_check_range(lcl_h, 32, 31, 0)) return status;
     }
     CHECK_RESULT(cnt, 16); // should be 16 addresses
     // iterate and accumulate
@@ -169,6 +169,22 @@ int _mon_check_memory() {
       CHECK_RESULT(value.value.integer, cnt);
     }
     CHECK_RESULT(cnt, 16); // should be 16 addresses
+    // ascending memory: range as declared, words from the lowest index
+    mem_h = vpi_handle_by_name((PLI_BYTE8*)"t.mem1", NULL);
+    CHECK_RESULT_NZ(mem_h);
+    if (int status = _mon_check_range(mem_h, 8, 0, 7)) return status;
+    iter_h = vpi_iterate(vpiMemoryWord, mem_h);
+    cnt = 0;
+    while (lcl_h = vpi_scan(iter_h)) {
+	VlVpiHandle index_h = vpi_handle(vpiIndex, lcl_h);
+	CHECK_RESULT_NZ(index_h);
+	vpi_get_value(index_h, &value);
+	CHECK_RESULT(value.value.integer, cnt);
+	value.value.integer = ++cnt;
+        vpi_put_value(lcl_h, &value, NULL, vpiNoDelay);
+        if (int status = _mon_check_range(lcl_h, 8, 7, 0)) return status;
+    }
+    CHECK_RESULT(cnt, 8); // should be 8 addresses
     // don't care for non verilator
     // (crashes on Icarus)
     s_vpi_vlog_info info;
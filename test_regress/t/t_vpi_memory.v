@@ -25,6 +25,7 @@ extern "C" int mon_check();
    input clk;
 
    reg [31:0] mem0 [16:1] /*verilator public_flat_rw @(posedge clk) */;
+   reg [7:0]  mem1 [0:7] /*verilator public_flat_rw @(posedge clk) */;
    integer 	  i, status;
 
    // Test loop
@@ -40,6 +41,9 @@ extern "C" int mon_check();
 `endif
       for (i = 16; i > 0; i--)
 	if (mem0[i] !== i) $write("%%Error: %d : GOT = %d  EXP = %d\n", i, mem0[i], i);
+      // Words are iterated from the lowest index, also when declared ascending
+      for (i = 0; i < 8; i++)
+	if (mem1[i] !== i+1) $write("%%Error: %d : GOT = %d  EXP = %d\n", i, mem1[i], i+1);
       $write("*-* All Finished *-*\n");
       $finish;
    end
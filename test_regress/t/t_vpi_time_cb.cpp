@@ -0,0 +1,180 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2014 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+// Timed callbacks, with many registered and cancelled at equal times.
+// Each step must call exactly the callbacks a reference schedule says are
+// due; the time per step is printed for benchmarking, but not checked.
+
+#include "Vt_vpi_time_cb.h"
+#include "verilated.h"
+
+#include "verilated_vpi.h"
+#include "verilated_vpi.cpp"
+
+#include <sys/time.h>
+
+// __FILE__ is too long
+#define FILENM "t_vpi_time_cb.cpp"
+
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) { \
+	printf("%%Error: %s:%d: GOT = %d   EXP = %d\n", \
+	       FILENM,__LINE__, (int)(got), (int)(exp)); \
+	exit(1); \
+    }
+
+unsigned int main_time = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+//======================================================================
+
+// Each transactor keeps one callback pending, re-registering from inside it
+enum { TRANSACTORS = 1000, STEPS = 2000, PHASES = 4 };
+enum { CANCEL_DELAY = 8 };	// Later than any transactor's next callback, so always cancelled
+
+struct Transactor {
+    int		m_num;
+    QData	m_due;		// Time the pending callback should be called
+    vpiHandle	m_cancelp;	// Far future callback to cancel
+};
+
+Transactor transactors[TRANSACTORS];
+unsigned long callbacks_called = 0;
+unsigned long callbacks_registered = 0;
+unsigned long zero_delay_called = 0;
+QData zero_delay_due = 0;
+
+static PLI_INT32 _never_callback(p_cb_data cb_data) {
+    printf("%%Error: cancelled callback was called\n");
+    exit(1);
+    return 0;
+}
+
+static PLI_INT32 _zero_delay_callback(p_cb_data cb_data) {
+    // Registered with no delay from inside a callback; must be called in the same pass
+    CHECK_RESULT(cb_data->user_data != NULL, 1);
+    CHECK_RESULT(*(QData*)cb_data->user_data, main_time);
+    ++zero_delay_called;
+    return 0;
+}
+
+static QData next_delay(int num, QData time) {
+    return 1 + (num + time) % 7;
+}
+
+static vpiHandle register_after(QData delay, PLI_INT32 (*cb_rtn)(p_cb_data), PLI_BYTE8* user_data) {
+    s_vpi_time t;
+    t.type = vpiSimTime;
+    t.high = (PLI_UINT32)(delay>>32);
+    t.low = (PLI_UINT32)delay;
+    t_cb_data cb_data;
+    cb_data.reason = cbAfterDelay;
+    cb_data.cb_rtn = cb_rtn;
+    cb_data.obj = NULL;
+    cb_data.time = &t;
+    cb_data.value = NULL;
+    cb_data.user_data = user_data;
+    ++callbacks_registered;
+    return vpi_register_cb(&cb_data);
+}
+
+static PLI_INT32 _transactor_callback(p_cb_data cb_data) {
+    Transactor* tp = (Transactor*)(cb_data->user_data);
+    CHECK_RESULT(tp->m_due, main_time);
+    ++callbacks_called;
+    if (tp->m_cancelp) {
+	vpi_remove_cb(tp->m_cancelp);
+	tp->m_cancelp = NULL;
+    }
+    QData delay = next_delay(tp->m_num, main_time);
+    tp->m_due = main_time + delay;
+    register_after(delay, _transactor_callback, (PLI_BYTE8*)tp);  // Releasing would cancel it
+    if ((tp->m_num + main_time) % 5 == 0) {
+	tp->m_cancelp = register_after(CANCEL_DELAY, _never_callback, NULL);
+    }
+    if (tp->m_num == 0) {
+	zero_delay_due = main_time;
+	register_after(0, _zero_delay_callback, (PLI_BYTE8*)&zero_delay_due);
+    }
+    return 0;
+}
+
+static void expected_calls(unsigned long* stepCallsp) {
+    // Reference schedule of transactor callbacks, plus transactor 0's zero delay ones
+    for (int step=0; step<=STEPS; ++step) stepCallsp[step] = 0;
+    for (int i=0; i<TRANSACTORS; ++i) {
+	for (QData due = 1 + i % 3; due <= STEPS; due += next_delay(i, due)) {
+	    stepCallsp[due] += (i == 0) ? 2 : 1;
+	}
+    }
+}
+
+static double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+
+    VM_PREFIX* topp = new VM_PREFIX ("");  // Note null name - we're flattening it out
+
+    for (int i=0; i<TRANSACTORS; ++i) {
+	Transactor* tp = &transactors[i];
+	tp->m_num = i;
+	tp->m_due = 1 + i % 3;
+	tp->m_cancelp = NULL;
+	register_after(tp->m_due, _transactor_callback, (PLI_BYTE8*)tp);
+    }
+
+    static unsigned long stepCalls[STEPS+1];
+    expected_calls(stepCalls);
+
+    topp->clk = 0;
+    for (int phase=0; phase<PHASES; ++phase) {
+	double start = now();
+	for (int step=0; step<STEPS/PHASES; ++step) {
+	    main_time += 1;
+	    topp->clk = !topp->clk;
+	    topp->eval();
+	    unsigned long before = callbacks_called + zero_delay_called;
+	    VerilatedVpi::callTimedCbs();
+	    CHECK_RESULT(callbacks_called + zero_delay_called - before, stepCalls[main_time]);
+	}
+	VL_PRINTF("Phase %d: %lu callbacks registered so far, %.2f us per time step\n",
+		  phase, callbacks_registered, (now() - start)*1e6/(STEPS/PHASES));
+    }
+
+    // Every transactor's callback was called exactly when due
+    for (int i=0; i<TRANSACTORS; ++i) {
+	if (transactors[i].m_due <= main_time) {
+	    printf("%%Error: transactor %d callback due at %d wasn't called\n",
+		   i, (int)transactors[i].m_due);
+	    exit(1);
+	}
+    }
+    CHECK_RESULT(zero_delay_called > STEPS/7, 1);
+    CHECK_RESULT(callbacks_called > (unsigned long)TRANSACTORS*STEPS/7, 1);
+
+    topp->final();
+    delete topp; topp=NULL;
+    VL_PRINTF("*-* All Finished *-*\n");
+    exit(0L);
+}
@@ -0,0 +1,17 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2014 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc /*verilator public_flat_rd*/ = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+   end
+endmodule
@@ -0,0 +1,227 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2013 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include "Vt_vpi_value_cb.h"
+#include "verilated.h"
+
+#include "verilated_vpi.h"
+#include "verilated_vpi.cpp"
+
+#include <iostream>
+
+// __FILE__ is too long
+#define FILENM "t_vpi_value_cb.cpp"
+
+// Use cout to avoid issues with %d/%lx etc
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) {			     \
+	cout<<dec<<"%Error: "<<FILENM<<":"<<__LINE__ \
+	   <<": GOT = "<<(got)<<"   EXP = "<<(exp)<<endl;	\
+	return __LINE__; \
+    }
+
+#define CHECK_RESULT_NZ(got) \
+    if (!(got)) { \
+	printf("%%Error: %s:%d: GOT = NULL  EXP = !NULL\n", FILENM,__LINE__); \
+	return __LINE__; \
+    }
+
+// Callbacks can't return a line number, so note the first failure
+#define CHECK_CB(got, exp) \
+    if ((got) != (exp)) { \
+	cout<<dec<<"%Error: "<<FILENM<<":"<<__LINE__ \
+	   <<": GOT = "<<(got)<<"   EXP = "<<(exp)<<endl;	\
+	if (!cb_error) cb_error = __LINE__; \
+	return 0; \
+    }
+
+unsigned int main_time = false;
+int cb_error = 0;
+
+//======================================================================
+// Several callbacks on t.count:
+//   a: every change; removes c on its 20th call, and adds e on its 40th
+//   b: removes itself on its 5th call
+//   c: adds d on its 10th call
+//   d: added from c, so starts with the change after
+// Memory word callbacks on t.mem:
+//   mem: word 3, removed from main after its 3rd call
+//   words: every word; a removes all but 3 and 5 on its 30th call
+//   e: word 8, added from a
+//   last: word 5 after words[5], removed and released from main after 2 calls
+//   only: word 10 once words[10] is gone, removed and released from main
+//         after 1 call, with after added to word 10 between the two
+
+struct CbState {
+    int		calls;	// Times called
+    bool	removed;	// vpi_remove_cb done, so mustn't be called
+    vpiHandle	cb;	// Callback handle
+    int		word;	// Memory word index, or -1 for t.count
+    CbState() : calls(0), removed(false), cb(NULL), word(-1) {}
+};
+
+CbState cb_a, cb_b, cb_c, cb_d, cb_e, cb_mem, cb_last, cb_only, cb_after;
+CbState cb_words[16];
+vpiHandle count_h = NULL;
+vpiHandle mem_h = NULL;
+int count_value = 0;	// Value of t.count the callbacks expect
+
+static void cb_remove(CbState& st) {
+    vpi_remove_cb(st.cb);
+    st.removed = true;
+}
+
+static PLI_INT32 cb_value(p_cb_data cb_data);
+
+static vpiHandle cb_add(CbState& st, vpiHandle objp) {
+    s_vpi_value v;
+    v.format = vpiIntVal;
+    t_cb_data cb_data;
+    cb_data.reason = cbValueChange;
+    cb_data.cb_rtn = cb_value;
+    cb_data.obj = objp;
+    cb_data.time = NULL;
+    cb_data.value = &v;
+    cb_data.user_data = (PLI_BYTE8*)&st;
+    st.cb = vpi_register_cb(&cb_data);
+    return st.cb;
+}
+
+static PLI_INT32 cb_value(p_cb_data cb_data) {
+    CbState& st = *(CbState*)(cb_data->user_data);
+    CHECK_CB(st.removed, false);
+    ++st.calls;
+    if (st.word < 0) {
+	// Called once per change, with the new value
+	CHECK_CB(cb_data->value->value.integer, count_value);
+    } else {
+	// Word w is only written with values w, w+16, w+32...
+	CHECK_CB(cb_data->value->value.integer % 16, st.word);
+    }
+    if (&st == &cb_a) {
+	if (st.calls == 20) cb_remove(cb_c);
+	if (st.calls == 30) {
+	    for (int w=0; w<16; ++w) {
+		if (w != 3 && w != 5) cb_remove(cb_words[w]);
+	    }
+	}
+	if (st.calls == 40) {
+	    vpiHandle wordh = vpi_handle_by_index(mem_h, 8);
+	    if (!cb_add(cb_e, wordh)) { if (!cb_error) cb_error = __LINE__; }
+	}
+    }
+    else if (&st == &cb_b) {
+	if (st.calls == 5) cb_remove(cb_b);
+    }
+    else if (&st == &cb_c) {
+	if (st.calls == 10) {
+	    if (!cb_add(cb_d, count_h)) { if (!cb_error) cb_error = __LINE__; }
+	}
+    }
+    return 0;
+}
+
+extern "C" int mon_check() {
+    CHECK_RESULT_NZ(count_h = vpi_handle_by_name((PLI_BYTE8*)"t.count", NULL));
+    CHECK_RESULT_NZ(mem_h = vpi_handle_by_name((PLI_BYTE8*)"t.mem", NULL));
+    CHECK_RESULT_NZ(cb_add(cb_a, count_h));
+    CHECK_RESULT_NZ(cb_add(cb_b, count_h));
+    CHECK_RESULT_NZ(cb_add(cb_c, count_h));
+    cb_e.word = 8;
+    cb_mem.word = 3;
+    vpiHandle wordh;
+    CHECK_RESULT_NZ(wordh = vpi_handle_by_index(mem_h, 3));
+    CHECK_RESULT_NZ(cb_add(cb_mem, wordh));
+    for (int w=0; w<16; ++w) {
+	cb_words[w].word = w;
+	CHECK_RESULT_NZ(wordh = vpi_handle_by_index(mem_h, w));
+	CHECK_RESULT_NZ(cb_add(cb_words[w], wordh));
+    }
+    cb_last.word = 5;
+    CHECK_RESULT_NZ(wordh = vpi_handle_by_index(mem_h, 5));
+    CHECK_RESULT_NZ(cb_add(cb_last, wordh));
+    cb_only.word = 10;
+    cb_after.word = 10;
+    return 0; // Ok
+}
+
+//======================================================================
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    double sim_time = 1100;
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+
+    VM_PREFIX* topp = new VM_PREFIX ("");  // Note null name - we're flattening it out
+
+    topp->eval();
+    topp->clk = 0;
+    main_time += 10;
+
+    while (sc_time_stamp() < sim_time && !Verilated::gotFinish()) {
+	main_time += 1;
+	topp->eval();
+	if (topp->clk) ++count_value;  // Rising edge just done
+	VerilatedVpi::callValueCbs();
+	if (cb_mem.calls == 3 && !cb_mem.removed) cb_remove(cb_mem);  // Outside callbacks
+	// Remove then release, as a VPI application commonly does
+	if (cb_last.calls == 2 && !cb_last.removed) {
+	    cb_remove(cb_last);
+	    vpi_release_handle(cb_last.cb);
+	}
+	if (count_value == 32 && !cb_only.cb) {
+	    CHECK_RESULT_NZ(cb_add(cb_only, vpi_handle_by_index(mem_h, 10)));
+	}
+	if (cb_only.calls == 1 && !cb_only.removed) {
+	    cb_remove(cb_only);
+	    // Reuses the slot only had; releasing only mustn't remove it
+	    CHECK_RESULT_NZ(cb_add(cb_after, vpi_handle_by_index(mem_h, 10)));
+	    vpi_release_handle(cb_only.cb);
+	}
+	topp->clk = !topp->clk;
+    }
+    CHECK_RESULT(cb_error, 0);
+    // count changes 1 to 101
+    CHECK_RESULT(cb_a.calls, 101);
+    CHECK_RESULT(cb_b.calls, 5);
+    CHECK_RESULT(cb_c.calls, 19);
+    CHECK_RESULT(cb_d.calls, 91);
+    // Word 3 changes with writes of 3, 19, 35, 51, 67, 83, 99
+    CHECK_RESULT(cb_mem.calls, 3);
+    CHECK_RESULT(cb_words[3].calls, 7);
+    CHECK_RESULT(cb_words[5].calls, 6);
+    // Word 8 is written with 40 just after e is added, then 56, 72, 88
+    CHECK_RESULT(cb_e.calls, 4);
+    // Words before word 14 changed twice before the 30th count change
+    CHECK_RESULT(cb_words[0].calls, 1);
+    CHECK_RESULT(cb_words[13].calls, 1);
+    CHECK_RESULT(cb_words[12].calls, 2);
+    // Word 5 is written with 5 and 21 before last goes; words[5] above is unaffected
+    CHECK_RESULT(cb_last.calls, 2);
+    // Word 10 is written with 42 while only is there, then 58, 74, 90
+    CHECK_RESULT(cb_only.calls, 1);
+    CHECK_RESULT(cb_after.calls, 3);
+    if (!Verilated::gotFinish()) {
+	vl_fatal(FILENM,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    delete topp; topp=NULL;
+    exit(0L);
+}
@@ -0,0 +1,44 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Copyright 2013 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+`systemc_header
+extern "C" int mon_check();
+`verilog
+
+   input clk;
+
+   reg [31:0] 	count		/*verilator public_flat_rd */;
+   reg [7:0] 	mem[0:15]	/*verilator public_flat_rd */;
+
+   integer 	status;
+   integer 	i;
+
+   initial begin
+      count = 0;
+      for (i=0; i<16; i=i+1) mem[i] = 0;
+      status = $c32("mon_check()");
+      if (status!=0) begin
+	 $write("%%Error: t_vpi_value_cb.cpp:%0d: C Test failed\n", status);
+	 $stop;
+      end
+   end
+
+   always @(posedge clk) begin
+      count <= count + 1;
+      mem[count[3:0]] <= count[7:0];
+      if (count == 100) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+endmodule